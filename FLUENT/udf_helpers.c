@@ -10,6 +10,8 @@ The above copyright notice and this permission notice shall be included in all c
 THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 #include "udf_helpers.h"
+#include "vof_pc_text_writer.h"
+#include "vof_pc_threads.h"
 
 
 DEFINE_ON_DEMAND(f_parallelInfo)
@@ -46,7 +48,6 @@ int countLinesOfFile(char filename[], int *line_count)
         (*line_count) = 0;
         while ((ch = fgetc(fp)) != EOF)
         {
-            ch = fgetc(fp);
             if(ch == '\n')
             {
                 (*line_count)++;
@@ -153,13 +154,13 @@ int writeRealArrToFile(
     Write a file with the follwing a column of arr. Matching the
     order of rows in the read grid file from coupled software.
 */
-FILE *fp = NULL;
+TextWriter writer;
 int i = 0;
 int state = _STATE_OK;
 
-if ((fp = fopen(filename, "w")) == NULL)
+if (openTextWriter(&writer, filename) != _STATE_OK)
 {
-    Message("Error (writeRealArrToFile()): Unable to open %s \n", filename);
+    threadMessage("Error (writeRealArrToFile()): Unable to open %s \n", filename);
     state = _STATE_ERROR;
 }
 else
@@ -168,7 +169,7 @@ else
     {
         if ( arr == NULL)
         {
-            Message("Error (writeRealArrToFile()): Memory access no values "
+            threadMessage("Error (writeRealArrToFile()): Memory access no values "
                     "available in arr!\n");
             state = _STATE_ERROR;
         }
@@ -176,23 +177,21 @@ else
         {
             for (i = 0; i < size_arr; ++i)
             {
-                if(IS_SINGLE_PRECISION)
-                {
-                    fprintf(fp, "%f\n", arr[i]);
-                }
-                else
-                {
-                    fprintf(fp, "%lf\n", arr[i]);
-                }
+                writeTextFixed(&writer, arr[i], 0, 6);
+                writeTextChar(&writer, '\n');
             }
         }
     }
     else
     {
-        Message("Warning (writeRealArrToFile()): Array size is zero!\n");
+        threadMessage("Warning (writeRealArrToFile()): Array size is zero!\n");
+        state = _STATE_ERROR;
+    }
+    if(closeTextWriter(&writer) != _STATE_OK)
+    {
+        threadMessage("Error (writeRealArrToFile()): Writing %s failed!\n", filename);
         state = _STATE_ERROR;
     }
-    fclose(fp);
 }
 
 return state;
@@ -210,12 +209,12 @@ int writeIntegerArrToFile(
     order of rows in the read grid file from coupled software.
 */
 int state = _STATE_OK;
-FILE *fp = NULL;
+TextWriter writer;
 int i = 0;
 
-if ((fp = fopen(filename, "w")) == NULL)
+if (openTextWriter(&writer, filename) != _STATE_OK)
 {
-    Message("\n Warning (in writeIntArrToFile()): Unable to open %s \n", filename);
+    threadMessage("\n Warning (in writeIntArrToFile()): Unable to open %s \n", filename);
     state = _STATE_ERROR;
 }
 else
@@ -224,7 +223,7 @@ else
     {
         if ( arr == NULL)
         {
-            Message("Error (in writeIntArrToFile()): Memory access no values "
+            threadMessage("Error (in writeIntArrToFile()): Memory access no values "
                     "available in arr!\n");
             state = _STATE_ERROR;
         }
@@ -232,17 +231,41 @@ else
         {
             for (i = 0; i < size_arr; ++i)
             {
-                fprintf(fp, "%i\n", arr[i]);
+                writeTextInt(&writer, arr[i], 0);
+                writeTextChar(&writer, '\n');
             }
         }
     }
     else
     {
-        Message("Warning (in writeIntArrToFile()): Array size is zero!\n");
+        threadMessage("Warning (in writeIntArrToFile()): Array size is zero!\n");
+        state = _STATE_ERROR;
+    }
+    if(closeTextWriter(&writer) != _STATE_OK)
+    {
+        threadMessage("Error (in writeIntArrToFile()): Writing %s failed!\n", filename);
         state = _STATE_ERROR;
     }
-    fclose(fp);
 }
 
 return state;
 }
+
+
+unsigned int hashIntUpdate(unsigned int hash, int value)
+{
+/*
+    Updates the FNV-1a hash (start with HASH_INIT) with the bytes of value.
+*/
+unsigned int v = (unsigned int) value;
+int i = 0;
+
+for(i = 0; i < 4; ++i)
+{
+    hash ^= (v & 0xFFu);
+    hash *= 16777619u;
+    v >>= 8;
+}
+
+return hash;
+}
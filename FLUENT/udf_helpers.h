@@ -76,4 +76,8 @@ int writeIntegerArrToFile(
                             int size_arr
                          );
 
+/* FNV-1a hash, to be called for each value of a sequence */
+#define HASH_INIT 2166136261u
+unsigned int hashIntUpdate(unsigned int hash, int value);
+
 #endif
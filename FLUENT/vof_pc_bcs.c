@@ -12,12 +12,13 @@ The above copyright notice and this permission notice shall be included in all c
 THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */ 
 #include "vof_pc_main.h"
+#include "vof_pc_zone_storage.h"
 
 
   DEFINE_SOURCE(Jouleheating, c, t, dS, eqn)
   {
-    #if (N_UDM >= 0)
-    return C_UDMI(c, t, UDM_JH);
+    #if ZONE_COUPLING_STORAGE || (N_UDM >= 0)
+    return C_COUPLING(c, t, UDM_JH);
     #else
     return 0
     #endif
@@ -26,8 +27,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 DEFINE_SOURCE(v_x_lorentz, c, t, dS, eqn)
 {
-  #if (N_UDM >= 1)
-  return C_UDMI(c, t, UDM_LFx);
+  #if ZONE_COUPLING_STORAGE || (N_UDM >= 1)
+  return C_COUPLING(c, t, UDM_LFx);
   #else
   return 0;
   #endif
@@ -36,8 +37,8 @@ DEFINE_SOURCE(v_x_lorentz, c, t, dS, eqn)
 
 DEFINE_SOURCE(v_y_lorentz, c, t, dS, eqn)
 {
-  #if (N_UDM >= 2)
-  return C_UDMI(c, t, UDM_LFy);
+  #if ZONE_COUPLING_STORAGE || (N_UDM >= 2)
+  return C_COUPLING(c, t, UDM_LFy);
   #else
   return 0;
   #endif
@@ -46,8 +47,8 @@ DEFINE_SOURCE(v_y_lorentz, c, t, dS, eqn)
 
 DEFINE_SOURCE(v_z_lorentz, c, t, dS, eqn)
 {
-  #if (N_UDM >= 3)
-  return C_UDMI(c, t, UDM_LFz);
+  #if ZONE_COUPLING_STORAGE || (N_UDM >= 3)
+  return C_COUPLING(c, t, UDM_LFz);
   #else
   return 0;
   #endif
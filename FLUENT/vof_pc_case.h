@@ -33,6 +33,7 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define _ANSYS_TO_FLUENT_MIXTURE_COORDS_OUT_DAT_ _XC_FOLDER_PATH_ "ANSYS_TO_FLUENT_MIXTURE_COORDS_OUT.DAT"
 #define _ANSYS_TO_FLUENT_MIXTURE_JH_OUT_DAT_ _XC_FOLDER_PATH_ "ANSYS_TO_FLUENT_MIXTURE_JH_OUT.DAT"
 #define _ANSYS_TO_FLUENT_MIXTURE_LF_OUT_DAT_ _XC_FOLDER_PATH_ "ANSYS_TO_FLUENT_MIXTURE_LF_OUT.DAT"
+#define _ANSYS_TO_FLUENT_MIXTURE_OUT_DAT_ _XC_FOLDER_PATH_ "ANSYS_TO_FLUENT_OUT.DAT"
 
 #define _FLUENT_DEBUG_MIXTURE_COORDS_OUT_DAT_ _XC_FOLDER_PATH_ "FLUENT_DEBUG_MIXTURE_COORDS_OUT.DAT"
 
@@ -62,4 +63,13 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #define _FLUENT_TO_ANSYS_MAPPING_DAT_ _XC_FOLDER_PATH_ "FLUENT_TO_ANSYS_MAP.DAT"
 
 
+/* COUPLING TRACE (see COUPLING_TRACE in vof_pc_main.h) */
+#define _COUPLING_TRACE_DAT_ _XC_FOLDER_PATH_ "COUPLING_TRACE.BIN"
+#define _COUPLING_TRACE_INDEX_DAT_ _XC_FOLDER_PATH_ "COUPLING_TRACE.IDX"
+
+/* EXCHANGE RECORDING (see XC_RECORDING in vof_pc_main.h), folder has to exist */
+#define _XC_RECORD_FOLDER_PATH_ _XC_FOLDER_PATH_ "record/"
+#define _XC_RECORD_DAT_ _XC_RECORD_FOLDER_PATH_ "XC_RECORD.TXT"
+
+
 #endif
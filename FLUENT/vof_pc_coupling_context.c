@@ -0,0 +1,127 @@
+/*
+Coupling context: the mappings and exchange plans of all coupled cell zones in
+one structure, the per zone records share a single allocation (arena).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_coupling_context.h"
+
+/* alignment of the arrays within the arena */
+#define COUPLING_ARENA_ALIGN(size) (((size) + 15) & ~((size_t) 15))
+
+
+int initCouplingContext(
+                        CouplingContext *ctx,
+                        const CouplingZoneConfig configs[],
+                        int no_zones
+                        )
+{
+/*
+    Allocates the records of the no_zones zones configured by configs[] in
+    one arena, the records are zeroed except for their configuration. Frees
+    a previous context before.
+*/
+size_t size_zones = COUPLING_ARENA_ALIGN(no_zones * sizeof(CouplingZone));
+size_t size_packed = COUPLING_ARENA_ALIGN(no_zones * sizeof(PackedScatterZone));
+size_t size_idx = COUPLING_ARENA_ALIGN(no_zones * sizeof(int));
+char *pos = NULL;
+int iz;
+
+freeCouplingContext(ctx);
+
+if(no_zones < 1)
+{
+    Message("Error (initCouplingContext()): No coupled zones!\n");
+    return _STATE_ERROR;
+}
+
+ctx->arena = calloc(1, size_zones + size_packed + 2 * size_idx);
+
+if(ctx->arena == NULL)
+{
+    Message("Error (initCouplingContext()): Memory allocation error!\n");
+    return _STATE_ERROR;
+}
+
+pos = (char *) ctx->arena;
+ctx->zones = (CouplingZone *) pos;
+pos += size_zones;
+ctx->packed_zones = (PackedScatterZone *) pos;
+pos += size_packed;
+ctx->packed_zone_idx = (int *) pos;
+pos += size_idx;
+ctx->cell_zone_ids = (int *) pos;
+ctx->no_zones = no_zones;
+
+for(iz = 0; iz < no_zones; ++iz)
+{
+    ctx->zones[iz].config = configs[iz];
+    ctx->cell_zone_ids[iz] = configs[iz].cell_zone_id;
+}
+
+return _STATE_OK;
+}
+
+
+void freeCouplingZoneA2FResults(CouplingZone *zone)
+{
+    free(zone->a_vol_vals);
+    free(zone->a_elem_vols);
+    free(zone->a_vec_vals);
+
+    zone->a_vol_vals = NULL;
+    zone->a_elem_vols = NULL;
+    zone->a_vec_vals = NULL;
+}
+
+
+void freeCouplingContext(CouplingContext *ctx)
+{
+int iz;
+CouplingZone *zone;
+
+if(ctx == NULL)
+{
+    return;
+}
+
+for(iz = 0; iz < ctx->no_zones && ctx->zones != NULL; ++iz)
+{
+    zone = &ctx->zones[iz];
+
+    free(zone->a2f_mapping);
+    free(zone->a2f_weights);
+    free(zone->f2a_mapping);
+    free(zone->f2a_weights);
+    free(zone->f_ordered_cids);
+    free(zone->f_ordered_myids);
+    free(zone->f_no_cells_per_node);
+    freeCouplingZoneA2FResults(zone);
+    free(zone->a_static_elem_vols);
+    free(zone->staged_vof);
+    free(zone->old_vof);
+
+    freeScatterPlan(&zone->a2f_scatter_plan);
+    freeA2FStreamPlan(&zone->a2f_stream_plan);
+    freeF2AAggregationPlan(&zone->f2a_agg_plan);
+    freeF2AParallelWritePlan(&zone->f2a_pw_plan);
+    freeNodeZeroIOPlan(&zone->node_zero_io_plan);
+}
+
+free(ctx->arena);
+
+ctx->arena = NULL;
+ctx->zones = NULL;
+ctx->packed_zones = NULL;
+ctx->packed_zone_idx = NULL;
+ctx->cell_zone_ids = NULL;
+ctx->no_zones = 0;
+}
@@ -0,0 +1,123 @@
+/*
+Coupling context: the mappings and exchange plans of all coupled cell zones in
+one structure, the per zone records share a single allocation (arena).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_COUPLING_CONTEXT_H
+#include "vof_pc_main.h"
+#include "vof_pc_f2a_aggregation.h"
+#include "vof_pc_scatter_plan.h"
+#include "vof_pc_host_streaming.h"
+#include "vof_pc_node_zero_io.h"
+#include "vof_pc_parallel_write.h"
+#define VOF_PC_COUPLING_CONTEXT_H
+
+/*
+Configuration of one coupled cell zone, the case lists any number of zones
+(see vof_pc_nn_coupling.c), initCouplingContext() copies them into the zones.
+*/
+typedef struct coupling_zone_config_struct
+{
+    int cell_zone_id;
+    int a2f_coupling;
+    int f2a_coupling;
+    int a2f_property; /* JOULE_HEAT_PLUS_LORENTZ, JOULE_HEAT, NONE */
+    int f2a_property; /* VOF, NONE */
+    int f2a_aggregation; /* only used with F2A_NODE_AGGREGATION */
+    int f2a_xc_format; /* only used with F2A_NODE_AGGREGATION, A2F files are detected */
+    char a_coords_file[250];
+    char a_jh_file[250];
+    char a_lf_file[250];
+    char a_merged_file[250]; /* only used with A2F_MERGED_FILE */
+    char f2a_file[250];
+    char a2f_mapping_file[250];
+    char f2a_mapping_file[250];
+    char f_debug_coords_file[250];
+} CouplingZoneConfig;
+
+/*
+Value of fluent cell c proptery of the zone:
+prop_fluent[c] = prop_ansys[a2f_mapping[c]] * a2f_weights[c]
+Value of ansys element e propery of the zone:
+prop_ansys[e] = prop_ansys[f2a_mapping[c]] * f2a_weights[c]
+The mappings and the cell ordering are only allocated on the host, the plans
+on host and nodes (see their headers).
+*/
+typedef struct coupling_zone_struct
+{
+    /* host and nodes */
+    CouplingZoneConfig config;
+
+    /* host */
+    int *a2f_mapping;
+    real *a2f_weights;
+    int *f2a_mapping;
+    real *f2a_weights;
+    int *f_ordered_cids; /* cell ids ordered from node 0 to node p */
+    int *f_ordered_myids; /* node ids from 0 to p for each fluent cell */
+    int *f_no_cells_per_node;
+    int no_a_elems;
+    int no_f_cells;
+
+    /* host: ANSYS results of the current A2F exchange */
+    real *a_vol_vals;
+    real *a_elem_vols;
+    real (*a_vec_vals)[ND_ND];
+
+    /* host: ANSYS element volumes of the first A2F exchange (A2F_STATIC_ELEM_VOLUMES) */
+    real *a_static_elem_vols;
+
+    /* nodes: VOF of the zone cells staged by the loose coupling check */
+    real *staged_vof;
+    int no_staged_vof;
+
+    /* nodes: VOF of the zone cells at the last coupling, used instead of UDM_VOF_old */
+    real *old_vof;
+    int no_old_vof;
+
+    /* host and nodes */
+    ScatterPlan a2f_scatter_plan;
+    A2FStreamPlan a2f_stream_plan; /* HOST_STREAMING_EXCHANGE, A2F_NODE_MAPPING, NODE_ZERO_IO, A2F_PARALLEL_READ */
+    F2AAggregationPlan f2a_agg_plan; /* F2A_NODE_AGGREGATION */
+    F2AParallelWritePlan f2a_pw_plan; /* F2A_PARALLEL_WRITE */
+    NodeZeroIOPlan node_zero_io_plan; /* NODE_ZERO_IO */
+} CouplingZone;
+
+/*
+The zone records and the per zone arrays of the packed A2F exchange are
+carved from one arena sized by initCouplingContext() from the configured
+zones, freeCouplingContext()
+releases the arena and everything the zones own, so the context can simply be
+initialized again (e.g. after repartitioning).
+*/
+typedef struct coupling_context_struct
+{
+    int no_zones;
+    CouplingZone *zones;
+    PackedScatterZone *packed_zones;
+    int *packed_zone_idx;
+    int *cell_zone_ids; /* cell_zone_id of all zones, e.g. for initZoneStorages() */
+    void *arena;
+} CouplingContext;
+
+
+int initCouplingContext(
+                        CouplingContext *ctx,
+                        const CouplingZoneConfig configs[],
+                        int no_zones
+                        );
+
+void freeCouplingZoneA2FResults(CouplingZone *zone);
+
+void freeCouplingContext(CouplingContext *ctx);
+
+#endif
@@ -0,0 +1,458 @@
+/*
+Exchange file backends: the XC files of a zone are written and read through
+an XCBackend, either as text tables (as read and written by the APDL script)
+or as self-describing binary files for coupling partners which can use them.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_exchange_backend.h"
+#include "vof_pc_read_ansys.h"
+
+/* rows converted per fread/fwrite of the binary backend */
+#define XC_BINARY_BLOCK_ROWS 4096
+
+
+static int openXCFile(XCFile *file, char filename[], int mode, const char *fmode)
+{
+    file->filename = filename;
+    file->mode = mode;
+    file->state = _STATE_OK;
+    file->no_rows = 0;
+    file->no_cols = 0;
+    file->value_size = 0;
+
+    if(mode == XC_WRITE)
+    {
+        exchangePartFileName(file->part_file, filename);
+        file->fp = fopen(file->part_file, fmode);
+    }
+    else
+    {
+        file->fp = fopen(filename, fmode);
+    }
+
+    return (file->fp == NULL) ? _STATE_ERROR : _STATE_OK;
+}
+
+
+static int commitXCFile(XCFile *file)
+{
+    int state = file->state;
+
+    if(file->fp != NULL)
+    {
+        if(
+            ferror(file->fp) ||
+            (file->mode == XC_WRITE && flushExchangeFile(file->fp) != _STATE_OK)
+          )
+        {
+            state = _STATE_ERROR;
+        }
+        if(fclose(file->fp) != 0)
+        {
+            state = _STATE_ERROR;
+        }
+        file->fp = NULL;
+
+        if(file->mode == XC_WRITE)
+        {
+            state = publishExchangeFile(file->part_file, file->filename, state);
+        }
+    }
+
+    return state;
+}
+
+
+/* --- text tables --------------------------------------------------------- */
+
+static int countTextXCColumns(FILE *fp)
+{
+/*
+    Counts the whitespace separated entries of the first non empty line.
+*/
+    int no_cols = 0;
+    int in_entry = 0;
+    int c;
+
+    while((c = fgetc(fp)) != EOF && !(c == '\n' && no_cols > 0))
+    {
+        if(c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            in_entry = 0;
+        }
+        else if(!in_entry)
+        {
+            in_entry = 1;
+            ++no_cols;
+        }
+    }
+
+    return no_cols;
+}
+
+
+static int openTextXCFile(XCFile *file, char filename[], int mode)
+{
+/*
+    Tables are written through a TextWriter and read by
+    readAnsysTableColumns() itself, so when reading only their existence and
+    the columns of the first row are checked here.
+*/
+    if(mode == XC_WRITE)
+    {
+        file->filename = filename;
+        file->mode = mode;
+        file->state = _STATE_OK;
+        file->fp = NULL;
+
+        return openTextWriter(&file->writer, filename);
+    }
+
+    if(openXCFile(file, filename, mode, "r") != _STATE_OK)
+    {
+        return _STATE_ERROR;
+    }
+
+    file->no_cols = countTextXCColumns(file->fp);
+
+    fclose(file->fp);
+    file->fp = NULL;
+
+    return _STATE_OK;
+}
+
+
+static int writeTextXCField(XCFile *file, real *cols[], int no_cols, int stride,
+                            int no_rows)
+{
+/*
+    One row per line, columns separated by a blank, in the format of
+    writeRealArrToFile().
+*/
+    int i, k;
+
+    for(i = 0; i < no_rows; ++i)
+    {
+        for(k = 0; k < no_cols; ++k)
+        {
+            writeTextFixed(&file->writer, cols[k][i * stride], 0, 6);
+            writeTextChar(&file->writer, (k < no_cols - 1) ? ' ' : '\n');
+        }
+    }
+
+    return file->writer.state;
+}
+
+
+static int commitTextXCFile(XCFile *file)
+{
+    if(file->mode == XC_WRITE)
+    {
+        if(file->state == _STATE_ERROR)
+        {
+            file->writer.state = _STATE_ERROR;
+        }
+        return closeTextWriter(&file->writer);
+    }
+
+    return commitXCFile(file);
+}
+
+
+static int readTextXCField(XCFile *file, real *cols[], int no_cols, int stride,
+                           int max_rows, int *no_rows, int *more_rows)
+{
+    return readAnsysTableColumns(file->filename, no_cols, cols, stride,
+                                 max_rows, no_rows, more_rows);
+}
+
+
+/* --- binary files -------------------------------------------------------- */
+
+int isLittleEndianHost()
+{
+    const int one = 1;
+
+    return *((const char *) &one) == 1;
+}
+
+
+void putLittleEndianInt(unsigned char *buf, int val)
+{
+    unsigned int u = (unsigned int) val;
+
+    buf[0] = (unsigned char) (u & 0xff);
+    buf[1] = (unsigned char) ((u >> 8) & 0xff);
+    buf[2] = (unsigned char) ((u >> 16) & 0xff);
+    buf[3] = (unsigned char) ((u >> 24) & 0xff);
+}
+
+
+int getLittleEndianInt(const unsigned char *buf)
+{
+    return (int) ((unsigned int) buf[0] | ((unsigned int) buf[1] << 8) |
+                  ((unsigned int) buf[2] << 16) | ((unsigned int) buf[3] << 24));
+}
+
+
+static int openBinaryXCFile(XCFile *file, char filename[], int mode)
+{
+/*
+    Opens filename, when reading its header is checked and kept in file.
+*/
+unsigned char header[XC_BINARY_HEADER_SIZE];
+int state = _STATE_OK;
+
+if(!isLittleEndianHost())
+{
+    threadMessage("Error (openBinaryXCFile()): Binary exchange files need a little "
+            "endian host!\n");
+    return _STATE_ERROR;
+}
+
+state = openXCFile(file, filename, mode, (mode == XC_WRITE) ? "wb" : "rb");
+
+if(state == _STATE_OK && mode == XC_READ)
+{
+    if(
+        fread(header, 1, XC_BINARY_HEADER_SIZE, file->fp) != XC_BINARY_HEADER_SIZE ||
+        memcmp(header, XC_BINARY_MAGIC, XC_BINARY_MAGIC_SIZE) != 0
+      )
+    {
+        threadMessage("Error (openBinaryXCFile()): %s has no binary exchange "
+                "header!\n", filename);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        file->no_rows = getLittleEndianInt(header + XC_BINARY_MAGIC_SIZE);
+        file->no_cols = getLittleEndianInt(header + XC_BINARY_MAGIC_SIZE + 4);
+        file->value_size = getLittleEndianInt(header + XC_BINARY_MAGIC_SIZE + 8);
+
+        if(
+            file->no_rows < 0 || file->no_cols < 1 ||
+            (file->value_size != sizeof(float) && file->value_size != sizeof(double))
+          )
+        {
+            threadMessage("Error (openBinaryXCFile()): Wrong header in %s!\n",
+                    filename);
+            state = _STATE_ERROR;
+        }
+    }
+
+    if(state == _STATE_ERROR)
+    {
+        fclose(file->fp);
+        file->fp = NULL;
+    }
+}
+
+return state;
+}
+
+
+static int writeBinaryXCField(XCFile *file, real *cols[], int no_cols, int stride,
+                              int no_rows)
+{
+/*
+    Writes the header and the values in the precision of real.
+*/
+unsigned char header[XC_BINARY_HEADER_SIZE];
+real *block = NULL;
+int state = _STATE_OK;
+int i, j, k, n;
+
+memset(header, 0, XC_BINARY_HEADER_SIZE);
+memcpy(header, XC_BINARY_MAGIC, XC_BINARY_MAGIC_SIZE);
+putLittleEndianInt(header + XC_BINARY_MAGIC_SIZE, no_rows);
+putLittleEndianInt(header + XC_BINARY_MAGIC_SIZE + 4, no_cols);
+putLittleEndianInt(header + XC_BINARY_MAGIC_SIZE + 8, (int) sizeof(real));
+
+block = (real *) malloc(XC_BINARY_BLOCK_ROWS * no_cols * sizeof(real));
+
+if(
+    block == NULL ||
+    fwrite(header, 1, XC_BINARY_HEADER_SIZE, file->fp) != XC_BINARY_HEADER_SIZE
+  )
+{
+    state = _STATE_ERROR;
+}
+
+for(i = 0; i < no_rows && state != _STATE_ERROR; i += XC_BINARY_BLOCK_ROWS)
+{
+    n = (no_rows - i < XC_BINARY_BLOCK_ROWS) ? no_rows - i : XC_BINARY_BLOCK_ROWS;
+
+    for(j = 0; j < n; ++j)
+    {
+        for(k = 0; k < no_cols; ++k)
+        {
+            block[j * no_cols + k] = cols[k][(i + j) * stride];
+        }
+    }
+
+    if(fwrite(block, sizeof(real), (size_t) (n * no_cols), file->fp) !=
+       (size_t) (n * no_cols))
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+free(block);
+
+return state;
+}
+
+
+static int readBinaryXCField(XCFile *file, real *cols[], int no_cols, int stride,
+                             int max_rows, int *no_rows, int *more_rows)
+{
+/*
+    Reads max_rows rows at most, single and double precision files are
+    converted to real.
+*/
+unsigned char *block = NULL;
+int state = _STATE_OK;
+int i, j, k, n;
+size_t no_vals;
+
+(*no_rows) = 0;
+(*more_rows) = (file->no_rows > max_rows);
+
+if(file->no_cols != no_cols)
+{
+    threadMessage("Error (readBinaryXCField()): %s has %i instead of %i columns!\n",
+            file->filename, file->no_cols, no_cols);
+    return _STATE_ERROR;
+}
+
+block = (unsigned char *) malloc(XC_BINARY_BLOCK_ROWS * no_cols * file->value_size);
+
+if(block == NULL)
+{
+    return _STATE_ERROR;
+}
+
+for(i = 0; i < file->no_rows && i < max_rows && state != _STATE_ERROR;
+    i += XC_BINARY_BLOCK_ROWS)
+{
+    n = (file->no_rows - i < XC_BINARY_BLOCK_ROWS) ? file->no_rows - i : XC_BINARY_BLOCK_ROWS;
+    n = (max_rows - i < n) ? max_rows - i : n;
+    no_vals = (size_t) (n * no_cols);
+
+    if(fread(block, (size_t) file->value_size, no_vals, file->fp) != no_vals)
+    {
+        threadMessage("Error (readBinaryXCField()): %s ends after %i rows!\n",
+                file->filename, i);
+        state = _STATE_ERROR;
+        break;
+    }
+
+    for(j = 0; j < n; ++j)
+    {
+        for(k = 0; k < no_cols; ++k)
+        {
+            if(cols[k] != NULL)
+            {
+                cols[k][(i + j) * stride] = (file->value_size == sizeof(float)) ?
+                    (real) ((float *) block)[j * no_cols + k] :
+                    (real) ((double *) block)[j * no_cols + k];
+            }
+        }
+    }
+
+    (*no_rows) += n;
+}
+
+free(block);
+
+return state;
+}
+
+
+static const XCBackend _g_xc_backends[2] = {
+    {"text", openTextXCFile, writeTextXCField, readTextXCField, commitTextXCFile},
+    {"binary", openBinaryXCFile, writeBinaryXCField, readBinaryXCField, commitXCFile}
+};
+
+
+const XCBackend *xcBackend(int format)
+{
+    return &_g_xc_backends[(format == XC_FORMAT_BINARY) ? 1 : 0];
+}
+
+
+int xcFormatOfFile(char filename[])
+{
+/*
+    XC_FORMAT_BINARY if filename starts with XC_BINARY_MAGIC, XC_FORMAT_TEXT
+    otherwise (also if it can not be opened).
+*/
+    char magic[XC_BINARY_MAGIC_SIZE];
+    int format = XC_FORMAT_TEXT;
+    FILE *fp = fopen(filename, "rb");
+
+    if(fp != NULL)
+    {
+        if(
+            fread(magic, 1, XC_BINARY_MAGIC_SIZE, fp) == XC_BINARY_MAGIC_SIZE &&
+            memcmp(magic, XC_BINARY_MAGIC, XC_BINARY_MAGIC_SIZE) == 0
+          )
+        {
+            format = XC_FORMAT_BINARY;
+        }
+        fclose(fp);
+    }
+
+    return format;
+}
+
+
+int xcWriteField(
+                    int format,
+                    char filename[],
+                    real *cols[],
+                    int no_cols,
+                    int stride,
+                    int no_rows
+                )
+{
+/*
+    Writes a complete field file with the backend of format.
+*/
+const XCBackend *backend = xcBackend(format);
+XCFile file;
+int state = _STATE_OK;
+
+file.backend = backend;
+
+if(backend->open(&file, filename, XC_WRITE) != _STATE_OK)
+{
+    threadMessage("Error (xcWriteField()): Unable to open %s \n", filename);
+    return _STATE_ERROR;
+}
+
+state = backend->writeField(&file, cols, no_cols, stride, no_rows);
+file.state = state;
+
+if(backend->commit(&file) != _STATE_OK)
+{
+    state = _STATE_ERROR;
+}
+
+if(state == _STATE_ERROR)
+{
+    threadMessage("Error (xcWriteField()): Writing %s (%s) failed!\n", filename,
+            backend->name);
+}
+
+return state;
+}
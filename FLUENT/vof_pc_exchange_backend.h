@@ -0,0 +1,88 @@
+/*
+Exchange file backends: the XC files of a zone are written and read through
+an XCBackend, either as text tables (as read and written by the APDL script)
+or as self-describing binary files for coupling partners which can use them.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_EXCHANGE_BACKEND_H
+#include "vof_pc_main.h"
+#include "vof_pc_text_writer.h"
+#define VOF_PC_EXCHANGE_BACKEND_H
+
+enum xcFormats {XC_FORMAT_TEXT=0, XC_FORMAT_BINARY};
+enum xcModes {XC_READ=0, XC_WRITE};
+
+/*
+Binary layout (little endian): XC_BINARY_HEADER_SIZE bytes header of
+XC_BINARY_MAGIC, number of rows, number of columns and bytes per value
+(4 or 8) as 32 bit integers and zero padding, followed by the row major
+values. The values start 8 byte aligned, so the file can be mapped directly.
+*/
+#define XC_BINARY_MAGIC "VOFPCXC1"
+#define XC_BINARY_MAGIC_SIZE 8
+#define XC_BINARY_HEADER_SIZE 32
+
+typedef struct xc_file_struct
+{
+    const struct xc_backend_struct *backend;
+    char *filename;
+    char part_file[XC_PART_FILENAME_SIZE]; /* binary backend when writing */
+    FILE *fp;
+    TextWriter writer; /* text backend when writing */
+    int mode;
+    int state; /* a written file is discarded on commit() if _STATE_ERROR */
+
+    /* when reading: rows of the binary header, columns of the binary header 
+    or of the first row of a text table */
+    int no_rows;
+    int no_cols;
+    int value_size;
+} XCFile;
+
+/*
+A field is a table of no_cols columns, value k of row i is cols[k][i * stride],
+when reading a NULL cols[k] skips column k.
+commit() closes the file, a written file is published (see
+publishExchangeFile()) and complete only if it returns _STATE_OK.
+*/
+typedef struct xc_backend_struct
+{
+    const char *name;
+    int (*open)(XCFile *file, char filename[], int mode);
+    int (*writeField)(XCFile *file, real *cols[], int no_cols, int stride,
+                      int no_rows);
+    int (*readField)(XCFile *file, real *cols[], int no_cols, int stride,
+                     int max_rows, int *no_rows, int *more_rows);
+    int (*commit)(XCFile *file);
+} XCBackend;
+
+
+const XCBackend *xcBackend(int format);
+
+int xcFormatOfFile(char filename[]);
+
+int xcWriteField(
+                    int format,
+                    char filename[],
+                    real *cols[],
+                    int no_cols,
+                    int stride,
+                    int no_rows
+                );
+
+int isLittleEndianHost();
+
+void putLittleEndianInt(unsigned char *buf, int val);
+
+int getLittleEndianInt(const unsigned char *buf);
+
+#endif
@@ -0,0 +1,700 @@
+/*
+Node-side aggregation of Fluent cell values to ANSYS element values (F2A), so
+that the host only receives and holds ANSYS element sized arrays.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_f2a_aggregation.h"
+
+
+int initF2AAggregationPlanOfCellZone(
+                                        F2AAggregationPlan *plan,
+                                        int aggregation_mode,
+                                        int *a2f_mapping_zone,
+                                        int *f2a_mapping_zone,
+                                        int *f_ordered_myids_zone,
+                                        int *f_cells_per_node,
+                                        int no_f_cells_zone,
+                                        int no_a_elems_zone,
+                                        int fluid_zone_id
+                                    )
+{
+/*
+    Builds the aggregation plan of a coupled zone on the host from the NN
+    mappings and sends each compute node its contributions once:
+
+    F2A_AGG_PICK:         element e <- fluent cell a2f_mapping_zone[e]
+    F2A_AGG_VOL_WEIGHTED: element e <- all fluent cells i with
+                          f2a_mapping_zone[i] == e, or the picked cell if
+                          there is no such cell
+
+    Afterwards the sum of weights of every element is reduced to the host.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int no_contribs_node = 0;
+int *no_slots_node_arr = NULL;
+int count = 0;
+real *node_slot_weight_sum = NULL;
+void *slot_weight_sum_full = NULL;
+int size_slot_weight_sum_full = 0;
+int i = 0;
+
+#if RP_HOST
+int pe;
+int e = 0;
+int p = 0;
+int k = 0;
+int no_contribs = 0;
+int *node_start = NULL;
+int *contrib_node = NULL;
+int *contrib_cell = NULL;
+int *contrib_elem = NULL;
+int *contribs_per_node = NULL;
+int *node_offset = NULL;
+int *sorted_cell = NULL;
+int *sorted_slot = NULL;
+int *sorted_elem = NULL;
+int *elem_slot = NULL;
+int *elem_slot_owner = NULL;
+int *ones_per_node = NULL;
+#endif
+
+#if RP_NODE
+cell_t c;
+Thread *t;
+Domain *domain = Get_Domain(1);
+real *cell_vol = NULL;
+int no_cells = 0;
+int no_slots_node = 0;
+int k = 0;
+#endif
+
+plan->aggregation_mode = aggregation_mode;
+plan->no_a_elems = no_a_elems_zone;
+plan->xc_format = XC_FORMAT_TEXT;
+plan->no_slots_per_node = NULL;
+plan->slot_elem_idx = NULL;
+plan->no_slots_full = 0;
+plan->elem_weight_sum = NULL;
+plan->no_slots_node = 0;
+plan->no_contribs_node = 0;
+plan->contrib_cell_idx = NULL;
+plan->contrib_slot_idx = NULL;
+plan->contrib_weight = NULL;
+
+#if RP_HOST
+node_start = (int *) calloc(compute_node_count + 1, sizeof(int));
+contribs_per_node = (int *) calloc(compute_node_count, sizeof(int));
+node_offset = (int *) calloc(compute_node_count, sizeof(int));
+ones_per_node = (int *) calloc(compute_node_count, sizeof(int));
+plan->no_slots_per_node = (int *) calloc(compute_node_count, sizeof(int));
+elem_slot = (int *) calloc(no_a_elems_zone, sizeof(int));
+elem_slot_owner = (int *) calloc(no_a_elems_zone, sizeof(int));
+
+if(
+    node_start == NULL || contribs_per_node == NULL || node_offset == NULL ||
+    ones_per_node == NULL || plan->no_slots_per_node == NULL ||
+    elem_slot == NULL || elem_slot_owner == NULL ||
+    a2f_mapping_zone == NULL || f2a_mapping_zone == NULL ||
+    f_ordered_myids_zone == NULL || f_cells_per_node == NULL
+  )
+{
+    Message("Error (initF2AAggregationPlanOfCellZone()): Memory allocation "
+            "error or missing mappings for zone id %i!\n", fluid_zone_id);
+    state = _STATE_ERROR;
+}
+else
+{
+    /* first ordered fluent cell index of each compute node */
+    compute_node_loop (pe)
+    {
+        node_start[pe + 1] = node_start[pe] + f_cells_per_node[pe];
+        ones_per_node[pe] = 1;
+    }
+
+    /* elem_slot is used as covered marker first */
+    no_contribs = no_a_elems_zone;
+    if(aggregation_mode == F2A_AGG_VOL_WEIGHTED)
+    {
+        for(i = 0; i < no_f_cells_zone; ++i)
+        {
+            e = f2a_mapping_zone[i];
+            if(e >= 0 && e < no_a_elems_zone && elem_slot[e] == 0)
+            {
+                elem_slot[e] = 1;
+                --no_contribs;
+            }
+        }
+        no_contribs += no_f_cells_zone;
+    }
+
+    contrib_node = (int *) calloc(no_contribs, sizeof(int));
+    contrib_cell = (int *) calloc(no_contribs, sizeof(int));
+    contrib_elem = (int *) calloc(no_contribs, sizeof(int));
+    sorted_cell = (int *) calloc(no_contribs, sizeof(int));
+    sorted_slot = (int *) calloc(no_contribs, sizeof(int));
+    sorted_elem = (int *) calloc(no_contribs, sizeof(int));
+
+    if(
+        contrib_node == NULL || contrib_cell == NULL || contrib_elem == NULL ||
+        sorted_cell == NULL || sorted_slot == NULL || sorted_elem == NULL
+      )
+    {
+        Message("Error (initF2AAggregationPlanOfCellZone()): Memory "
+                "allocation error!\n");
+        state = _STATE_ERROR;
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    k = 0;
+    if(aggregation_mode == F2A_AGG_VOL_WEIGHTED)
+    {
+        for(i = 0; i < no_f_cells_zone; ++i)
+        {
+            contrib_cell[k] = i;
+            contrib_elem[k] = f2a_mapping_zone[i];
+            ++k;
+        }
+    }
+
+    for(e = 0; e < no_a_elems_zone; ++e)
+    {
+        if(aggregation_mode != F2A_AGG_VOL_WEIGHTED || elem_slot[e] == 0)
+        {
+            contrib_cell[k] = a2f_mapping_zone[e];
+            contrib_elem[k] = e;
+            ++k;
+        }
+    }
+
+    /* ordered fluent index -> compute node and local cell index */
+    for(k = 0; k < no_contribs && state != _STATE_ERROR; ++k)
+    {
+        i = contrib_cell[k];
+
+        if(
+            i < 0 || i >= no_f_cells_zone ||
+            contrib_elem[k] < 0 || contrib_elem[k] >= no_a_elems_zone
+          )
+        {
+            Message("Error (initF2AAggregationPlanOfCellZone()): Mapping "
+                    "index out of bounds!\n");
+            state = _STATE_ERROR;
+        }
+        else
+        {
+            p = f_ordered_myids_zone[i];
+
+            if(p < 0 || p >= compute_node_count)
+            {
+                Message("Error (initF2AAggregationPlanOfCellZone()): Wrong "
+                        "compute node id %i!\n", p);
+                state = _STATE_ERROR;
+            }
+            else
+            {
+                contrib_node[k] = p;
+                contrib_cell[k] = i - node_start[p];
+                ++contribs_per_node[p];
+            }
+        }
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    /* sort contributions by compute node */
+    for(p = 1; p < compute_node_count; ++p)
+    {
+        node_offset[p] = node_offset[p - 1] + contribs_per_node[p - 1];
+    }
+
+    for(k = 0; k < no_contribs; ++k)
+    {
+        p = contrib_node[k];
+        sorted_cell[node_offset[p]] = contrib_cell[k];
+        sorted_elem[node_offset[p]] = contrib_elem[k];
+        ++node_offset[p];
+    }
+
+    /* assign node-local slots, one per touched element and node */
+    for(e = 0; e < no_a_elems_zone; ++e)
+    {
+        elem_slot_owner[e] = -1;
+    }
+
+    plan->slot_elem_idx = (int *) calloc(no_contribs, sizeof(int));
+
+    if(plan->slot_elem_idx == NULL)
+    {
+        Message("Error (initF2AAggregationPlanOfCellZone()): Memory "
+                "allocation error!\n");
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        k = 0;
+        compute_node_loop (pe)
+        {
+            for(i = k; i < k + contribs_per_node[pe]; ++i)
+            {
+                e = sorted_elem[i];
+
+                if(elem_slot_owner[e] != pe)
+                {
+                    elem_slot_owner[e] = pe;
+                    elem_slot[e] = plan->no_slots_per_node[pe];
+                    plan->slot_elem_idx[plan->no_slots_full] = e;
+                    ++plan->no_slots_per_node[pe];
+                    ++plan->no_slots_full;
+                }
+                sorted_slot[i] = elem_slot[e];
+            }
+            k += contribs_per_node[pe];
+        }
+
+        Message("Info (initF2AAggregationPlanOfCellZone()): %i contributions "
+                "to %i element slots for %i ANSYS elements in zone id %i.\n",
+                no_contribs, plan->no_slots_full, no_a_elems_zone, fluid_zone_id);
+    }
+}
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    hostToNodesIntArrays(sorted_cell, contribs_per_node,
+                         &plan->contrib_cell_idx, &no_contribs_node);
+    hostToNodesIntArrays(sorted_slot, contribs_per_node,
+                         &plan->contrib_slot_idx, &no_contribs_node);
+    hostToNodesIntArrays(plan->no_slots_per_node, ones_per_node,
+                         &no_slots_node_arr, &count);
+}
+
+free(node_start);
+free(contribs_per_node);
+free(node_offset);
+free(ones_per_node);
+free(elem_slot);
+free(elem_slot_owner);
+free(contrib_node);
+free(contrib_cell);
+free(contrib_elem);
+free(sorted_cell);
+free(sorted_slot);
+free(sorted_elem);
+#endif /* RP_HOST */
+
+#if RP_NODE
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    /* the host sends all three arrays, so every node receives all of them, 
+    the state is reduced below */
+    if(hostToNodesIntArrays(NULL, NULL, &plan->contrib_cell_idx,
+                            &no_contribs_node) == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+    if(hostToNodesIntArrays(NULL, NULL, &plan->contrib_slot_idx,
+                            &no_contribs_node) == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+    if(hostToNodesIntArrays(NULL, NULL, &no_slots_node_arr, &count)
+       == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+
+    if(state != _STATE_ERROR && count == 1)
+    {
+        no_slots_node = no_slots_node_arr[0];
+    }
+
+    plan->no_contribs_node = no_contribs_node;
+    plan->no_slots_node = no_slots_node;
+
+    t = Lookup_Thread(domain, fluid_zone_id);
+    no_cells = THREAD_N_ELEMENTS_INT(t);
+
+    for(k = 0; k < no_contribs_node && state != _STATE_ERROR; ++k)
+    {
+        if(
+            plan->contrib_cell_idx[k] < 0 ||
+            plan->contrib_cell_idx[k] >= no_cells ||
+            plan->contrib_slot_idx[k] < 0 ||
+            plan->contrib_slot_idx[k] >= no_slots_node
+          )
+        {
+            Message("Error (initF2AAggregationPlanOfCellZone()): Contribution "
+                    "out of bounds on node %i!\n", myid);
+            state = _STATE_ERROR;
+        }
+    }
+
+    if(state != _STATE_ERROR && aggregation_mode == F2A_AGG_VOL_WEIGHTED)
+    {
+        cell_vol = (real *) calloc(no_cells + 1, sizeof(real));
+        plan->contrib_weight = (real *) calloc(no_contribs_node + 1, sizeof(real));
+        node_slot_weight_sum = (real *) calloc(no_slots_node + 1, sizeof(real));
+
+        if(
+            cell_vol == NULL || plan->contrib_weight == NULL ||
+            node_slot_weight_sum == NULL
+          )
+        {
+            Message("Error (initF2AAggregationPlanOfCellZone()): Memory "
+                    "allocation error on node %i!\n", myid);
+            state = _STATE_ERROR;
+        }
+        else
+        {
+            i = 0;
+            begin_c_loop_int(c, t)
+            {
+                cell_vol[i] = C_VOLUME(c, t);
+                ++i;
+            }
+            end_c_loop_int(c, t)
+
+            for(k = 0; k < no_contribs_node; ++k)
+            {
+                plan->contrib_weight[k] = cell_vol[plan->contrib_cell_idx[k]];
+                node_slot_weight_sum[plan->contrib_slot_idx[k]] +=
+                                                        plan->contrib_weight[k];
+            }
+        }
+        free(cell_vol);
+    }
+}
+
+free(no_slots_node_arr);
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state != _STATE_ERROR && aggregation_mode == F2A_AGG_VOL_WEIGHTED)
+{
+    /* the weights stay real also with FLOAT_TRANSPORT */
+    nodesToHostArrays(
+                        node_slot_weight_sum,
+                        sizeof(real),
+                        plan->no_slots_node,
+                        &slot_weight_sum_full,
+                        &size_slot_weight_sum_full,
+                        NULL
+                     );
+
+    #if RP_HOST
+    plan->elem_weight_sum = (real *) calloc(no_a_elems_zone, sizeof(real));
+
+    if(
+        plan->elem_weight_sum == NULL ||
+        size_slot_weight_sum_full != plan->no_slots_full
+      )
+    {
+        Message("Error (initF2AAggregationPlanOfCellZone()): Element weights "
+                "could not be reduced!\n");
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        for(i = 0; i < plan->no_slots_full; ++i)
+        {
+            plan->elem_weight_sum[plan->slot_elem_idx[i]] +=
+                                        ((real *) slot_weight_sum_full)[i];
+        }
+    }
+    #endif
+    state = reduceStateOverProcesses(state);
+}
+
+free(node_slot_weight_sum);
+free(slot_weight_sum_full);
+
+if(state == _STATE_ERROR)
+{
+    freeF2AAggregationPlan(plan);
+}
+
+return state;
+}
+
+
+int exchangeAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                     )
+{
+/*
+    Gets the node-local cell values of fluid zone fluid_zone_id and writes
+    the aggregated ANSYS element values to f2a_vol_prop_file.
+*/
+int state = _STATE_OK;
+xreal *node_vals = NULL;
+int no_node_vals = 0;
+
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+
+t = Lookup_Thread(domain, fluid_zone_id);
+no_node_vals = THREAD_N_ELEMENTS_INT(t);
+node_vals = (xreal *) calloc(no_node_vals + 1, sizeof(xreal));
+
+if(node_vals == NULL)
+{
+    Message("Error (exchangeAggregatedPropertyF2AZone()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+else
+{
+    nodeGatherCellXValues(node_vals, C_VAL_WRAPPER_FUN, t);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state != _STATE_ERROR)
+{
+    state = exchangeAggregatedNodeValuesF2AZone(
+                                                f2a_vol_prop_file,
+                                                plan,
+                                                node_vals,
+                                                no_node_vals,
+                                                fluid_zone_id
+                                               );
+}
+
+free(node_vals);
+
+return state;
+}
+
+
+int exchangeAggregatedNodeValuesF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        xreal *node_vals,
+                                        int no_node_vals,
+                                        int fluid_zone_id
+                                       )
+{
+/*
+    Aggregates the node-local cell values node_vals (cell loop order) to the
+    element slots of plan on the compute nodes, reduces the slots to an
+    ANSYS element sized array on the host and writes it to f2a_vol_prop_file.
+*/
+int state = _STATE_OK;
+xreal *node_partials = NULL;
+xreal *partials_full = NULL;
+int size_partials_full = 0;
+
+#if RP_HOST
+real *a_elem_vals = NULL;
+#endif
+
+#if RP_NODE
+node_partials = (xreal *) calloc(plan->no_slots_node + 1, sizeof(xreal));
+
+if(node_partials == NULL)
+{
+    Message("Error (exchangeAggregatedNodeValuesF2AZone()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+else
+{
+    aggregateNodeValuesToSlots(plan, node_vals, no_node_vals, node_partials);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state != _STATE_ERROR)
+{
+    state = nodesToHostRealArrays(
+                                    node_partials,
+                                    plan->no_slots_node,
+                                    &partials_full,
+                                    &size_partials_full,
+                                    NULL
+                                 );
+}
+
+#if RP_HOST
+if(state != _STATE_ERROR)
+{
+    a_elem_vals = (real *) calloc(plan->no_a_elems, sizeof(real));
+
+    if(a_elem_vals == NULL || size_partials_full != plan->no_slots_full)
+    {
+        Message("Error (exchangeAggregatedNodeValuesF2AZone()): Aggregation "
+                "of zone id %i failed!\n", fluid_zone_id);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        aggregateSlotsToElements(
+                                    plan->slot_elem_idx,
+                                    partials_full,
+                                    plan->no_slots_full,
+                                    plan->elem_weight_sum,
+                                    a_elem_vals,
+                                    plan->no_a_elems
+                                );
+
+        state = xcWriteField(
+                                plan->xc_format,
+                                f2a_vol_prop_file,
+                                &a_elem_vals,
+                                1,
+                                1,
+                                plan->no_a_elems
+                            );
+
+        if(state == _STATE_ERROR)
+        {
+            Message("Error (exchangeAggregatedNodeValuesF2AZone()): Error in "
+                    "xcWriteField()!\n");
+        }
+        else
+        {
+            Message("Info (exchangeAggregatedNodeValuesF2AZone()): For zone "
+                    "id %i, done!\n", fluid_zone_id);
+
+            #if COUPLING_TRACE
+            traceRecordField(fluid_zone_id, TRACE_VOF_OUT, a_elem_vals, 1,
+                             plan->no_a_elems);
+            #endif
+        }
+    }
+}
+
+free(a_elem_vals);
+#endif /* RP_HOST */
+
+free(node_partials);
+free(partials_full);
+
+return state;
+}
+
+
+void aggregateNodeValuesToSlots(
+                                F2AAggregationPlan *plan,
+                                xreal *node_vals,
+                                int no_node_vals,
+                                xreal *node_partials
+                               )
+{
+/*
+    Adds the weighted node-local cell values node_vals (cell loop order) to
+    the element slots node_partials (plan->no_slots_node values, zeroed by
+    the caller) of the compute node.
+*/
+#if RP_NODE
+int k = 0;
+int cell = 0;
+
+if(plan->contrib_weight != NULL)
+{
+    for(k = 0; k < plan->no_contribs_node; ++k)
+    {
+        cell = plan->contrib_cell_idx[k];
+        if(cell < no_node_vals)
+        {
+            node_partials[plan->contrib_slot_idx[k]] +=
+                                    plan->contrib_weight[k] * node_vals[cell];
+        }
+    }
+}
+else
+{
+    for(k = 0; k < plan->no_contribs_node; ++k)
+    {
+        cell = plan->contrib_cell_idx[k];
+        if(cell < no_node_vals)
+        {
+            node_partials[plan->contrib_slot_idx[k]] += node_vals[cell];
+        }
+    }
+}
+#endif /* RP_NODE */
+}
+
+
+void aggregateSlotsToElements(
+                                int *slot_elem_idx,
+                                xreal *slot_partials,
+                                int no_slots,
+                                real *elem_weight_sum,
+                                real *a_elem_vals,
+                                int no_a_elems
+                             )
+{
+/*
+    Adds the partial sums of all element slots (of all compute nodes) to
+    a_elem_vals (no_a_elems values, zeroed by the caller) and divides by the
+    sum of weights of each element if elem_weight_sum is given.
+*/
+int k = 0;
+
+for(k = 0; k < no_slots; ++k)
+{
+    a_elem_vals[slot_elem_idx[k]] += slot_partials[k];
+}
+
+if(elem_weight_sum != NULL)
+{
+    for(k = 0; k < no_a_elems; ++k)
+    {
+        if(elem_weight_sum[k] > 0)
+        {
+            a_elem_vals[k] /= elem_weight_sum[k];
+        }
+    }
+}
+}
+
+
+void freeF2AAggregationPlan(F2AAggregationPlan *plan)
+{
+    if(plan == NULL)
+    {
+        return;
+    }
+
+    free(plan->no_slots_per_node);
+    free(plan->slot_elem_idx);
+    free(plan->elem_weight_sum);
+    free(plan->contrib_cell_idx);
+    free(plan->contrib_slot_idx);
+    free(plan->contrib_weight);
+
+    plan->no_slots_per_node = NULL;
+    plan->slot_elem_idx = NULL;
+    plan->elem_weight_sum = NULL;
+    plan->contrib_cell_idx = NULL;
+    plan->contrib_slot_idx = NULL;
+    plan->contrib_weight = NULL;
+    plan->no_slots_full = 0;
+    plan->no_slots_node = 0;
+    plan->no_contribs_node = 0;
+}
@@ -0,0 +1,101 @@
+/*
+Node-side aggregation of Fluent cell values to ANSYS element values (F2A), so
+that the host only receives and holds ANSYS element sized arrays.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_F2A_AGGREGATION_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_fluent_get_fields.h"
+#include "vof_pc_exchange_backend.h"
+#include "vof_pc_trace.h"
+#define VOF_PC_F2A_AGGREGATION_H
+
+/*
+Aggregation plan of one coupled zone. Every compute node holds a list of
+contributions (local cell index -> local element slot), the host holds the
+ANSYS element index of every slot of every node:
+
+value_ansys[e] = sum(w_c * value_fluent[c]) / sum(w_c)
+
+for all contributions c of element e, with w_c = 1 (F2A_AGG_PICK) or
+w_c = C_VOLUME(c,t) (F2A_AGG_VOL_WEIGHTED). The weights are static on fixed
+meshes, so sum(w_c) is reduced once during init and only the weighted partial
+sums are sent each step.
+*/
+typedef struct f2a_aggregation_plan_struct
+{
+    int aggregation_mode;
+    int no_a_elems;
+    int xc_format; /* of the written F2A file, see vof_pc_exchange_backend.h */
+
+    /* host */
+    int *no_slots_per_node;
+    int *slot_elem_idx;
+    int no_slots_full;
+    real *elem_weight_sum;
+
+    /* compute nodes */
+    int no_slots_node;
+    int no_contribs_node;
+    int *contrib_cell_idx;
+    int *contrib_slot_idx;
+    real *contrib_weight;
+} F2AAggregationPlan;
+
+
+int initF2AAggregationPlanOfCellZone(
+                                        F2AAggregationPlan *plan,
+                                        int aggregation_mode,
+                                        int *a2f_mapping_zone,
+                                        int *f2a_mapping_zone,
+                                        int *f_ordered_myids_zone,
+                                        int *f_cells_per_node,
+                                        int no_f_cells_zone,
+                                        int no_a_elems_zone,
+                                        int fluid_zone_id
+                                    );
+
+int exchangeAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                     );
+
+int exchangeAggregatedNodeValuesF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        xreal *node_vals,
+                                        int no_node_vals,
+                                        int fluid_zone_id
+                                       );
+
+void aggregateNodeValuesToSlots(
+                                F2AAggregationPlan *plan,
+                                xreal *node_vals,
+                                int no_node_vals,
+                                xreal *node_partials
+                               );
+
+void aggregateSlotsToElements(
+                                int *slot_elem_idx,
+                                xreal *slot_partials,
+                                int no_slots,
+                                real *elem_weight_sum,
+                                real *a_elem_vals,
+                                int no_a_elems
+                             );
+
+void freeF2AAggregationPlan(F2AAggregationPlan *plan);
+
+#endif
@@ -1,5 +1,6 @@
 /*
 Utility functions for handling of sync.txt file in the exchange (XC) folder
+and for publishing the exchange files by rename
 
 License (MIT):
 
@@ -13,6 +14,12 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 
 #include "vof_pc_file_sync.h"
+#include "vof_pc_threads.h"
+
+#if !LINUX
+#include "windows.h"
+#include "io.h"
+#endif
 
 
 DEFINE_ON_DEMAND(debug_sleep)
@@ -113,19 +120,43 @@ int sync_coupling_state_to_file(char filename[], int coupling_state)
     */
     FILE* fp = NULL;
     int state = _STATE_OK;
+    char part_file[XC_PART_FILENAME_SIZE];
+
+    exchangePartFileName(part_file, filename);
 
-    if ((fp = fopen(filename, "w")) == NULL) 
+    if ((fp = fopen(part_file, "w")) == NULL) 
     {
         Message("\n Warning (sync_coupling_state_to_file()): Unable to open sync "
-                "file %s for writing!\n", filename);
+                "file %s for writing!\n", part_file);
         state = _STATE_ERROR;
     }
     else 
     {
-        Message("\nInfo (sync_coupling_state_to_file()): Coupling state written "
-                "to sync file %s...\n", filename);
-        fprintf(fp, "%i", coupling_state);
-        fclose(fp);
+        if(fprintf(fp, "%i", coupling_state) < 0 || flushExchangeFile(fp) != _STATE_OK)
+        {
+            state = _STATE_ERROR;
+        }
+        if(fclose(fp) != 0)
+        {
+            state = _STATE_ERROR;
+        }
+
+        state = publishExchangeFile(part_file, filename, state);
+
+        if(state != _STATE_ERROR)
+        {
+            #if RP_HOST && XC_RECORDING
+            xcRecordSyncState(filename, XC_RECORD_FLUENT, coupling_state);
+            #endif
+
+            Message("\nInfo (sync_coupling_state_to_file()): Coupling state "
+                    "written to sync file %s...\n", filename);
+        }
+        else
+        {
+            Message("\n Warning (sync_coupling_state_to_file()): Unable to "
+                    "write sync file %s!\n", filename);
+        }
     }
 
     return state;
@@ -176,6 +207,12 @@ int sync_wait_for_state(char filename[], int desired_state, int *actual_state)
         }
         else 
         {
+            /*
+                also once the desired state is read: ANSYS writes its result
+                files and the sync file in place (see apdl_example.ans), the
+                margin lets them settle in the XC folder. XC_ATOMIC_PUBLISH
+                only covers the files written by Fluent.
+            */
             #if LINUX
             sleep((unsigned int) ceil(COUPLING_SLEEP_TIME_IN_S));
             #else
@@ -190,6 +227,13 @@ int sync_wait_for_state(char filename[], int desired_state, int *actual_state)
             ++i;
         }
     }
+    #if RP_HOST && XC_RECORDING
+    if(state == _STATE_OK)
+    {
+        xcRecordSyncState(filename, XC_RECORD_ANSYS, coupling_state);
+    }
+    #endif
+
     (*actual_state) = coupling_state;
     return state;
 }
@@ -235,3 +279,87 @@ int sync_wait_for_coupling(char filename[])
     }
  return state;
 }
+
+
+void exchangePartFileName(char part_file[], char filename[])
+{
+    /*
+        Name under which filename is written before it is published, 
+        part_file needs XC_PART_FILENAME_SIZE chars.
+    */
+    #if XC_ATOMIC_PUBLISH
+    sprintf(part_file, "%.250s%s", filename, XC_PART_FILE_SUFFIX);
+    #else
+    sprintf(part_file, "%.*s", XC_PART_FILENAME_SIZE - 1, filename);
+    #endif
+}
+
+
+int flushExchangeFile(FILE *fp)
+{
+    /*
+        Writes the buffered data of fp and with XC_PUBLISH_FSYNC waits until
+        it is on disk, the file still has to be closed.
+    */
+    if(fflush(fp) != 0)
+    {
+        return _STATE_ERROR;
+    }
+
+    #if XC_PUBLISH_FSYNC
+    #if LINUX
+    if(fsync(fileno(fp)) != 0)
+    #else
+    if(_commit(_fileno(fp)) != 0)
+    #endif
+    {
+        return _STATE_ERROR;
+    }
+    #endif
+
+    return _STATE_OK;
+}
+
+
+int renameExchangeFile(char part_file[], char filename[], int state)
+{
+    /*
+        Replaces filename by the closed part_file in one step if it was
+        written without error (state), removes it otherwise. Readers of
+        filename see either the old or the complete new file, both are in the
+        same folder so the rename is atomic.
+    */
+    if(state == _STATE_ERROR)
+    {
+        remove(part_file);
+        return state;
+    }
+
+    #if LINUX
+    if(rename(part_file, filename) != 0)
+    #else
+    if(!MoveFileExA(part_file, filename, MOVEFILE_REPLACE_EXISTING))
+    #endif
+    {
+        threadMessage("Error (renameExchangeFile()): Unable to rename %s to %s!\n",
+                part_file, filename);
+        remove(part_file);
+        state = _STATE_ERROR;
+    }
+
+    return state;
+}
+
+
+int publishExchangeFile(char part_file[], char filename[], int state)
+{
+    /*
+        With XC_ATOMIC_PUBLISH renames the closed part_file (see
+        exchangePartFileName()) to filename, see renameExchangeFile().
+    */
+    #if XC_ATOMIC_PUBLISH
+    state = renameExchangeFile(part_file, filename, state);
+    #endif
+
+    return state;
+}
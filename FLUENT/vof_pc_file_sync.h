@@ -15,6 +15,11 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #ifndef VOF_PC_FILE_SYNC_H
 #define VOF_PC_FILE_SYNC_H
 #include "vof_pc_main.h"
+#include "vof_pc_xc_record.h"
+
+/* exchange files are written under this suffix and renamed when complete */
+#define XC_PART_FILE_SUFFIX ".part"
+#define XC_PART_FILENAME_SIZE 300
 
 int sync_coupling_state_from_file(char filename[], int *coupling_state);
 
@@ -26,5 +31,13 @@ int sync_wait_for_coupling(char filename[]);
 
 void sleeptest();
 
+void exchangePartFileName(char part_file[], char filename[]);
+
+int flushExchangeFile(FILE *fp);
+
+int renameExchangeFile(char part_file[], char filename[], int state);
+
+int publishExchangeFile(char part_file[], char filename[], int state);
+
 
 #endif
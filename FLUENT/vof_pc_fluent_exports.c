@@ -13,15 +13,57 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 #include "vof_pc_fluent_exports.h" 
 
-DEFINE_ON_DEMAND(Debug_Export_Fluent_Fields)
+#if RP_HOST && DEBUG_BACKGROUND_WRITER
+/* gathered fields owned by the background writer thread */
+typedef struct debug_field_job_struct
 {
-    int i = 0;
-    char filename[] = _FLUENT_ALLOUT_DAT_;
+    char *filename;
     real (*coord_arr_full)[ND_ND];
     real *vof_arr_full;
     int *cell_id_arr_full;
     int *compute_node_id_arr_full;
+    int arr_full_size;
+} DebugFieldJob;
+
+
+static int writeDebugFieldJob(void *arg)
+{
+    DebugFieldJob *job = (DebugFieldJob *) arg;
+    int state;
+
+    state = hostWriteDebugField(
+                                    job->filename,
+                                    job->coord_arr_full,
+                                    job->vof_arr_full,
+                                    job->cell_id_arr_full,
+                                    job->compute_node_id_arr_full,
+                                    job->arr_full_size
+                                );
+
+    free(job->coord_arr_full);
+    free(job->vof_arr_full);
+    free(job->cell_id_arr_full);
+    free(job->compute_node_id_arr_full);
+    free(job);
+
+    return state;
+}
+#endif
+
+
+DEFINE_ON_DEMAND(Debug_Export_Fluent_Fields)
+{
+    int i = 0;
+    /* a literal, the background writer may still use it after returning */
+    char *filename = _FLUENT_ALLOUT_DAT_;
+    real (*coord_arr_full)[ND_ND] = NULL;
+    real *vof_arr_full = NULL;
+    int *cell_id_arr_full = NULL;
+    int *compute_node_id_arr_full = NULL;
     int arr_full_size = -1;
+    #if RP_HOST && DEBUG_BACKGROUND_WRITER
+    DebugFieldJob *job = NULL;
+    #endif
 
     hostGetCouplingFieldsFromNodesinCellZone(
                                                 &coord_arr_full,
@@ -31,6 +73,26 @@ DEFINE_ON_DEMAND(Debug_Export_Fluent_Fields)
                                                 &arr_full_size,
                                                 FLUID_ID
                                               );
+
+    #if RP_HOST && DEBUG_BACKGROUND_WRITER
+    /* hand the arrays over to the background writer thread */
+    job = (DebugFieldJob *) malloc(sizeof(DebugFieldJob));
+
+    if(job != NULL)
+    {
+        job->filename = filename;
+        job->coord_arr_full = coord_arr_full;
+        job->vof_arr_full = vof_arr_full;
+        job->cell_id_arr_full = cell_id_arr_full;
+        job->compute_node_id_arr_full = compute_node_id_arr_full;
+        job->arr_full_size = arr_full_size;
+
+        submitBackgroundWrite(writeDebugFieldJob, job);
+
+        Message("Export submitted to the background writer!\n");
+        return;
+    }
+    #endif
     
     hostWriteDebugField (
                             filename,
@@ -41,6 +103,11 @@ DEFINE_ON_DEMAND(Debug_Export_Fluent_Fields)
                             arr_full_size
                         );
     #if RP_HOST
+        free(coord_arr_full);
+        free(vof_arr_full);
+        free(cell_id_arr_full);
+        free(compute_node_id_arr_full);
+
         Message("Export Done!\n");
     #endif
 }
@@ -59,16 +126,20 @@ int hostWriteDebugField(
     Write a file with the follwing columns:
 
     cell_id compute_node_id volfrac x-coord y-coord (z-coord only if 3D)
+
+    The arrays stay owned by the caller, this may run on the background
+    writer thread.
 */
 int state = _STATE_OK;
 
 #if RP_HOST
-FILE *fp = NULL;
+TextWriter writer;
 int i = 0;
+int k = 0;
 
-if ((fp = fopen(filename, "w")) == NULL)
+if (openTextWriter(&writer, filename) != _STATE_OK)
 {
-    Message("Error (hostWriteDebugField()): Unable to open %s for writing!\n"
+    threadMessage("Error (hostWriteDebugField()): Unable to open %s for writing!\n"
                 , filename);
     state = _STATE_ERROR;
 }
@@ -81,53 +152,38 @@ else
         if ( vof_arr_full == NULL || cell_id_arr_full == NULL 
             || coord_arr_full == NULL || compute_node_id_arr_full == NULL)
         {
-            Message("Error (hostWriteDebugField()): Can not export empty arrays!\n"
+            threadMessage("Error (hostWriteDebugField()): Can not export empty arrays!\n"
                         , filename);
             state = _STATE_ERROR;
         }
         else
         {
-            #if RP_3D
             for (i = 0; i < arr_full_size; ++i)
             {
-                if(IS_SINGLE_PRECISION)
-                    fprintf(fp, "%i %i %f %f %f %f\n", cell_id_arr_full[i],
-                             compute_node_id_arr_full[i], vof_arr_full[i], 
-                             coord_arr_full[i][0], coord_arr_full[i][1], 
-                             coord_arr_full[i][2]);
-                else
-                    fprintf(fp, "%i %i %lf %lf %lf %lf\n", cell_id_arr_full[i], 
-                            compute_node_id_arr_full[i], vof_arr_full[i], 
-                            coord_arr_full[i][0], coord_arr_full[i][1], 
-                            coord_arr_full[i][2]);
-
+                writeTextInt(&writer, cell_id_arr_full[i], 0);
+                writeTextChar(&writer, ' ');
+                writeTextInt(&writer, compute_node_id_arr_full[i], 0);
+                writeTextChar(&writer, ' ');
+                writeTextFixed(&writer, vof_arr_full[i], 0, 6);
+
+                for (k = 0; k < ND_ND; ++k)
+                {
+                    writeTextChar(&writer, ' ');
+                    writeTextFixed(&writer, coord_arr_full[i][k], 0, 6);
+                }
+                writeTextChar(&writer, '\n');
             }
-            #else
-            for (i = 0; i < arr_full_size; ++i)
-            {
-                if(IS_SINGLE_PRECISION)
-                    fprintf(fp, "%i %i %f %f %f\n", cell_id_arr_full[i], 
-                             compute_node_id_arr_full[i], vof_arr_full[i], 
-                             coord_arr_full[i][0], coord_arr_full[i][1]);
-                else
-                    fprintf(fp, "%i %i %lf %lf %lf\n", cell_id_arr_full[i], 
-                             compute_node_id_arr_full[i],vof_arr_full[i], 
-                             coord_arr_full[i][0], coord_arr_full[i][1]);
-            }
-            #endif /* RP_3D */
-
-            free(coord_arr_full);
-            free(vof_arr_full);
-            free(cell_id_arr_full);
-            free(compute_node_id_arr_full);
         }
     }
     else
     {
-        Message("Warning (hostWriteDebugField()): Array sizes are zero!\n");
+        threadMessage("Warning (hostWriteDebugField()): Array sizes are zero!\n");
+        state = _STATE_ERROR;
+    }
+    if(closeTextWriter(&writer) != _STATE_OK)
+    {
         state = _STATE_ERROR;
     }
-    fclose(fp);
 }
 #endif
 
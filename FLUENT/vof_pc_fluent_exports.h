@@ -15,6 +15,8 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #ifndef VOF_PC_FLUENT_EXPORTS_H
 #include "vof_pc_main.h"
 #include "vof_pc_fluent_get_fields.h" 
+#include "vof_pc_text_writer.h"
+#include "vof_pc_threads.h"
 
 int hostWriteDebugField( 
                           char filename[],
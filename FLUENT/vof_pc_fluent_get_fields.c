@@ -157,7 +157,188 @@ real get_y_coord(cell_t c,Thread *t)
 
 real get_z_coord(cell_t c,Thread *t)
 {
+#if RP_3D
   return get_coord(c,t,2);
+#else
+  return 0.0;
+#endif
+}
+
+
+#if !RP_HOST
+/*
+  Cell values staged for the gathers of one step (see stageCellValues())
+*/
+typedef struct staged_cell_values_struct
+{
+  Thread *t;
+  real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*);
+  real *vals;
+} StagedCellValues;
+
+static StagedCellValues *_g_staged = NULL;
+static int _g_no_staged = 0;
+
+
+real *stagedCellValues(
+                        Thread *t,
+                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*)
+                       )
+{
+  int k;
+
+  for(k = 0; k < _g_no_staged; ++k)
+  {
+    if(_g_staged[k].t == t && _g_staged[k].C_VAL_WRAPPER_FUN == C_VAL_WRAPPER_FUN)
+    {
+      return _g_staged[k].vals;
+    }
+  }
+
+  return NULL;
+}
+
+
+/*
+  Cell loop over the node-local cells of t, VALUE_STMT sets vals[i] of cell c
+*/
+#define GATHER_CELL_LOOP(c, t, i, VALUE_STMT) \
+  i = 0; \
+  begin_c_loop_int(c, t) \
+  { \
+    VALUE_STMT; \
+    ++i; \
+  } \
+  end_c_loop_int(c, t)
+
+/*
+  Block copy of component k of the no_cells cells of stride reals in src,
+  used if the cell storage of a thread is contiguous
+*/
+#define COPY_CELL_STORAGE(vals, TYPE, src, SRC_TYPE, no_cells, stride, k, i) \
+  if((stride) == 1 && sizeof(TYPE) == sizeof(SRC_TYPE)) \
+  { \
+    memcpy(vals, src, (no_cells) * sizeof(TYPE)); \
+  } \
+  else \
+  { \
+    for(i = 0; i < (no_cells); ++i) \
+    { \
+      vals[i] = (TYPE) (src)[i * (stride) + (k)]; \
+    } \
+  }
+
+/*
+  Gather of C_VAL_WRAPPER_FUN into vals of type TYPE. For get_c_vof the
+  phase thread is looked up once, for the coordinate getters the centroid
+  component is taken directly (z only in 3D), so that these loops have no
+  call per cell. With CELL_STORAGE_BULK_COPY contiguous storage of these
+  fields is copied as one block. Staged values are copied in any case.
+*/
+#define DEFINE_NODE_CELL_GATHER(NAME, TYPE) \
+void NAME( \
+          TYPE *vals, \
+          real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*), \
+          Thread *t \
+         ) \
+{ \
+  cell_t c; \
+  int i; \
+  int dim = -1; \
+  int n = THREAD_N_ELEMENTS_INT(t); \
+  real xc[ND_ND]; \
+  real *src; \
+  real *staged = stagedCellValues(t, C_VAL_WRAPPER_FUN); \
+  Thread *pt_phase; \
+  \
+  if(staged != NULL) \
+  { \
+    COPY_CELL_STORAGE(vals, TYPE, staged, real, n, 1, 0, i); \
+    return; \
+  } \
+  \
+  if(C_VAL_WRAPPER_FUN == get_c_vof) \
+  { \
+    pt_phase = THREAD_SUB_THREADS(t)[COUPLING_PHASE_FRAC_IDX]; \
+    src = (real *) THREAD_STORAGE(pt_phase, SV_VOF); \
+    \
+    if( \
+        CELL_STORAGE_BULK_COPY && src != NULL && n > 0 && \
+        &C_VOF(0, pt_phase) == src && &C_VOF(n - 1, pt_phase) == src + n - 1 \
+      ) \
+    { \
+      COPY_CELL_STORAGE(vals, TYPE, src, real, n, 1, 0, i); \
+      return; \
+    } \
+    \
+    GATHER_CELL_LOOP(c, t, i, vals[i] = (TYPE) C_VOF(c, pt_phase)); \
+    return; \
+  } \
+  \
+  if(C_VAL_WRAPPER_FUN == get_x_coord) dim = 0; \
+  if(C_VAL_WRAPPER_FUN == get_y_coord) dim = 1; \
+  if(RP_3D && C_VAL_WRAPPER_FUN == get_z_coord) dim = ND_ND - 1; \
+  \
+  src = (real *) THREAD_STORAGE(t, SV_CENTROID); \
+  \
+  if( \
+      CELL_STORAGE_BULK_COPY && dim >= 0 && src != NULL && n > 0 && \
+      C_STORAGE_R_NV(0, t, SV_CENTROID) == src && \
+      C_STORAGE_R_NV(n - 1, t, SV_CENTROID) == src + (n - 1) * ND_ND \
+    ) \
+  { \
+    COPY_CELL_STORAGE(vals, TYPE, src, real, n, ND_ND, dim, i); \
+  } \
+  else if(dim >= 0) \
+  { \
+    GATHER_CELL_LOOP(c, t, i, \
+                     C_CENTROID(xc, c, t); vals[i] = (TYPE) xc[dim]); \
+  } \
+  else \
+  { \
+    GATHER_CELL_LOOP(c, t, i, vals[i] = (TYPE) (*C_VAL_WRAPPER_FUN)(c, t)); \
+  } \
+}
+
+DEFINE_NODE_CELL_GATHER(nodeGatherCellValues, real)
+DEFINE_NODE_CELL_GATHER(nodeGatherCellXValues, xreal)
+#endif /* !RP_HOST */
+
+
+void stageCellValues(
+                      Thread *t,
+                      real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                      real *vals
+                    )
+{
+#if !RP_HOST
+  StagedCellValues *staged;
+
+  staged = (StagedCellValues *) realloc(_g_staged,
+                                        (_g_no_staged + 1) * sizeof(StagedCellValues));
+
+  /* without staging the gathers simply read the cells again */
+  if(staged == NULL)
+  {
+    return;
+  }
+
+  _g_staged = staged;
+  _g_staged[_g_no_staged].t = t;
+  _g_staged[_g_no_staged].C_VAL_WRAPPER_FUN = C_VAL_WRAPPER_FUN;
+  _g_staged[_g_no_staged].vals = vals;
+  ++_g_no_staged;
+#endif
+}
+
+
+void clearStagedCellValues()
+{
+#if !RP_HOST
+  free(_g_staged);
+  _g_staged = NULL;
+  _g_no_staged = 0;
+#endif
 }
 
 
@@ -185,12 +366,14 @@ void hostGetCellCoordsFromNodesInCellZone(
                                                   &arr_control_size,
                                                   cell_zone
                                                 );
+#if RP_3D
   hostGetOrderedFieldValueArrayFromNodesInCellZone(
                                                   &z_arr_full,
                                                   get_z_coord,
                                                   &arr_control_size,
                                                   cell_zone
                                                   );                  
+#endif
 
   #if RP_HOST
   if( arr_control_size == length_arrs_full)
@@ -203,7 +386,9 @@ void hostGetCellCoordsFromNodesInCellZone(
       {
         (*coord_arr_full)[i][0] = x_arr_full[i];
         (*coord_arr_full)[i][1] = y_arr_full[i];
+#if RP_3D
         (*coord_arr_full)[i][2] = z_arr_full[i];
+#endif
       }
     }
     else
@@ -428,7 +613,7 @@ int i = 0;
 int size = 0; 
 int pe;
 
-real *val_arr_node = NULL;
+xreal *val_arr_node = NULL; /* the values are sent as xreal */
 
 *val_arr_full = NULL;
 
@@ -438,11 +623,8 @@ Message("Receiving FLUENT cell field for coupling operations...\n");
 #endif
 
 #if !RP_HOST 
-cell_t c;
 Thread *t;
 Domain *domain = Get_Domain(1);
-Thread **pt;
-real xc[ND_ND];
 
 t = Lookup_Thread(domain, cell_zone);
 
@@ -450,15 +632,9 @@ t = Lookup_Thread(domain, cell_zone);
 #if RP_NODE /* in !RP_HOST*/
 /* Each Node loads up its data passing array */
 size = THREAD_N_ELEMENTS_INT(t);
-val_arr_node = (real *) calloc(size, sizeof(real));
+val_arr_node = (xreal *) calloc(size, sizeof(xreal));
 
-i = 0;
-begin_c_loop_int(c, t) 
-{
-  val_arr_node[i] = (*C_VAL_WRAPPER_FUN)(c,t);
-  ++i;
-}
-end_c_loop_int(c, t)
+nodeGatherCellXValues(val_arr_node, C_VAL_WRAPPER_FUN, t);
 
 /* Set pe to destination node */
 /* If on node_0 send data to host */
@@ -478,7 +654,7 @@ if (I_AM_NODE_ZERO_P)
 pe = (I_AM_NODE_ZERO_P) ? node_host : node_zero;
 /*Sent data from nodes to node0 or from node0 to host*/
 PRF_CSEND_INT(pe, &size, 1, myid);
-PRF_CSEND_REAL(pe, val_arr_node, size, myid);
+PRF_CSEND_XREAL(pe, val_arr_node, size, myid);
 
 /* free array on nodes once data sent */
 free(val_arr_node);
@@ -491,14 +667,14 @@ if (I_AM_NODE_ZERO_P)
  compute_node_loop_not_zero (pe) 
  {
    PRF_CRECV_INT(pe, &size, 1, pe);
-   val_arr_node = (real *) calloc(size, sizeof(real));
+   val_arr_node = (xreal *) calloc(size, sizeof(xreal));
 
    /* Receive data */
-   PRF_CRECV_REAL(pe, val_arr_node, size, pe);
+   PRF_CRECV_XREAL(pe, val_arr_node, size, pe);
 
    /* send data */
    PRF_CSEND_INT(node_host, &size, 1, myid);
-   PRF_CSEND_REAL(node_host, val_arr_node, size, myid);
+   PRF_CSEND_XREAL(node_host, val_arr_node, size, myid);
 
    free((char *)val_arr_node);
  }
@@ -525,10 +701,10 @@ if(sum_size_full > 0)
    compute_node_loop (pe) 
    { 
      PRF_CRECV_INT(node_zero, &size, 1, node_zero);
-     val_arr_node = (real *) calloc(size, sizeof(real));
+     val_arr_node = (xreal *) calloc(size, sizeof(xreal));
 
      /* Receive data */
-     PRF_CRECV_REAL(node_zero, val_arr_node, size, node_zero);
+     PRF_CRECV_XREAL(node_zero, val_arr_node, size, node_zero);
 
      sum_size_nodes += size;
 
@@ -547,7 +723,7 @@ if(sum_size_full > 0)
          }
          else
          {
-           (*val_arr_full)[i] = val_arr_node[i - (sum_size_nodes-size)];
+           (*val_arr_full)[i] = (real) val_arr_node[i - (sum_size_nodes-size)];
          }
        }
      }
@@ -28,6 +28,41 @@ real get_x_coord(cell_t c,Thread *t);
 real get_y_coord(cell_t c,Thread *t);
 real get_z_coord(cell_t c,Thread *t);
 
+/*
+Node-local cell values of t in cell loop order. The getters above are
+gathered by specialized loops, other getters by a call per cell.
+*/
+void nodeGatherCellValues(
+                          real *vals,
+                          real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                          Thread *t
+                         );
+
+void nodeGatherCellXValues(
+                            xreal *vals,
+                            real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                            Thread *t
+                          );
+
+/*
+Values of C_VAL_WRAPPER_FUN of all node-local cells of t, which have already
+been read in the current step, are taken by the gathers above instead of the
+cells until clearStagedCellValues(). vals is not copied, it stays real, so
+only the gathers into xreal round it (FLOAT_TRANSPORT).
+*/
+void stageCellValues(
+                      Thread *t,
+                      real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                      real *vals
+                    );
+
+real *stagedCellValues(
+                        Thread *t,
+                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*)
+                       );
+
+void clearStagedCellValues();
+
 void hostGetCellCoordsFromNodesInCellZone(
                                           real (**coord_arr_full)[ND_ND],
                                           int length_arrs_full,
@@ -0,0 +1,791 @@
+/*
+Streaming exchange of coupling values through the host in chunks of ANSYS
+elements, so the host never holds zone sized value arrays (see
+HOST_STREAMING_EXCHANGE in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_host_streaming.h"
+
+#if RP_HOST
+static int compareInt(const void *a, const void *b)
+{
+    int ia = *((const int *) a);
+    int ib = *((const int *) b);
+
+    return (ia > ib) - (ia < ib);
+}
+
+
+typedef struct f2a_stream_writer_struct
+{
+    FILE *fp;
+    F2AAggregationPlan *plan;
+    int *node_slot_start;
+    int next_elem;
+    int state;
+} F2AStreamWriter;
+
+
+static void writeF2AStreamChunk(
+                                void *chunk_ctx,
+                                int pe,
+                                int offset,
+                                xreal *vals,
+                                int count
+                               )
+{
+/*
+    Writes the slot values of a chunk of compute node pe as fixed width
+    records at the position of their ANSYS element.
+*/
+    F2AStreamWriter *writer = (F2AStreamWriter *) chunk_ctx;
+    char rec[TEXT_WRITER_MAX_FIELD];
+    double val;
+    int slot, e, k, len;
+
+    if(writer->state == _STATE_ERROR)
+    {
+        return;
+    }
+
+    if(offset + count > writer->plan->no_slots_per_node[pe])
+    {
+        Message("Error (writeF2AStreamChunk()): Node %i sent more values than "
+                "slots!\n", pe);
+        writer->state = _STATE_ERROR;
+        return;
+    }
+
+    for(k = 0; k < count; ++k)
+    {
+        slot = writer->node_slot_start[pe] + offset + k;
+        e = writer->plan->slot_elem_idx[slot];
+
+        if(e != writer->next_elem)
+        {
+            fseek(writer->fp, (long) e * F2A_STREAM_RECORD_LEN, SEEK_SET);
+        }
+
+        val = (double) vals[k];
+        val = (val < 0.0) ? 0.0 : ((val > 1.0) ? 1.0 : val);
+
+        len = formatFixed(rec, val, 8, 6);
+        rec[len++] = '\n';
+
+        if(
+            len != F2A_STREAM_RECORD_LEN ||
+            fwrite(rec, 1, len, writer->fp) != (size_t) len
+          )
+        {
+            Message("Error (writeF2AStreamChunk()): Writing element %i "
+                    "failed!\n", e);
+            writer->state = _STATE_ERROR;
+            return;
+        }
+
+        writer->next_elem = e + 1;
+    }
+}
+#endif /* RP_HOST */
+
+
+int initA2FStreamPlanOfCellZone(
+                                A2FStreamPlan *plan,
+                                int *f2a_mapping_zone,
+                                int *f_cells_per_node,
+                                int no_f_cells_zone,
+                                int no_a_elems_zone,
+                                int fluid_zone_id
+                               )
+{
+/*
+    Builds the sorted element list of every compute node from the f2a
+    mapping on the host and sends each node its element list and the
+    element list index of each of its cells once.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int *cell_slot = NULL;
+int *ones_per_node = NULL;
+int *no_elems_node_arr = NULL;
+int count = 0;
+#if RP_HOST
+int pe;
+int i, j, e;
+int i_start = 0;
+int offset = 0;
+int no_elems_full = 0;
+int *elem_stamp = NULL;
+int *elem_local = NULL;
+#endif
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+int k;
+#endif
+
+plan->no_a_elems = no_a_elems_zone;
+plan->no_elems_per_node = NULL;
+plan->node_elem_idx = NULL;
+plan->no_elems_node = 0;
+plan->no_cells_node = 0;
+plan->cell_elem_slot = NULL;
+
+#if RP_HOST
+plan->no_elems_per_node = (int *) calloc(compute_node_count, sizeof(int));
+ones_per_node = (int *) calloc(compute_node_count, sizeof(int));
+elem_stamp = (int *) calloc(no_a_elems_zone + 1, sizeof(int));
+elem_local = (int *) calloc(no_a_elems_zone + 1, sizeof(int));
+cell_slot = (int *) calloc(no_f_cells_zone + 1, sizeof(int));
+
+if(
+    plan->no_elems_per_node == NULL || ones_per_node == NULL ||
+    elem_stamp == NULL || elem_local == NULL || cell_slot == NULL ||
+    f2a_mapping_zone == NULL || f_cells_per_node == NULL
+  )
+{
+    Message("Error (initA2FStreamPlanOfCellZone()): Memory allocation error "
+            "or missing mappings for zone id %i!\n", fluid_zone_id);
+    state = _STATE_ERROR;
+}
+else
+{
+    /* count the distinct elements of each node */
+    for(e = 0; e < no_a_elems_zone; ++e)
+    {
+        elem_stamp[e] = -1;
+    }
+
+    compute_node_loop (pe)
+    {
+        ones_per_node[pe] = 1;
+
+        if(i_start + f_cells_per_node[pe] > no_f_cells_zone)
+        {
+            Message("Error (initA2FStreamPlanOfCellZone()): Index out of "
+                    "bounds!\n");
+            state = _STATE_ERROR;
+            break;
+        }
+
+        for(i = i_start; i < i_start + f_cells_per_node[pe]; ++i)
+        {
+            e = f2a_mapping_zone[i];
+
+            if(e < 0 || e >= no_a_elems_zone)
+            {
+                Message("Error (initA2FStreamPlanOfCellZone()): Mapping index "
+                        "out of bounds!\n");
+                state = _STATE_ERROR;
+                break;
+            }
+            if(elem_stamp[e] != pe)
+            {
+                elem_stamp[e] = pe;
+                ++plan->no_elems_per_node[pe];
+            }
+        }
+
+        if(state == _STATE_ERROR)
+        {
+            break;
+        }
+
+        no_elems_full += plan->no_elems_per_node[pe];
+        i_start += f_cells_per_node[pe];
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    plan->node_elem_idx = (int *) calloc(no_elems_full + 1, sizeof(int));
+
+    if(plan->node_elem_idx == NULL)
+    {
+        Message("Error (initA2FStreamPlanOfCellZone()): Memory allocation "
+                "error!\n");
+        state = _STATE_ERROR;
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    for(e = 0; e < no_a_elems_zone; ++e)
+    {
+        elem_stamp[e] = -1;
+    }
+
+    i_start = 0;
+    compute_node_loop (pe)
+    {
+        j = offset;
+        for(i = i_start; i < i_start + f_cells_per_node[pe]; ++i)
+        {
+            e = f2a_mapping_zone[i];
+            if(elem_stamp[e] != pe)
+            {
+                elem_stamp[e] = pe;
+                plan->node_elem_idx[j] = e;
+                ++j;
+            }
+        }
+
+        qsort(plan->node_elem_idx + offset, plan->no_elems_per_node[pe],
+              sizeof(int), compareInt);
+
+        for(j = 0; j < plan->no_elems_per_node[pe]; ++j)
+        {
+            elem_local[plan->node_elem_idx[offset + j]] = j;
+        }
+
+        for(i = i_start; i < i_start + f_cells_per_node[pe]; ++i)
+        {
+            cell_slot[i] = elem_local[f2a_mapping_zone[i]];
+        }
+
+        offset += plan->no_elems_per_node[pe];
+        i_start += f_cells_per_node[pe];
+    }
+
+    Message("Info (initA2FStreamPlanOfCellZone()): %i node element entries "
+            "for %i ANSYS elements in zone id %i.\n", no_elems_full,
+            no_a_elems_zone, fluid_zone_id);
+}
+
+free(elem_stamp);
+free(elem_local);
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    /* all three transfers run on every process, so a node which fails to 
+    allocate one array still receives the others, the state is reduced 
+    below */
+    if(hostToNodesIntArrays(plan->no_elems_per_node, ones_per_node,
+                            &no_elems_node_arr, &count) == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+
+    #if RP_HOST
+    if(hostToNodesIntArrays(plan->node_elem_idx, plan->no_elems_per_node,
+                            NULL, NULL) == _STATE_ERROR)
+    #else
+    if(hostToNodesIntArrays(NULL, NULL, &plan->node_elem_idx,
+                            &plan->no_elems_node) == _STATE_ERROR)
+    #endif
+    {
+        state = _STATE_ERROR;
+    }
+
+    if(hostToNodesIntArrays(cell_slot, f_cells_per_node,
+                            &plan->cell_elem_slot,
+                            &plan->no_cells_node) == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+#if RP_NODE
+if(state != _STATE_ERROR)
+{
+    t = Lookup_Thread(domain, fluid_zone_id);
+
+    if(
+        count != 1 || plan->no_elems_node != no_elems_node_arr[0] ||
+        plan->no_cells_node != THREAD_N_ELEMENTS_INT(t)
+      )
+    {
+        Message("Error (initA2FStreamPlanOfCellZone()): Missmatch of cell "
+                "count on node %i!\n", myid);
+        state = _STATE_ERROR;
+    }
+
+    for(k = 0; k < plan->no_cells_node && state != _STATE_ERROR; ++k)
+    {
+        if(
+            plan->cell_elem_slot[k] < 0 ||
+            plan->cell_elem_slot[k] >= plan->no_elems_node
+          )
+        {
+            Message("Error (initA2FStreamPlanOfCellZone()): Element index out "
+                    "of bounds on node %i!\n", myid);
+            state = _STATE_ERROR;
+        }
+    }
+
+    for(k = 0; k < plan->no_elems_node && state != _STATE_ERROR; ++k)
+    {
+        if(
+            plan->node_elem_idx[k] < 0 || 
+            plan->node_elem_idx[k] >= plan->no_a_elems
+          )
+        {
+            Message("Error (initA2FStreamPlanOfCellZone()): Element index out "
+                    "of bounds on node %i!\n", myid);
+            state = _STATE_ERROR;
+        }
+    }
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+free(no_elems_node_arr);
+#if RP_HOST
+free(cell_slot);
+free(ones_per_node);
+#endif
+
+if(state == _STATE_ERROR)
+{
+    freeA2FStreamPlan(plan);
+}
+
+return state;
+}
+
+
+int exchangeStreamedPropertiesA2FZone(
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                     )
+{
+/*
+    Reads the volumetric property (value and volume per element) and, if
+    no_fields == 1 + ND_ND, the vector property of a zone in chunks of
+    HOST_STREAMING_CHUNK_SIZE elements and forwards the values of each chunk
+    to the nodes referencing them. The nodes write udmi_idx[0] (volumetric)
+    and udmi_idx[1..ND_ND] (vector) after the last chunk.
+    The volume weighted sum of the volumetric property for the conservative
+    correction is returned in a_vol_weighted_prop_sum (host).
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int no_chunks = 0;
+int ch;
+xreal *chunk_vals = NULL;
+#if RP_HOST
+int pe;
+int i, j, k, e;
+int e_start, no_rows;
+int header_arr[2];
+AnsysOutStream vol_stream;
+AnsysOutStream vec_stream;
+real *vol_chunk = NULL;
+real *vec_chunk = NULL;
+int *node_end = NULL;
+int *node_cursor = NULL;
+#endif
+#if RP_NODE
+cell_t c;
+Thread *t;
+Domain *domain = Get_Domain(1);
+xreal *elem_vals = NULL;
+int *recv_header = NULL;
+int no_recv_header = 0;
+int no_chunk_vals = 0;
+int size_elem_vals = plan->no_elems_node * no_fields;
+int pos = 0;
+int i = 0;
+int k;
+#endif
+
+if(no_fields != 1 && no_fields != 1 + ND_ND)
+{
+    return _STATE_ERROR;
+}
+
+no_chunks = (plan->no_a_elems + HOST_STREAMING_CHUNK_SIZE - 1) /
+                HOST_STREAMING_CHUNK_SIZE;
+
+#if RP_HOST
+(*a_vol_weighted_prop_sum) = 0;
+vol_stream.fp = NULL;
+vec_stream.fp = NULL;
+
+vol_chunk = (real *) calloc(2 * HOST_STREAMING_CHUNK_SIZE, sizeof(real));
+vec_chunk = (real *) calloc(ND_ND * HOST_STREAMING_CHUNK_SIZE, sizeof(real));
+chunk_vals = (xreal *) calloc(no_fields * HOST_STREAMING_CHUNK_SIZE,
+                              sizeof(xreal));
+node_end = (int *) calloc(compute_node_count, sizeof(int));
+node_cursor = (int *) calloc(compute_node_count, sizeof(int));
+
+if(
+    vol_chunk == NULL || vec_chunk == NULL || chunk_vals == NULL ||
+    node_end == NULL || node_cursor == NULL ||
+    plan->no_elems_per_node == NULL || plan->node_elem_idx == NULL
+  )
+{
+    Message("Error (exchangeStreamedPropertiesA2FZone()): Memory allocation "
+            "error or uninitialized stream plan!\n");
+    state = _STATE_ERROR;
+}
+else
+{
+    compute_node_loop (pe)
+    {
+        node_cursor[pe] = (pe > 0) ? node_end[pe - 1] : 0;
+        node_end[pe] = node_cursor[pe] + plan->no_elems_per_node[pe];
+    }
+
+    state = openAnsysOutStream(&vol_stream, ansys_vol_prop_file, 2);
+
+    if(state != _STATE_ERROR && no_fields > 1)
+    {
+        state = openAnsysOutStream(&vec_stream, ansys_vec_prop_file, ND_ND);
+    }
+}
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state == _STATE_ERROR)
+{
+    #if RP_HOST
+    closeAnsysOutStream(&vol_stream);
+    closeAnsysOutStream(&vec_stream);
+    free(vol_chunk);
+    free(vec_chunk);
+    free(chunk_vals);
+    free(node_end);
+    free(node_cursor);
+    #endif
+    return state;
+}
+
+#if RP_HOST
+Message("Streaming %i elements of zone id %i in %i chunks\n",
+        plan->no_a_elems, fluid_zone_id, no_chunks);
+
+/* all chunk messages are sent even after an error to keep the nodes in
+sync, without values then */
+for(ch = 0; ch < no_chunks; ++ch)
+{
+    e_start = ch * HOST_STREAMING_CHUNK_SIZE;
+    no_rows = plan->no_a_elems - e_start;
+    if(no_rows > HOST_STREAMING_CHUNK_SIZE)
+    {
+        no_rows = HOST_STREAMING_CHUNK_SIZE;
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        state = readAnsysOutStreamChunk(&vol_stream, vol_chunk, no_rows);
+    }
+    if(state != _STATE_ERROR && no_fields > 1)
+    {
+        state = readAnsysOutStreamChunk(&vec_stream, vec_chunk, no_rows);
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        for(i = 0; i < no_rows; ++i)
+        {
+            (*a_vol_weighted_prop_sum) += vol_chunk[2*i] * vol_chunk[2*i + 1];
+        }
+    }
+
+    compute_node_loop (pe)
+    {
+        j = 0;
+
+        while(
+                state != _STATE_ERROR && node_cursor[pe] < node_end[pe] &&
+                plan->node_elem_idx[node_cursor[pe]] < e_start + no_rows
+             )
+        {
+            e = plan->node_elem_idx[node_cursor[pe]] - e_start;
+
+            chunk_vals[j*no_fields] = (xreal) vol_chunk[2*e];
+            for(k = 1; k < no_fields; ++k)
+            {
+                chunk_vals[j*no_fields + k] = (xreal) vec_chunk[e*ND_ND + k - 1];
+            }
+
+            ++j;
+            ++node_cursor[pe];
+        }
+
+        header_arr[0] = ch;
+        header_arr[1] = j;
+        hostSendToNodeViaNodeZero(header_arr, 2, chunk_vals, j * no_fields);
+    }
+}
+
+closeAnsysOutStream(&vol_stream);
+closeAnsysOutStream(&vec_stream);
+free(vol_chunk);
+free(vec_chunk);
+free(node_end);
+free(node_cursor);
+#endif /* RP_HOST */
+
+#if RP_NODE
+elem_vals = (xreal *) calloc(size_elem_vals + 1, sizeof(xreal));
+
+if(elem_vals == NULL)
+{
+    Message("Error (exchangeStreamedPropertiesA2FZone()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+
+/* receive all chunks in any case, see host */
+for(ch = 0; ch < no_chunks; ++ch)
+{
+    nodeRecvFromHostViaNodeZero(&recv_header, &no_recv_header,
+                                &chunk_vals, &no_chunk_vals);
+
+    if(
+        no_recv_header != 2 || recv_header[0] != ch ||
+        no_chunk_vals != recv_header[1] * no_fields ||
+        pos + no_chunk_vals > size_elem_vals
+      )
+    {
+        state = _STATE_ERROR;
+    }
+    else if(state != _STATE_ERROR && no_chunk_vals > 0)
+    {
+        memcpy(elem_vals + pos, chunk_vals, no_chunk_vals * sizeof(xreal));
+        pos += no_chunk_vals;
+    }
+
+    free(recv_header);
+    free(chunk_vals);
+    recv_header = NULL;
+    chunk_vals = NULL;
+}
+
+if(pos != size_elem_vals)
+{
+    state = _STATE_ERROR;
+}
+
+state = reduceStateOverProcesses(state);
+
+t = Lookup_Thread(domain, fluid_zone_id);
+
+if(state != _STATE_ERROR)
+{
+    begin_c_loop_int(c, t)
+    {
+        for(k = 0; k < no_fields; ++k)
+        {
+            C_COUPLING(c,t,udmi_idx[k]) =
+                elem_vals[plan->cell_elem_slot[i]*no_fields + k];
+        }
+        ++i;
+    }
+    end_c_loop_int(c, t)
+}
+else
+{
+    Message0("Error (exchangeStreamedPropertiesA2FZone()): Streaming of zone "
+             "id %i failed!\n", fluid_zone_id);
+
+    begin_c_loop_int(c, t)
+    {
+        for(k = 0; k < no_fields; ++k)
+        {
+            C_COUPLING(c,t,udmi_idx[k]) = UDMI_ERROR_VALUE;
+        }
+    }
+    end_c_loop_int(c, t)
+}
+
+free(elem_vals);
+#endif /* RP_NODE */
+
+#if RP_HOST
+state = reduceStateOverProcesses(state);
+#endif
+
+free(chunk_vals);
+
+return state;
+}
+
+
+int exchangeStreamedAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                             )
+{
+/*
+    Writes the ANSYS element values of an F2A_AGG_PICK aggregation plan to
+    f2a_vol_prop_file while they arrive in chunks of
+    HOST_STREAMING_CHUNK_SIZE values from the nodes. Every element has exactly
+    one slot, so its fixed width record is written once at its position.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+xreal *node_partials = NULL;
+
+#if RP_HOST
+int pe;
+F2AStreamWriter writer;
+char part_file[XC_PART_FILENAME_SIZE];
+
+exchangePartFileName(part_file, f2a_vol_prop_file);
+writer.fp = NULL;
+writer.plan = plan;
+writer.node_slot_start = NULL;
+writer.next_elem = 0;
+writer.state = _STATE_OK;
+
+if(plan->aggregation_mode != F2A_AGG_PICK || plan->no_slots_per_node == NULL)
+{
+    Message("Error (exchangeStreamedAggregatedPropertyF2AZone()): Only "
+            "initialized F2A_AGG_PICK plans can be streamed!\n");
+    state = _STATE_ERROR;
+}
+else
+{
+    writer.node_slot_start = (int *) calloc(compute_node_count, sizeof(int));
+
+    if(writer.node_slot_start == NULL)
+    {
+        Message("Error (exchangeStreamedAggregatedPropertyF2AZone()): Memory "
+                "allocation error!\n");
+        state = _STATE_ERROR;
+    }
+    else if((writer.fp = fopen(part_file, "wb")) == NULL)
+    {
+        Message("Error (exchangeStreamedAggregatedPropertyF2AZone()): Unable "
+                "to open %s\n", part_file);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        for(pe = 1; pe < compute_node_count; ++pe)
+        {
+            writer.node_slot_start[pe] = writer.node_slot_start[pe - 1] +
+                                         plan->no_slots_per_node[pe - 1];
+        }
+    }
+}
+#endif /* RP_HOST */
+
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+xreal *node_vals = NULL;
+int no_node_vals = 0;
+
+t = Lookup_Thread(domain, fluid_zone_id);
+no_node_vals = THREAD_N_ELEMENTS_INT(t);
+node_vals = (xreal *) calloc(no_node_vals + 1, sizeof(xreal));
+node_partials = (xreal *) calloc(plan->no_slots_node + 1, sizeof(xreal));
+
+if(node_vals == NULL || node_partials == NULL)
+{
+    Message("Error (exchangeStreamedAggregatedPropertyF2AZone()): Memory "
+            "allocation error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+else
+{
+    nodeGatherCellXValues(node_vals, C_VAL_WRAPPER_FUN, t);
+
+    aggregateNodeValuesToSlots(plan, node_vals, no_node_vals, node_partials);
+}
+
+free(node_vals);
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state != _STATE_ERROR)
+{
+    #if RP_HOST
+    state = nodesToHostRealArraysChunked(NULL, 0, HOST_STREAMING_CHUNK_SIZE,
+                                         writeF2AStreamChunk, &writer);
+    #else
+    state = nodesToHostRealArraysChunked(node_partials, plan->no_slots_node,
+                                         HOST_STREAMING_CHUNK_SIZE,
+                                         NULL, NULL);
+    #endif
+}
+
+#if RP_HOST
+if(writer.fp != NULL)
+{
+    if(state != _STATE_ERROR && writer.state == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+    fseek(writer.fp, 0, SEEK_END);
+
+    if(
+        state != _STATE_ERROR &&
+        ftell(writer.fp) != (long) plan->no_a_elems * F2A_STREAM_RECORD_LEN
+      )
+    {
+        Message("Error (exchangeStreamedAggregatedPropertyF2AZone()): File "
+                "size of %s does not match %i elements!\n", f2a_vol_prop_file,
+                plan->no_a_elems);
+        state = _STATE_ERROR;
+    }
+    if(state != _STATE_ERROR && flushExchangeFile(writer.fp) != _STATE_OK)
+    {
+        state = _STATE_ERROR;
+    }
+    if(fclose(writer.fp) != 0)
+    {
+        state = _STATE_ERROR;
+    }
+
+    state = publishExchangeFile(part_file, f2a_vol_prop_file, state);
+}
+
+if(state != _STATE_ERROR)
+{
+    Message("Info (exchangeStreamedAggregatedPropertyF2AZone()): For zone id "
+            "%i, done!\n", fluid_zone_id);
+}
+
+free(writer.node_slot_start);
+#endif /* RP_HOST */
+
+free(node_partials);
+
+return state;
+}
+
+
+void freeA2FStreamPlan(A2FStreamPlan *plan)
+{
+    if(plan == NULL)
+    {
+        return;
+    }
+
+    free(plan->no_elems_per_node);
+    free(plan->node_elem_idx);
+    free(plan->cell_elem_slot);
+
+    plan->no_elems_per_node = NULL;
+    plan->node_elem_idx = NULL;
+    plan->cell_elem_slot = NULL;
+    plan->no_elems_node = 0;
+    plan->no_cells_node = 0;
+}
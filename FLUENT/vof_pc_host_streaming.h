@@ -0,0 +1,82 @@
+/*
+Streaming exchange of coupling values through the host in chunks of ANSYS
+elements, so the host never holds zone sized value arrays (see
+HOST_STREAMING_EXCHANGE in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_HOST_STREAMING_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_read_ansys.h"
+#include "vof_pc_f2a_aggregation.h"
+#include "vof_pc_zone_storage.h"
+#include "vof_pc_text_writer.h"
+#define VOF_PC_HOST_STREAMING_H
+
+#define A2F_STREAM_MAX_FIELDS (1 + ND_ND)
+
+/* fixed width F2A records "%8.6f\n" of values clamped to [0,1] */
+#define F2A_STREAM_RECORD_LEN 9
+
+/*
+Every compute node holds the (ascending) list of ANSYS elements its cells are
+mapped to and, for every cell in cell loop order, the index of its element in
+this list. The host keeps the element lists of all nodes to forward each
+chunk of ANSYS elements only to the nodes referencing them. The plan is also
+used for the node-side mapping (see vof_pc_node_mapping.c).
+*/
+typedef struct a2f_stream_plan_struct
+{
+    int no_a_elems;
+
+    /* host: lists of all nodes, compute nodes: own list */
+    int *node_elem_idx;
+
+    /* host */
+    int *no_elems_per_node;
+
+    /* compute nodes */
+    int no_elems_node;
+    int no_cells_node;
+    int *cell_elem_slot;
+} A2FStreamPlan;
+
+
+int initA2FStreamPlanOfCellZone(
+                                A2FStreamPlan *plan,
+                                int *f2a_mapping_zone,
+                                int *f_cells_per_node,
+                                int no_f_cells_zone,
+                                int no_a_elems_zone,
+                                int fluid_zone_id
+                               );
+
+int exchangeStreamedPropertiesA2FZone(
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                     );
+
+int exchangeStreamedAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                             );
+
+void freeA2FStreamPlan(A2FStreamPlan *plan);
+
+#endif
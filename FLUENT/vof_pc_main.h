@@ -32,12 +32,158 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 
 #define VOF_MAX_REL_CHANGE 0.25 /* Max value that any VOF of a Cell in Fluent can cange until recoupling with ANSYS if loose coupling is choosen */
 
+/* Aggregate the F2A values to ANSYS elements on the compute nodes, so the host 
+only receives ANSYS element sized arrays (see vof_pc_f2a_aggregation.c) */
+#define F2A_NODE_AGGREGATION 0
+
+/* Send all A2F fields of all zones in one packed message per compute node 
+(see distributePackedZonesToNodesWithScatterPlans()) */
+#define A2F_PACKED_SCATTER 0
+
+/* Parse the ANSYS files of all zones and pack the node messages concurrently
+on a host thread pool of VOF_PC_THREAD_POOL_SIZE threads (see vof_pc_threads.c),
+only used with A2F_PACKED_SCATTER */
+#define A2F_PIPELINED_EXCHANGE 0
+#define VOF_PC_THREAD_POOL_SIZE 3
+
+/* Parse large ANSYS tables in line aligned chunks of ANSYS_TABLE_CHUNK_SIZE 
+bytes on the host thread pool, each chunk directly into its rows of the 
+output arrays (see parseAnsysTable()). Starts the pool also without 
+A2F_PIPELINED_EXCHANGE */
+#define ANSYS_PARALLEL_PARSE 0
+#define ANSYS_TABLE_CHUNK_SIZE 4194304
+
+/* Write the debug files (NN mappings, Debug_Export_Fluent_Coords, 
+Debug_Export_Fluent_Fields) on a background writer thread of the host, which 
+takes over their buffers. At most VOF_PC_WRITER_QUEUE_SIZE files wait to be 
+written, further ones block until there is room. All files are complete after 
+freeGlobalArrays() (see submitBackgroundWrite()) */
+#define DEBUG_BACKGROUND_WRITER 0
+#define VOF_PC_WRITER_QUEUE_SIZE 4
+
+/* Append the exchanged ANSYS element fields of every coupling step (VOF out, 
+Joule heat and Lorentz force in, per zone) to the binary trace 
+_COUPLING_TRACE_DAT_ with an index of all records (see vof_pc_trace.h, 
+TOOLS/vof_pc_trace_read.c extracts them). The coupling only copies the values, 
+they are encoded and written by the background writer thread. Only fields the 
+host holds as a whole are recorded, not those of HOST_STREAMING_EXCHANGE, 
+NODE_ZERO_IO, F2A_PARALLEL_WRITE, A2F_PARALLEL_READ, A2F_NODE_MAPPING or without 
+F2A_NODE_AGGREGATION. With TRACE_COMPRESSION the values are stored as run 
+length encoded byte planes of their difference (xor) to the previous step */
+#define COUPLING_TRACE 0
+#define TRACE_COMPRESSION 1
+
+/* Read Joule heat, element volume and Lorentz force of JOULE_HEAT_PLUS_LORENTZ 
+zones in one pass from a single file per zone (a_merged_file of the zone with 
+the columns _g_a2f_merged_columns, see vof_pc_nn_coupling.c) instead of the JH and 
+LF files. Only used by the default and the A2F_PACKED_SCATTER exchange */
+#define A2F_MERGED_FILE 0
+
+/* Keep the ANSYS element volumes of each zone from the first A2F result file 
+(value and volume column as before) with the zone on the host, all later 
+result files of the zone only need to hold the value column (the columns are 
+detected, see STATIC_ELEM_VOLUMES in apdl_example.ans). Also for the merged 
+files of A2F_MERGED_FILE. Requires fixed meshes, only used by the default and 
+the A2F_PACKED_SCATTER exchange */
+#define A2F_STATIC_ELEM_VOLUMES 0
+
+/* Stream the A2F and F2A values through the host in chunks of 
+HOST_STREAMING_CHUNK_SIZE ANSYS elements, so the host memory does not scale 
+with the zone size (see vof_pc_host_streaming.c). Replaces A2F_PACKED_SCATTER, 
+F2A is only streamed for zones aggregated with F2A_AGG_PICK */
+#define HOST_STREAMING_EXCHANGE 0
+#define HOST_STREAMING_CHUNK_SIZE 65536
+
+/* Apply the f2a mapping on the compute nodes, the host only reads and sends 
+ANSYS element sized arrays (see vof_pc_node_mapping.c). With 
+A2F_NODE_MAPPING_BROADCAST all elements are broadcast to every node, otherwise 
+each node only receives the elements its cells are mapped to. Replaces 
+A2F_PACKED_SCATTER, HOST_STREAMING_EXCHANGE takes precedence */
+#define A2F_NODE_MAPPING 0
+#define A2F_NODE_MAPPING_BROADCAST 1
+
+/* Read and write the exchange files and poll the sync file on compute node 0 
+instead of the host, e.g. if the host runs on a remote workstation. The XC 
+folder has to be accessible from node 0, the host only receives status codes 
+(see vof_pc_node_zero_io.c). The mappings are still built on the host during 
+init. Requires F2A_NODE_AGGREGATION, takes precedence over all A2F modes */
+#define NODE_ZERO_IO 0
+
+/* Write the F2A file on the compute nodes: node 0 preallocates it under a 
+temporary name (XC_PART_FILE_SUFFIX, also without XC_ATOMIC_PUBLISH), each node 
+writes the fixed width records of its ANSYS elements at their offsets (pwrite 
+if LINUX is set) and the complete file is renamed to its final name (see 
+vof_pc_parallel_write.c). The XC folder has to be shared by all nodes. Only 
+used for F2A_AGG_PICK zones, requires F2A_NODE_AGGREGATION */
+#define F2A_PARALLEL_WRITE 0
+
+/* Read the A2F files on all compute nodes: each node preads only the records 
+of the ANSYS elements its cells are mapped to and an equal share for the 
+conservative correction (see vof_pc_parallel_read.c). The ANSYS output has to 
+be written with fixed width records, e.g. (E15.7), and the XC folder has to be 
+shared by all nodes. Takes precedence over all other A2F modes */
+#define A2F_PARALLEL_READ 0
+
+/* Precision of the coupling values in node messages and node buffers (xreal), 
+independent of the real type of Fluent: values are converted once when read 
+from or written to the cells. The XC files carry only about 7 significant 
+digits (E15.7, F8.6), so single precision halves the message volume of double 
+precision runs. The host arrays are xreal only with the plan based exchanges 
+(F2A_NODE_AGGREGATION, HOST_STREAMING_EXCHANGE, A2F_NODE_MAPPING, NODE_ZERO_IO, 
+A2F_PACKED_SCATTER), the default scatter and gather convert the real host 
+arrays when sending. Mapping data and weights stay real */
+#define FLOAT_TRANSPORT 0
+
+#if FLOAT_TRANSPORT
+typedef float xreal;
+#define PRF_CSEND_XREAL PRF_CSEND_FLOAT
+#define PRF_CRECV_XREAL PRF_CRECV_FLOAT
+#define host_to_node_xreal host_to_node_float
+#else
+typedef real xreal;
+#define PRF_CSEND_XREAL PRF_CSEND_REAL
+#define PRF_CRECV_XREAL PRF_CRECV_REAL
+#define host_to_node_xreal host_to_node_real
+#endif
+
+/* Keep the coupling fields (enum udmis) of the coupled zones in compact arrays 
+on the compute nodes, indexed by cell, instead of in UDMIs which Fluent 
+allocates for every cell of the domain (see vof_pc_zone_storage.c). No UDMIs 
+have to be reserved for the coupling then */
+#define ZONE_COUPLING_STORAGE 0
+
+/* Copy the VOF or centroid values of the interior cells of a coupled zone 
+into the send buffers as one block, if Fluent stores them contiguously for 
+the cell thread (checked with the addresses of the first and last cell), 
+instead of through the cell accessors (see nodeGatherCellValues()). Falls 
+back to the cell loop for any other storage layout */
+#define CELL_STORAGE_BULK_COPY 0
+
+/* Write every exchange file (data files and the sync file) under its name 
+plus XC_PART_FILE_SUFFIX in the exchange folder and rename it to its name 
+when complete, so a coupling partner never reads a partly written file (see 
+publishExchangeFile()). The waits for the sync file stay, ANSYS writes its 
+files in place (see sync_wait_for_state()) */
+#define XC_ATOMIC_PUBLISH 0
+
+/* Additionally flush the exchange files to disk before they are renamed, 
+only needed if the partner may read them after a crash of the machine */
+#define XC_PUBLISH_FSYNC 0
+
+/* Record the exchange with ANSYS on the host: the sync states Fluent writes 
+and reads and copies of the coordinate and A2F files ANSYS has written, with 
+their times (see vof_pc_xc_record.h). TOOLS/vof_pc_xc_replay.c replays a 
+recording as the ANSYS side, so the Fluent side of the exchange can be run 
+and timed without ANSYS. Not recorded with NODE_ZERO_IO */
+#define XC_RECORDING 0
+
 #define MAX_COUPLING_TRIALS 10000 
 #define COUPLING_SLEEP_TIME_IN_S 1
 
 enum couplingStates {COUPLING_INIT=0, ANSYS_READY, FLUENT_READY, STOP_SIM, SYNC_ERROR};
 enum coupledProperties {NONE=0, JOULE_HEAT, JOULE_HEAT_PLUS_LORENTZ, VOF};
 enum udmis {UDM_JH=0, UDM_LFx, UDM_LFy, UDM_LFz, UDM_VOF_old};
+enum f2aAggregationModes {F2A_AGG_PICK=0, F2A_AGG_VOL_WEIGHTED};
 
 #define LINUX 0
 
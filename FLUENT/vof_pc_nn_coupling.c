@@ -19,62 +19,71 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #include "vof_pc_nn_mapping.h"
 #include "vof_pc_file_sync.h"
 #include "vof_pc_read_ansys.h"
+#include "vof_pc_f2a_aggregation.h"
+#include "vof_pc_scatter_plan.h"
+#include "vof_pc_threads.h"
+#include "vof_pc_host_streaming.h"
+#include "vof_pc_node_mapping.h"
+#include "vof_pc_node_zero_io.h"
+#include "vof_pc_parallel_write.h"
+#include "vof_pc_parallel_read.h"
+#include "vof_pc_zone_storage.h"
+#include "vof_pc_coupling_context.h"
+#include "vof_pc_text_writer.h"
+#include "vof_pc_trace.h"
 
 
 const int _g_f_lf_udmi_vec[ND_ND] = {UDM_LFx, UDM_LFy, UDM_LFz};
 
-const int _g_no_coupled_areas = 3;
-
-const int _g_cell_zone_id[3] = {22,23,24};
-
-const int _g_a2f_coupling_for_zone[3] = {1,1,1};
-const int _g_f2a_coupling_for_zone[3] = {1,0,0};
-
-const int _g_a2f_coupled_properties[3] = {JOULE_HEAT_PLUS_LORENTZ, JOULE_HEAT, JOULE_HEAT};
-const int _g_f2a_coupled_properties[3] = {VOF, NONE, NONE}; /* Array with function pointers to cell marocs - TODO */ 
-
-
-char _g_a_coupling_files_coords[3][250] = {_ANSYS_TO_FLUENT_MIXTURE_COORDS_OUT_DAT_, 
-                                              _ANSYS_TO_FLUENT_SKIN_COORDS_OUT_DAT_,
-                                              _ANSYS_TO_FLUENT_MOULD_COORDS_OUT_DAT_};
-char _g_a_vol_val_files_jouleheat[3][250] =   {_ANSYS_TO_FLUENT_MIXTURE_JH_OUT_DAT_, 
-                                              _ANSYS_TO_FLUENT_SKIN_JH_OUT_DAT_,
-                                              _ANSYS_TO_FLUENT_MOULD_JH_OUT_DAT_};
-
-char _g_a_vec_files_lorentzforce[3][250] =  {_ANSYS_TO_FLUENT_MIXTURE_LF_OUT_DAT_, 
-                                               _DUMMY_DAT_,
-                                               _DUMMY_DAT_};
-
-
-char _g_f2a_files[3][250] = {_FLUENT_TO_ANSYS_VOFOUT_DAT_, _DUMMY_DAT_, _DUMMY_DAT_};
-
-char _g_a2f_mapping_files[3][250]= {_ANSYS_TO_FLUENT_MAPPING_MIXTURE_DAT_, 
-                                              _ANSYS_TO_FLUENT_MAPPING_SKIN_DAT_,
-                                              _ANSYS_TO_FLUENT_MAPPING_MOULD_DAT_};
-char _g_f2a_mapping_files[3][250]= {_FLUENT_TO_ANSYS_MAPPING_DAT_, _DUMMY_DAT_, _DUMMY_DAT_};
-
-char _g_f_debug_coords_files[3][250]={_FLUENT_DEBUG_MIXTURE_COORDS_OUT_DAT_,
-                                    _FLUENT_DEBUG_SKIN_COORDS_OUT_DAT_,
-                                    _FLUENT_DEBUG_MOULD_COORDS_OUT_DAT_
-                                    };
-
-
 /*
-Value of fluent cell c proptery of coupling region r:
-prop_fluent[c] = prop_ansys[_g_a2f_mappings_zone_arr[r][c]] * _g_a2f_weights_zone_arr[r][c] 
-Value of ansys element e propery of coupling region r:
-prop_ansys[e] = prop_ansys[_g_f2a_mappings_zone_arr[r][c]] * _g_f2a_weights_zone_arr[r][c] 
+Coupled cell zones, any number of zones: cell zone id, A2F and F2A coupling,
+A2F and F2A property, F2A aggregation and format, then the files in the order
+of CouplingZoneConfig (see vof_pc_coupling_context.h)
 */
-int **_g_a2f_mappings_zone_arr = NULL;
-real **_g_a2f_weights_zone_arr = NULL;
-int **_g_f2a_mappings_zone_arr = NULL;
-real **_g_f2a_weights_zone_arr = NULL;
-int *_g_no_a_elems_zone_arr = NULL;
-int *_g_no_f_cells_zone_arr = NULL;
+CouplingZoneConfig _g_coupling_zone_configs[] =
+{
+    {
+        22, 1, 1, JOULE_HEAT_PLUS_LORENTZ, VOF, F2A_AGG_PICK, XC_FORMAT_TEXT,
+        _ANSYS_TO_FLUENT_MIXTURE_COORDS_OUT_DAT_,
+        _ANSYS_TO_FLUENT_MIXTURE_JH_OUT_DAT_,
+        _ANSYS_TO_FLUENT_MIXTURE_LF_OUT_DAT_,
+        _ANSYS_TO_FLUENT_MIXTURE_OUT_DAT_,
+        _FLUENT_TO_ANSYS_VOFOUT_DAT_,
+        _ANSYS_TO_FLUENT_MAPPING_MIXTURE_DAT_,
+        _FLUENT_TO_ANSYS_MAPPING_DAT_,
+        _FLUENT_DEBUG_MIXTURE_COORDS_OUT_DAT_
+    },
+    {
+        23, 1, 0, JOULE_HEAT, NONE, F2A_AGG_PICK, XC_FORMAT_TEXT,
+        _ANSYS_TO_FLUENT_SKIN_COORDS_OUT_DAT_,
+        _ANSYS_TO_FLUENT_SKIN_JH_OUT_DAT_,
+        _DUMMY_DAT_,
+        _DUMMY_DAT_,
+        _DUMMY_DAT_,
+        _ANSYS_TO_FLUENT_MAPPING_SKIN_DAT_,
+        _DUMMY_DAT_,
+        _FLUENT_DEBUG_SKIN_COORDS_OUT_DAT_
+    },
+    {
+        24, 1, 0, JOULE_HEAT, NONE, F2A_AGG_PICK, XC_FORMAT_TEXT,
+        _ANSYS_TO_FLUENT_MOULD_COORDS_OUT_DAT_,
+        _ANSYS_TO_FLUENT_MOULD_JH_OUT_DAT_,
+        _DUMMY_DAT_,
+        _DUMMY_DAT_,
+        _DUMMY_DAT_,
+        _ANSYS_TO_FLUENT_MAPPING_MOULD_DAT_,
+        _DUMMY_DAT_,
+        _FLUENT_DEBUG_MOULD_COORDS_OUT_DAT_
+    }
+};
+const int _g_no_coupling_zone_configs =
+        sizeof(_g_coupling_zone_configs) / sizeof(_g_coupling_zone_configs[0]);
+
+const int _g_a2f_merged_columns[5] = {A2F_COL_VALUE, A2F_COL_VEC_X, A2F_COL_VEC_Y, A2F_COL_VEC_Z, A2F_COL_VOLUME}; /* JH, FX, FY, FZ, VOLUME */
+const int _g_a2f_no_merged_columns = 5;
 
-int **_g_f_ordered_cids_zone_arr = NULL; /* cell ids ordered from node 0 to node p for each fluent cell c*/
-int **_g_f_ordered_myids_zone_arr = NULL; /*  node ids from 0 to p for each fluent cell c*/
-int **_g_f_no_cells_per_node_zone_arr = NULL; /* cells per node for each node myid*/
+
+CouplingContext _g_coupling_ctx = {0, NULL, NULL, NULL, NULL, NULL}; /* host and nodes, see vof_pc_coupling_context.h */
 
 
 /* Functions */
@@ -98,16 +107,17 @@ int initNNCouplingOfCellZone(
                             char a2f_debug_mapping_file[]
                             );
 int exchangeCellZones(int exch_state);
+int exchangePackedPropertiesA2FZones();
+int exchangeElemListPropertiesA2FZones();
 int exchangeVolumetricPropertyA2FZone(
                                         char ansys_vol_prop_file[],
                                         int *f2a_mapping_zone,
                                         int no_a_elems_zone,
                                         int no_f_cells_zone,
                                         int fluid_zone_id,
-                                        int *f_compute_node_id_arr_full,
-                                        int *f_cell_id_arr_full,
-                                        int *f_cells_per_node,
-                                        int udmi_idx
+                                        ScatterPlan *scatter_plan,
+                                        int udmi_idx,
+                                        real **static_elem_vols
                                         );
 int exchangeVecPropertyA2FZone(
                                 char ansys_vec_prop_file[],
@@ -115,11 +125,20 @@ int exchangeVecPropertyA2FZone(
                                 int no_a_elems_zone,
                                 int no_f_cells_zone,
                                 int fluid_zone_id,
-                                int *f_compute_node_id_arr_full,
-                                int *f_cell_id_arr_full,
-                                int *f_cells_per_node,
+                                ScatterPlan *scatter_plan,
                                 const int udmis_vec[ND_ND]
                                 );
+int exchangeMergedPropertiesA2FZone(
+                                    char ansys_merged_file[],
+                                    int *f2a_mapping_zone,
+                                    int no_a_elems_zone,
+                                    int no_f_cells_zone,
+                                    int fluid_zone_id,
+                                    ScatterPlan *scatter_plan,
+                                    int udmi_idx,
+                                    const int udmis_vec[ND_ND],
+                                    real **static_elem_vols
+                                    );
 int exchangeVolumetricPropertyF2AZone(  
                                     char f2a_vol_prop_file[],
                                     int *a2f_mapping_zone,
@@ -135,8 +154,14 @@ void correctVolumetricPropertyA2F(
                                     int fluid_zone_id,
                                     int udmi_idx
                                 );
+void correctVolumetricPropertyA2FWithSum(
+                                    real a_vol_weighted_prop_sum,
+                                    int fluid_zone_id,
+                                    int udmi_idx
+                                );
 int strictCoupling();
 int debug_setAnsysReady();
+void recordAnsysOutputsOfZones(int coords);
 int hostWriteDebugCoords(
                             char filename[],
                             real (*coord_arr_full)[ND_ND],
@@ -210,6 +235,11 @@ DEFINE_ON_DEMAND(initCouplingWithAnsysCoords_oD)
     #if RP_HOST
     Message("If not allready done please start ANSYS now!\n");
     state = sync_wait_for_state(_SYNC_DAT_, ANSYS_READY, &coupling_state);
+
+    if(state == _STATE_OK && coupling_state == ANSYS_READY)
+    {
+        recordAnsysOutputsOfZones(1);
+    }
     #endif
 
     host_to_node_int_2(state, coupling_state);
@@ -260,6 +290,11 @@ DEFINE_ON_DEMAND(initCouplingWithAnsysCoords_oD)
     {
         state = sync_wait_for_coupling(_SYNC_DAT_);
     }
+    /* only _STATE_OK means ANSYS_READY was read, not a timeout */
+    if (state == _STATE_OK)
+    {
+        recordAnsysOutputsOfZones(0);
+    }
     #endif
 
     if(state != _STATE_ERROR)
@@ -325,6 +360,10 @@ DEFINE_EXECUTE_AT_END(looseCoupling_aE)
         #endif
     }
 
+    #if RP_NODE
+    clearStagedCellValues();
+    #endif
+
     if(state == _STATE_ERROR)
     {
         Message("Error within strictCoupling()!\n");
@@ -333,6 +372,78 @@ DEFINE_EXECUTE_AT_END(looseCoupling_aE)
 /* ------------------------------------------------------------------------- */
 
 
+#if RP_HOST && DEBUG_BACKGROUND_WRITER
+/* arrays of one zone owned by the background writer thread */
+typedef struct debug_coords_job_struct
+{
+    char *filename;
+    real (*coord_arr_full)[ND_ND];
+    int *cell_id_arr_full;
+    int *compute_node_id_arr_full;
+    int arr_full_size;
+} DebugCoordsJob;
+
+
+static int writeDebugCoordsJob(void *arg)
+{
+    DebugCoordsJob *job = (DebugCoordsJob *) arg;
+    int state;
+
+    state = hostWriteDebugCoords(
+                                    job->filename,
+                                    job->coord_arr_full,
+                                    job->cell_id_arr_full,
+                                    job->compute_node_id_arr_full,
+                                    job->arr_full_size
+                                );
+
+    free(job->coord_arr_full);
+    free(job->cell_id_arr_full);
+    free(job->compute_node_id_arr_full);
+    free(job);
+
+    return state;
+}
+
+
+static int submitDebugCoords(
+                                char filename[],
+                                real (**coord_arr_full)[ND_ND],
+                                int **cell_id_arr_full,
+                                int **compute_node_id_arr_full,
+                                int arr_full_size
+                            )
+{
+/*
+    Hands the arrays over to the background writer thread and sets them to
+    NULL, writes them directly if no job can be allocated.
+*/
+    DebugCoordsJob *job = (DebugCoordsJob *) malloc(sizeof(DebugCoordsJob));
+
+    if(job == NULL)
+    {
+        return hostWriteDebugCoords(filename, (*coord_arr_full),
+                                    (*cell_id_arr_full),
+                                    (*compute_node_id_arr_full), arr_full_size);
+    }
+
+    job->filename = filename;
+    job->coord_arr_full = (*coord_arr_full);
+    job->cell_id_arr_full = (*cell_id_arr_full);
+    job->compute_node_id_arr_full = (*compute_node_id_arr_full);
+    job->arr_full_size = arr_full_size;
+
+    (*coord_arr_full) = NULL;
+    (*cell_id_arr_full) = NULL;
+    (*compute_node_id_arr_full) = NULL;
+
+    submitBackgroundWrite(writeDebugCoordsJob, job);
+
+    return _STATE_OK;
+}
+#endif
+
+
 DEFINE_ON_DEMAND(Debug_Export_Fluent_Coords)
 {
     int state = _STATE_OK;
@@ -345,7 +456,7 @@ DEFINE_ON_DEMAND(Debug_Export_Fluent_Coords)
     int arr_full_size = -1;
     int ir;
 
-    for(ir=0; ir<_g_no_coupled_areas;++ir)
+    for(ir=0; ir<_g_no_coupling_zone_configs;++ir)
     {
         controllSum = -1;
         no_f_cells_zone = 0;
@@ -353,30 +464,40 @@ DEFINE_ON_DEMAND(Debug_Export_Fluent_Coords)
         state = hostGetCellCountPerNodeInCellZone( 
                                                 &f_no_cells_per_node_zone,
                                                 &controllSum,
-                                                _g_cell_zone_id[ir]
+                                                _g_coupling_zone_configs[ir].cell_zone_id
                                                 );
 
         hostGetOrderingArraysFromNodesInCellZone( 
                                             &f_ordered_cids_zone,
                                             &f_ordered_myids_zone,
                                             &no_f_cells_zone,
-                                            _g_cell_zone_id[ir]
+                                            _g_coupling_zone_configs[ir].cell_zone_id
                                             );  
 
         hostGetCellCoordsFromNodesInCellZone( 
                                         &f_coord_arr_full,
                                         no_f_cells_zone,
-                                        _g_cell_zone_id[ir]
+                                        _g_coupling_zone_configs[ir].cell_zone_id
                                         );
 
         
+        #if RP_HOST && DEBUG_BACKGROUND_WRITER
+        state = submitDebugCoords(
+                            _g_coupling_zone_configs[ir].f_debug_coords_file,
+                            &f_coord_arr_full,
+                            &f_ordered_cids_zone,
+                            &f_ordered_myids_zone,
+                            no_f_cells_zone
+                        );
+        #else
         state = hostWriteDebugCoords (
-                            _g_f_debug_coords_files[ir],
+                            _g_coupling_zone_configs[ir].f_debug_coords_file,
                             f_coord_arr_full,
                             f_ordered_cids_zone,
                             f_ordered_myids_zone,
                             no_f_cells_zone
                         );
+        #endif
 
         #if RP_HOST
         if(f_coord_arr_full != NULL)
@@ -403,38 +524,135 @@ DEFINE_ON_DEMAND(Debug_Export_Fluent_Coords)
     }
     
 
-    #if RP_HOST
+    #if RP_HOST && DEBUG_BACKGROUND_WRITER
+        Message("Export handed to the background writer!\n");
+    #elif RP_HOST
         Message("Export Done!\n");
     #endif
 }
 /* ------------------------------------------------------------------------- */
 /* ------------------------------------------------------------------------- */
 
+#if RP_NODE
+static real *stagedVOFBufferOfZone(int i, int no_cells)
+{
+/*
+    Returns the staging buffer of zone i for no_cells cells, NULL if there is
+    none (the VOF is then read from the cells again).
+*/
+    CouplingZone *zone;
+    real *vals;
+
+    if(i >= _g_coupling_ctx.no_zones || _g_coupling_ctx.zones == NULL)
+    {
+        return NULL;
+    }
+
+    zone = &_g_coupling_ctx.zones[i];
+
+    if(zone->staged_vof == NULL || zone->no_staged_vof != no_cells)
+    {
+        vals = (real *) realloc(zone->staged_vof, (no_cells + 1) * sizeof(real));
+
+        if(vals == NULL)
+        {
+            return NULL;
+        }
+
+        zone->staged_vof = vals;
+        zone->no_staged_vof = no_cells;
+    }
+
+    return zone->staged_vof;
+}
+
+
+static real *oldVOFOfZone(int i, int no_cells)
+{
+/*
+    Returns the VOF of zone i at the last coupling for no_cells cells, NULL
+    if there is none (UDM_VOF_old holds it then, e.g. without coupling
+    context or after initVofUDM()).
+*/
+    if(
+        i >= _g_coupling_ctx.no_zones || _g_coupling_ctx.zones == NULL ||
+        _g_coupling_ctx.zones[i].no_old_vof != no_cells
+      )
+    {
+        return NULL;
+    }
+
+    return _g_coupling_ctx.zones[i].old_vof;
+}
+
+
+static void freeOldVOFOfZones()
+{
+/*
+    Drops the old VOF buffers, the old VOF is read from UDM_VOF_old again.
+*/
+    int i;
+
+    for(i = 0; i < _g_coupling_ctx.no_zones && _g_coupling_ctx.zones != NULL; ++i)
+    {
+        free(_g_coupling_ctx.zones[i].old_vof);
+        _g_coupling_ctx.zones[i].old_vof = NULL;
+        _g_coupling_ctx.zones[i].no_old_vof = 0;
+    }
+}
+#endif
+/* ------------------------------------------------------------------------- */
+
 real maxRelChangeVOFzones()
 {
+/*
+    Max change of the VOF since the last coupling over all VOF zones. The
+    VOF read for this is staged for the F2A exchange and the update of the
+    old VOF of the same step (see looseCoupling_aE), so these do not loop
+    over the cells of the zones again.
+*/
     real relChange = 0;
 
     #if RP_NODE
     cell_t c;
     Thread *t;
-    Thread **pt;
+    Thread *pt_phase;
     Domain *domain = Get_Domain(1); 
+    real vof = 0;
+    real vof_old = 0;
     real vof_diff = 0;
-    int i;
+    real *staged;
+    real *old;
+    int i, j;
   
-    for (i = 0; i < _g_no_coupled_areas; i++)
+    for (i = 0; i < _g_no_coupling_zone_configs; i++)
     {
-        if (_g_f2a_coupled_properties[i] == VOF)
+        if (_g_coupling_zone_configs[i].f2a_property == VOF)
         {
-            t = Lookup_Thread(domain, _g_cell_zone_id[i]);
-            pt = THREAD_SUB_THREADS(t);
+            t = Lookup_Thread(domain, _g_coupling_zone_configs[i].cell_zone_id);
+            pt_phase = THREAD_SUB_THREADS(t)[COUPLING_PHASE_FRAC_IDX];
+            staged = stagedVOFBufferOfZone(i, THREAD_N_ELEMENTS_INT(t));
+            old = oldVOFOfZone(i, THREAD_N_ELEMENTS_INT(t));
 
+            j = 0;
             begin_c_loop_int(c, t) 
             {
-
-                vof_diff = fabs(C_VOF(c,pt[COUPLING_PHASE_FRAC_IDX]) - C_UDMI(c,t, UDM_VOF_old));
+                vof = C_VOF(c,pt_phase);
+                vof_old = (old != NULL) ? old[j] : C_COUPLING(c,t, UDM_VOF_old);
+                vof_diff = fabs(vof - vof_old);
                 relChange = MAX(relChange,vof_diff);
+
+                if(staged != NULL)
+                {
+                    staged[j] = vof;
+                }
+                ++j;
             }end_c_loop_int(c, t)
+
+            if(staged != NULL)
+            {
+                stageCellValues(t, get_c_vof, staged);
+            }
         }
     }
 
@@ -449,7 +667,9 @@ real maxRelChangeVOFzones()
 
 void initVofUDM()
 {
-    #if RP_NODE
+    #if RP_NODE && ZONE_COUPLING_STORAGE
+    resetZoneStorageField(UDM_VOF_old);
+    #elif RP_NODE
     cell_t c;
     Thread *t;
     Domain *domain = Get_Domain(1); 
@@ -458,33 +678,93 @@ void initVofUDM()
     {
         begin_c_loop_int(c, t) 
         {
-            C_UDMI(c,t, UDM_VOF_old) = 0.0 ;
+            C_COUPLING(c,t, UDM_VOF_old) = 0.0 ;
         }end_c_loop_int(c, t)
     }
     #endif
+
+    #if RP_NODE
+    freeOldVOFOfZones();
+    #endif
 }
 /* ------------------------------------------------------------------------- */
 
 void updateOldVOFCouplingValues()
 {
+/*
+    Makes the VOF staged by maxRelChangeVOFzones() the old VOF of its zone by
+    swapping the staging buffer with the old VOF buffer, so a coupled step
+    loops over the cells only once. Without staged VOF the current VOF is
+    copied to the old VOF buffer of the zone, or to UDM_VOF_old without
+    coupling context.
+*/
     #if RP_NODE
     cell_t c;
     Thread *t;
     Thread **pt;
     Domain *domain = Get_Domain(1); 
-    int i;
+    CouplingZone *zone;
+    real vof;
+    real *staged;
+    real *vals;
+    int no_cells;
+    int i, j;
   
-    for (i = 0; i < _g_no_coupled_areas; i++)
+    for (i = 0; i < _g_no_coupling_zone_configs; i++)
     {
-        if (_g_f2a_coupled_properties[i] == VOF)
+        if (_g_coupling_zone_configs[i].f2a_property == VOF)
         {
-            t = Lookup_Thread(domain, _g_cell_zone_id[i]);
+            t = Lookup_Thread(domain, _g_coupling_zone_configs[i].cell_zone_id);
             pt = THREAD_SUB_THREADS(t);
+            no_cells = THREAD_N_ELEMENTS_INT(t);
+            staged = stagedCellValues(t, get_c_vof);
+            zone = (i < _g_coupling_ctx.no_zones && _g_coupling_ctx.zones != NULL) ?
+                   &_g_coupling_ctx.zones[i] : NULL;
+
+            if(zone != NULL && staged != NULL && staged == zone->staged_vof)
+            {
+                /* staged stays valid until clearStagedCellValues() */
+                zone->staged_vof = zone->old_vof;
+                zone->old_vof = staged;
+                j = zone->no_staged_vof;
+                zone->no_staged_vof = zone->no_old_vof;
+                zone->no_old_vof = j;
+                continue;
+            }
+
+            vals = NULL;
+
+            if(zone != NULL)
+            {
+                vals = (real *) realloc(zone->old_vof, (no_cells + 1) * sizeof(real));
+
+                if(vals != NULL)
+                {
+                    zone->old_vof = vals;
+                    zone->no_old_vof = no_cells;
+                }
+                else
+                {
+                    free(zone->old_vof);
+                    zone->old_vof = NULL;
+                    zone->no_old_vof = 0;
+                }
+            }
 
+            j = 0;
             begin_c_loop_int(c, t) 
             {
-                C_UDMI(c,t, UDM_VOF_old) = C_VOF(c,pt[COUPLING_PHASE_FRAC_IDX]);
+                vof = (staged != NULL) ? staged[j] : C_VOF(c,pt[COUPLING_PHASE_FRAC_IDX]);
 
+                if(vals != NULL)
+                {
+                    vals[j] = vof;
+                }
+                else
+                {
+                    C_COUPLING(c,t, UDM_VOF_old) = vof;
+                }
+                ++j;
             }end_c_loop_int(c, t)
         }
     }
@@ -497,37 +777,35 @@ int initNNCouplingOfCellZones()
 {
     int ir;
     int state = _STATE_OK;
+    CouplingZone *zone;
 
-    _g_a2f_mappings_zone_arr = (int **) malloc(_g_no_coupled_areas*sizeof(int *));
-    _g_a2f_weights_zone_arr = (real **) malloc(_g_no_coupled_areas*sizeof(real *));
-    _g_f2a_mappings_zone_arr = (int **) malloc(_g_no_coupled_areas*sizeof(int *));
-    _g_f2a_weights_zone_arr = (real **) malloc(_g_no_coupled_areas*sizeof(real *));
-
-    _g_no_a_elems_zone_arr = (int *) malloc(_g_no_coupled_areas*sizeof(int));
-    _g_no_f_cells_zone_arr = (int *) malloc(_g_no_coupled_areas*sizeof(int));
-
-    _g_f_ordered_cids_zone_arr = (int **) malloc(_g_no_coupled_areas*sizeof(int *));
-    _g_f_ordered_myids_zone_arr = (int **) malloc(_g_no_coupled_areas*sizeof(int *));
-    _g_f_no_cells_per_node_zone_arr = (int **) malloc(_g_no_coupled_areas*sizeof(int *));
+    state = initCouplingContext(
+                            &_g_coupling_ctx,
+                            _g_coupling_zone_configs,
+                            _g_no_coupling_zone_configs
+                            );
+    state = reduceStateOverProcesses(state);
 
-    for(ir = 0; ir < _g_no_coupled_areas; ++ir)
+    for(ir = 0; ir < _g_coupling_ctx.no_zones; ++ir)
     {
+        zone = &_g_coupling_ctx.zones[ir];
+
         if(state != _STATE_ERROR)
         {
             state = initNNCouplingOfCellZone(
-                                        &_g_f2a_mappings_zone_arr[ir],
-                                        &_g_f2a_weights_zone_arr[ir],
-                                        &_g_a2f_mappings_zone_arr[ir],
-                                        &_g_a2f_weights_zone_arr[ir],
-                                        &_g_f_ordered_cids_zone_arr[ir],
-                                        &_g_f_ordered_myids_zone_arr[ir],
-                                        &_g_f_no_cells_per_node_zone_arr[ir],
-                                        &_g_no_a_elems_zone_arr[ir],
-                                        &_g_no_f_cells_zone_arr[ir],
-                                        _g_cell_zone_id[ir],
-                                        _g_a_coupling_files_coords[ir],
-                                        _g_f2a_mapping_files[ir],
-                                        _g_a2f_mapping_files[ir]
+                                        &zone->f2a_mapping,
+                                        &zone->f2a_weights,
+                                        &zone->a2f_mapping,
+                                        &zone->a2f_weights,
+                                        &zone->f_ordered_cids,
+                                        &zone->f_ordered_myids,
+                                        &zone->f_no_cells_per_node,
+                                        &zone->no_a_elems,
+                                        &zone->no_f_cells,
+                                        zone->config.cell_zone_id,
+                                        zone->config.a_coords_file,
+                                        zone->config.f2a_mapping_file,
+                                        zone->config.a2f_mapping_file
                                         );
         }
         else
@@ -537,21 +815,135 @@ int initNNCouplingOfCellZones()
         }
     }
 
-    #if RP_NODE
-    /* not necessary on nodes */
-    free(_g_a2f_mappings_zone_arr);
-    free(_g_a2f_weights_zone_arr);
-    free(_g_f2a_mappings_zone_arr);
-    free(_g_f2a_weights_zone_arr);
-
-    free(_g_no_a_elems_zone_arr);
-    free(_g_no_f_cells_zone_arr);
-
-    free(_g_f_ordered_cids_zone_arr);
-    free(_g_f_ordered_myids_zone_arr);
-    free(_g_f_no_cells_per_node_zone_arr);
+    #if ZONE_COUPLING_STORAGE
+    if(state != _STATE_ERROR)
+    {
+        state = initZoneStorages(
+                            _g_coupling_ctx.cell_zone_ids,
+                            _g_coupling_ctx.no_zones
+                            );
+    }
+    #endif
+
+    #if RP_HOST && (A2F_PIPELINED_EXCHANGE || ANSYS_PARALLEL_PARSE)
+    if(state != _STATE_ERROR)
+    {
+        initThreadPool(VOF_PC_THREAD_POOL_SIZE);
+    }
+    #endif
+
+    #if RP_HOST && COUPLING_TRACE
+    if(state != _STATE_ERROR)
+    {
+        openCouplingTrace(_COUPLING_TRACE_DAT_, _COUPLING_TRACE_INDEX_DAT_);
+    }
+    #endif
+
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(zone->config.a2f_coupling)
+        {
+            state = initScatterPlanOfCellZone(
+                                        &zone->a2f_scatter_plan,
+                                        zone->f_ordered_cids,
+                                        zone->f_ordered_myids,
+                                        zone->f_no_cells_per_node,
+                                        zone->no_f_cells,
+                                        zone->config.cell_zone_id
+                                        );
+        }
+    }
+
+    #if HOST_STREAMING_EXCHANGE || A2F_NODE_MAPPING || NODE_ZERO_IO || A2F_PARALLEL_READ
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(zone->config.a2f_coupling)
+        {
+            state = initA2FStreamPlanOfCellZone(
+                                        &zone->a2f_stream_plan,
+                                        zone->f2a_mapping,
+                                        zone->f_no_cells_per_node,
+                                        zone->no_f_cells,
+                                        zone->no_a_elems,
+                                        zone->config.cell_zone_id
+                                        );
+        }
+    }
+    #endif
+
+    #if F2A_NODE_AGGREGATION
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(zone->config.f2a_coupling)
+        {
+            state = initF2AAggregationPlanOfCellZone(
+                                        &zone->f2a_agg_plan,
+                                        zone->config.f2a_aggregation,
+                                        zone->a2f_mapping,
+                                        zone->f2a_mapping,
+                                        zone->f_ordered_myids,
+                                        zone->f_no_cells_per_node,
+                                        zone->no_f_cells,
+                                        zone->no_a_elems,
+                                        zone->config.cell_zone_id
+                                        );
+
+            zone->f2a_agg_plan.xc_format = zone->config.f2a_xc_format;
+        }
+    }
+    #endif
+
+    #if F2A_PARALLEL_WRITE && F2A_NODE_AGGREGATION
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(
+            zone->config.f2a_coupling &&
+            zone->config.f2a_aggregation == F2A_AGG_PICK
+          )
+        {
+            state = initF2AParallelWritePlanOfCellZone(
+                                        &zone->f2a_pw_plan,
+                                        &zone->f2a_agg_plan,
+                                        zone->config.cell_zone_id
+                                        );
+        }
+    }
+    #endif
+
+    #if NODE_ZERO_IO && F2A_NODE_AGGREGATION
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(zone->config.a2f_coupling || zone->config.f2a_coupling)
+        {
+            state = initNodeZeroIOPlanOfCellZone(
+                                        &zone->node_zero_io_plan,
+                                        zone->config.a2f_coupling ? 
+                                            &zone->a2f_stream_plan : NULL,
+                                        zone->config.f2a_coupling ? 
+                                            &zone->f2a_agg_plan : NULL,
+                                        zone->config.cell_zone_id
+                                        );
+        }
+    }
     #endif
 
+    if(state == _STATE_ERROR)
+    {
+        Message("Error initNNCouplingOfCellZones(): Free coupling context due "
+                "to previous error!\n");
+        freeGlobalArrays();
+    }
+
     return state;
 }
 /* ------------------------------------------------------------------------- */
@@ -665,6 +1057,9 @@ int initNNCouplingOfCellZone(
 
     host_to_node_int_1(state);
 
+    /* the node side of the A2F and F2A plans needs the element count */
+    host_to_node_int_1(*no_a_elems_zone);
+
     if(state != _STATE_ERROR)
     {
         #if RP_HOST
@@ -679,12 +1074,6 @@ int initNNCouplingOfCellZone(
         #endif
     }
 
-    if(state == _STATE_ERROR)
-    {
-        Message("Free globary arrays due to previous error!\n");
-        freeGlobalArrays();
-    }
-
     #if RP_HOST
     if(a_coord_arr != NULL)
     {
@@ -725,68 +1114,170 @@ int exchangeCellZones(int exch_state)
 {
     int state = _STATE_OK;
     int ir;
+    int merged;
+    CouplingZone *zone;
+
+    #if A2F_PARALLEL_READ || NODE_ZERO_IO || HOST_STREAMING_EXCHANGE || A2F_NODE_MAPPING
+    if(exch_state == ANSYS_READY)
+    {
+        return exchangeElemListPropertiesA2FZones();
+    }
+    #elif A2F_PACKED_SCATTER
+    if(exch_state == ANSYS_READY)
+    {
+        return exchangePackedPropertiesA2FZones();
+    }
+    #endif
 
-    for(ir = 0; ir < _g_no_coupled_areas; ++ir)
+    for(ir = 0; ir < _g_coupling_ctx.no_zones; ++ir)
     {   
+        zone = &_g_coupling_ctx.zones[ir];
+        merged = A2F_MERGED_FILE &&
+                 (zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ);
+
         if(
             (exch_state == ANSYS_READY) &&
-            _g_a2f_coupling_for_zone[ir] && 
+            zone->config.a2f_coupling && 
             (state != _STATE_ERROR)
           )
         {
-            if (_g_a2f_coupled_properties[ir] == JOULE_HEAT_PLUS_LORENTZ ||
-                _g_a2f_coupled_properties[ir] == JOULE_HEAT)
+            if (merged)
+            {
+                #if RP_HOST
+                    Message("Exchanging Joule heat and Lorentz-Forces for zone %i\n", zone->config.cell_zone_id);
+                #endif
+                state = exchangeMergedPropertiesA2FZone(
+                                        zone->config.a_merged_file,
+                                        zone->f2a_mapping,
+                                        zone->no_a_elems,
+                                        zone->no_f_cells,
+                                        zone->config.cell_zone_id,
+                                        &zone->a2f_scatter_plan,
+                                        UDM_JH,
+                                        _g_f_lf_udmi_vec,
+                                        A2F_STATIC_ELEM_VOLUMES ?
+                                            &zone->a_static_elem_vols : NULL
+                                        );
+            }
+
+            if (!merged &&
+                (zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ ||
+                 zone->config.a2f_property == JOULE_HEAT))
             {
                 #if RP_HOST
-                    Message("Exchanging Joule heat for zone %i\n", _g_cell_zone_id[ir]);
+                    Message("Exchanging Joule heat for zone %i\n", zone->config.cell_zone_id);
                 #endif
                 state = exchangeVolumetricPropertyA2FZone(                  
-                                        _g_a_vol_val_files_jouleheat[ir],
-                                        _g_f2a_mappings_zone_arr[ir],
-                                        _g_no_a_elems_zone_arr[ir],
-                                        _g_no_f_cells_zone_arr[ir],
-                                        _g_cell_zone_id[ir],
-                                        _g_f_ordered_myids_zone_arr[ir],
-                                        _g_f_ordered_cids_zone_arr[ir],
-                                        _g_f_no_cells_per_node_zone_arr[ir],
-                                        UDM_JH
+                                        zone->config.a_jh_file,
+                                        zone->f2a_mapping,
+                                        zone->no_a_elems,
+                                        zone->no_f_cells,
+                                        zone->config.cell_zone_id,
+                                        &zone->a2f_scatter_plan,
+                                        UDM_JH,
+                                        A2F_STATIC_ELEM_VOLUMES ?
+                                            &zone->a_static_elem_vols : NULL
                                         );
             }
 
-            if (_g_a2f_coupled_properties[ir] == JOULE_HEAT_PLUS_LORENTZ)
+            if (!merged && zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ)
             {
                 #if RP_HOST
-                    Message("Exchanging Lorentz-Forces for zone %i\n", _g_cell_zone_id[ir]);
+                    Message("Exchanging Lorentz-Forces for zone %i\n", zone->config.cell_zone_id);
                 #endif
                 state = exchangeVecPropertyA2FZone(
-                                                _g_a_vec_files_lorentzforce[ir],
-                                                _g_f2a_mappings_zone_arr[ir],
-                                                _g_no_a_elems_zone_arr[ir],
-                                                _g_no_f_cells_zone_arr[ir],
-                                                _g_cell_zone_id[ir],
-                                                _g_f_ordered_myids_zone_arr[ir],
-                                                _g_f_ordered_cids_zone_arr[ir],
-                                                _g_f_no_cells_per_node_zone_arr[ir],
+                                                zone->config.a_lf_file,
+                                                zone->f2a_mapping,
+                                                zone->no_a_elems,
+                                                zone->no_f_cells,
+                                                zone->config.cell_zone_id,
+                                                &zone->a2f_scatter_plan,
                                                 _g_f_lf_udmi_vec
                                                     );
             }
         }
         if(
             (exch_state == FLUENT_READY) &&
-            _g_f2a_coupling_for_zone[ir] && 
+            zone->config.f2a_coupling && 
             (state != _STATE_ERROR)
            )
         {
-            if (_g_f2a_coupled_properties[ir] == VOF)
+            if (zone->config.f2a_property == VOF)
             {
+                #if F2A_NODE_AGGREGATION && F2A_PARALLEL_WRITE
+                if(zone->config.f2a_aggregation == F2A_AGG_PICK)
+                {
+                    state = exchangeParallelWrittenPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->f2a_pw_plan,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                }
+                else
+                {
+                    #if NODE_ZERO_IO
+                    state = exchangeNodeZeroAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->node_zero_io_plan,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                    #else
+                    state = exchangeAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                    #endif
+                }
+                #elif F2A_NODE_AGGREGATION && NODE_ZERO_IO
+                state = exchangeNodeZeroAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->node_zero_io_plan,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                #elif F2A_NODE_AGGREGATION && HOST_STREAMING_EXCHANGE
+                if(zone->config.f2a_aggregation == F2A_AGG_PICK)
+                {
+                    state = exchangeStreamedAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                }
+                else
+                {
+                    state = exchangeAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                }
+                #elif F2A_NODE_AGGREGATION
+                state = exchangeAggregatedPropertyF2AZone(
+                                                        zone->config.f2a_file,
+                                                        &zone->f2a_agg_plan,
+                                                        get_c_vof,
+                                                        zone->config.cell_zone_id
+                                                        );
+                #else
                 state = exchangeVolumetricPropertyF2AZone(
-                                                        _g_f2a_files[ir],
-                                                       _g_a2f_mappings_zone_arr[ir],
-                                                        _g_no_f_cells_zone_arr[ir],
-                                                        _g_no_a_elems_zone_arr[ir],
+                                                        zone->config.f2a_file,
+                                                       zone->a2f_mapping,
+                                                        zone->no_f_cells,
+                                                        zone->no_a_elems,
                                                         get_c_vof,
-                                                        _g_cell_zone_id[ir]
+                                                        zone->config.cell_zone_id
                                                             );
+                #endif
             }
         }
     }
@@ -796,29 +1287,452 @@ int exchangeCellZones(int exch_state)
 
 /* ------------------------------------------------------------------------- */
 
-int exchangeVolumetricPropertyA2FZone(
-                                        char ansys_vol_prop_file[],
-                                        int *f2a_mapping_zone,
-                                        int no_a_elems_zone,
-                                        int no_f_cells_zone,
-                                        int fluid_zone_id,
-                                        int *f_compute_node_id_arr_full,
-                                        int *f_cell_id_arr_full,
-                                        int *f_cells_per_node,
-                                        int udmi_idx
-                                        )
+int exchangeElemListPropertiesA2FZones()
 {
+    /* Exchanges Joule heat and Lorentz forces of all A2F coupled zones with 
+    the element lists of the compute nodes (A2FStreamPlan), either in chunks 
+    of ANSYS elements (HOST_STREAMING_EXCHANGE, see 
+    exchangeStreamedPropertiesA2FZone()), mapped on the nodes 
+    (A2F_NODE_MAPPING, see exchangeNodeMappedPropertiesA2FZone()), read on 
+    compute node 0 (NODE_ZERO_IO, see exchangeNodeZeroPropertiesA2FZone()) or 
+    read on all compute nodes (A2F_PARALLEL_READ, see 
+    exchangeParallelReadPropertiesA2FZone()). The Joule heat is corrected with 
+    the sum returned by the host
+    */
     int state = _STATE_OK;
-    real *vol_prop_to_fluent = NULL;
+    int ir, i;
+    int no_fields;
+    int udmi_idx[1 + ND_ND];
+    real a_vol_weighted_prop_sum = 0;
+    CouplingZone *zone;
 
-    real *vol_prop_from_ansys = NULL;
-    real *elem_vol_from_ansys = NULL;
+    udmi_idx[0] = UDM_JH;
+    for(i = 0; i < ND_ND; ++i)
+    {
+        udmi_idx[1 + i] = _g_f_lf_udmi_vec[i];
+    }
+
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(
+            !zone->config.a2f_coupling ||
+            (zone->config.a2f_property != JOULE_HEAT_PLUS_LORENTZ &&
+             zone->config.a2f_property != JOULE_HEAT)
+          )
+        {
+            continue;
+        }
+
+        no_fields = (zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ) ?
+                        1 + ND_ND : 1;
+
+        #if RP_HOST
+        Message("Exchanging Joule heat %sfor zone %i\n", 
+                (no_fields > 1) ? "and Lorentz-Forces " : "", 
+                zone->config.cell_zone_id);
+        #endif
+
+        #if A2F_PARALLEL_READ
+        state = exchangeParallelReadPropertiesA2FZone(
+                                            &zone->a2f_stream_plan,
+                                            zone->config.a_jh_file,
+                                            zone->config.a_lf_file,
+                                            no_fields,
+                                            udmi_idx,
+                                            &a_vol_weighted_prop_sum,
+                                            zone->config.cell_zone_id
+                                            );
+        #elif NODE_ZERO_IO
+        state = exchangeNodeZeroPropertiesA2FZone(
+                                            &zone->node_zero_io_plan,
+                                            &zone->a2f_stream_plan,
+                                            zone->config.a_jh_file,
+                                            zone->config.a_lf_file,
+                                            no_fields,
+                                            udmi_idx,
+                                            &a_vol_weighted_prop_sum,
+                                            zone->config.cell_zone_id
+                                            );
+        #elif HOST_STREAMING_EXCHANGE
+        state = exchangeStreamedPropertiesA2FZone(
+                                            &zone->a2f_stream_plan,
+                                            zone->config.a_jh_file,
+                                            zone->config.a_lf_file,
+                                            no_fields,
+                                            udmi_idx,
+                                            &a_vol_weighted_prop_sum,
+                                            zone->config.cell_zone_id
+                                            );
+        #else
+        state = exchangeNodeMappedPropertiesA2FZone(
+                                            &zone->a2f_stream_plan,
+                                            zone->config.a_jh_file,
+                                            zone->config.a_lf_file,
+                                            no_fields,
+                                            udmi_idx,
+                                            &a_vol_weighted_prop_sum,
+                                            zone->config.cell_zone_id
+                                            );
+        #endif
+
+        if(state != _STATE_ERROR)
+        {
+            correctVolumetricPropertyA2FWithSum(
+                                            a_vol_weighted_prop_sum,
+                                            zone->config.cell_zone_id,
+                                            UDM_JH
+                                            );
+        }
+    }
+
+    return state;
+}
+
+/* ------------------------------------------------------------------------- */
+
+#if RP_HOST
+static int readElemValueAndStaticVolume(
+                                        char filename[],
+                                        real **e_prop,
+                                        real **e_vol,
+                                        real **static_e_vol,
+                                        int no_e
+                                        )
+{
+    /* As readElemValueAndVolumeFromAnsysOut(), with static_e_vol the volumes 
+    are only read from the first file and then kept in *static_e_vol (*e_vol 
+    is NULL), all later files only need to hold the value column
+    */
+    int state = _STATE_OK;
+
+    if(static_e_vol != NULL && (*static_e_vol) != NULL)
+    {
+        (*e_vol) = NULL;
+
+        return readElemValueAndVolumeFromAnsysOut(filename, e_prop, NULL, no_e);
+    }
+
+    state = readElemValueAndVolumeFromAnsysOut(filename, e_prop, e_vol, no_e);
+
+    if(state != _STATE_ERROR && static_e_vol != NULL)
+    {
+        (*static_e_vol) = (*e_vol);
+        (*e_vol) = NULL;
+    }
+
+    return state;
+}
+
+
+static int readMergedElemValuesAndStaticVolume(
+                                        char filename[],
+                                        const int columns[],
+                                        int no_cols,
+                                        real **e_prop,
+                                        real **e_vol,
+                                        real (**e_vec_prop)[ND_ND],
+                                        real **static_e_vol,
+                                        int no_e
+                                        )
+{
+    /* As readMergedElemValuesFromAnsysOut(), with static_e_vol the volumes 
+    are kept as in readElemValueAndStaticVolume()
+    */
+    int state = _STATE_OK;
+
+    if(static_e_vol != NULL && (*static_e_vol) != NULL)
+    {
+        (*e_vol) = NULL;
+
+        return readMergedElemValuesFromAnsysOut(filename, columns, no_cols,
+                                                e_prop, NULL, e_vec_prop, no_e);
+    }
+
+    state = readMergedElemValuesFromAnsysOut(filename, columns, no_cols, e_prop,
+                                             e_vol, e_vec_prop, no_e);
+
+    if(state != _STATE_ERROR && static_e_vol != NULL)
+    {
+        (*static_e_vol) = (*e_vol);
+        (*e_vol) = NULL;
+    }
+
+    return state;
+}
+
+
+typedef struct a2f_read_task_struct
+{
+    char *filename;
+    int no_a_elems;
+    real **vals;
+    real **vols;
+    real (**vecs)[ND_ND];
+    real **static_vols; /* A2F_STATIC_ELEM_VOLUMES */
+    const int *columns; /* merged file, see readMergedElemValuesFromAnsysOut() */
+    int no_cols;
+    int state;
+} A2FReadTask;
+
+
+static void readA2FFileTask(void *arg)
+{
+    /* Reads one ANSYS result file, may run on a thread of the pool */
+    A2FReadTask *task = (A2FReadTask *) arg;
+
+    if(task->columns != NULL)
+    {
+        task->state = readMergedElemValuesAndStaticVolume(
+                                                task->filename,
+                                                task->columns,
+                                                task->no_cols,
+                                                task->vals,
+                                                task->vols,
+                                                task->vecs,
+                                                task->static_vols,
+                                                task->no_a_elems
+                                                );
+    }
+    else if(task->vecs != NULL)
+    {
+        task->state = readElemValueVecFromAnsysOut(
+                                                task->filename,
+                                                task->vecs,
+                                                task->no_a_elems
+                                                );
+    }
+    else
+    {
+        task->state = readElemValueAndStaticVolume(
+                                                task->filename,
+                                                task->vals,
+                                                task->vols,
+                                                task->static_vols,
+                                                task->no_a_elems
+                                                );
+    }
+}
+#endif
+
+/* ------------------------------------------------------------------------- */
+
+int exchangePackedPropertiesA2FZones()
+{
+    /* Exchanges Joule heat and Lorentz forces of all A2F coupled zones with 
+    one packed message per compute node (see 
+    distributePackedZonesToNodesWithScatterPlans()), the Joule heat is 
+    corrected afterwards for each zone as in exchangeVolumetricPropertyA2FZone()
+    With A2F_PIPELINED_EXCHANGE all ANSYS files are parsed concurrently on the 
+    thread pool.
+    */
+    int state = _STATE_OK;
+    int ir, i;
+    int no_zones = 0;
+    CouplingZone *zone;
+    PackedScatterZone *packed_zones = _g_coupling_ctx.packed_zones;
+    int *packed_zone_ir = _g_coupling_ctx.packed_zone_idx;
+
+    #if RP_HOST
+    A2FReadTask *read_tasks = NULL;
+    int no_read_tasks = 0;
+    int k;
+    ThreadTaskGroup read_group;
+
+    initThreadTaskGroup(&read_group);
+
+    read_tasks = (A2FReadTask *) calloc(2 * _g_coupling_ctx.no_zones + 1, 
+                                        sizeof(A2FReadTask));
+
+    if(read_tasks == NULL)
+    {
+        Message("Error (exchangePackedPropertiesA2FZones()): Memory "
+                "allocation error!\n");
+        state = _STATE_ERROR;
+    }
+    #endif
+
+    memset(packed_zones, 0, 
+           _g_coupling_ctx.no_zones * sizeof(PackedScatterZone));
+
+    for(ir = 0; ir < _g_coupling_ctx.no_zones && state != _STATE_ERROR; ++ir)
+    {
+        zone = &_g_coupling_ctx.zones[ir];
+
+        if(
+            !zone->config.a2f_coupling ||
+            (zone->config.a2f_property != JOULE_HEAT_PLUS_LORENTZ &&
+             zone->config.a2f_property != JOULE_HEAT)
+          )
+        {
+            continue;
+        }
+
+        packed_zone_ir[no_zones] = ir;
+        packed_zones[no_zones].fluid_zone_id = zone->config.cell_zone_id;
+        packed_zones[no_zones].plan = &zone->a2f_scatter_plan;
+        packed_zones[no_zones].no_fields = 1;
+        packed_zones[no_zones].udmi_idx[0] = UDM_JH;
+
+        if (zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ)
+        {
+            packed_zones[no_zones].no_fields = 1 + ND_ND;
+
+            for(i = 0; i < ND_ND; ++i)
+            {
+                packed_zones[no_zones].udmi_idx[1 + i] = _g_f_lf_udmi_vec[i];
+            }
+        }
+
+        #if RP_HOST
+        read_tasks[no_read_tasks].filename = zone->config.a_jh_file;
+        read_tasks[no_read_tasks].no_a_elems = zone->no_a_elems;
+        read_tasks[no_read_tasks].vals = &zone->a_vol_vals;
+        read_tasks[no_read_tasks].vols = &zone->a_elem_vols;
+        read_tasks[no_read_tasks].vecs = NULL;
+        #if A2F_STATIC_ELEM_VOLUMES
+        read_tasks[no_read_tasks].static_vols = &zone->a_static_elem_vols;
+        #endif
+        #if A2F_MERGED_FILE
+        if (zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ)
+        {
+            read_tasks[no_read_tasks].filename = zone->config.a_merged_file;
+            read_tasks[no_read_tasks].vecs = &zone->a_vec_vals;
+            read_tasks[no_read_tasks].columns = _g_a2f_merged_columns;
+            read_tasks[no_read_tasks].no_cols = _g_a2f_no_merged_columns;
+        }
+        #endif
+        read_tasks[no_read_tasks].state = _STATE_ERROR;
+        ++no_read_tasks;
+
+        if (!A2F_MERGED_FILE &&
+            zone->config.a2f_property == JOULE_HEAT_PLUS_LORENTZ)
+        {
+            read_tasks[no_read_tasks].filename = zone->config.a_lf_file;
+            read_tasks[no_read_tasks].no_a_elems = zone->no_a_elems;
+            read_tasks[no_read_tasks].vals = NULL;
+            read_tasks[no_read_tasks].vols = NULL;
+            read_tasks[no_read_tasks].vecs = &zone->a_vec_vals;
+            read_tasks[no_read_tasks].state = _STATE_ERROR;
+            ++no_read_tasks;
+        }
+        #endif
+
+        ++no_zones;
+    }
 
     #if RP_HOST
-    state = readElemValueAndVolumeFromAnsysOut(
+    Message("Reading ANSYS results of %i zones\n", no_zones);
+
+    for(i = 0; i < no_read_tasks; ++i)
+    {
+        submitThreadTask(&read_group, readA2FFileTask, &read_tasks[i]);
+    }
+    waitThreadTaskGroup(&read_group);
+
+    for(i = 0; i < no_read_tasks; ++i)
+    {
+        if(read_tasks[i].state == _STATE_ERROR)
+        {
+            Message("Error (exchangePackedPropertiesA2FZones()): Reading %s "
+                    "failed!\n", read_tasks[i].filename);
+            state = _STATE_ERROR;
+        }
+    }
+
+    free(read_tasks);
+
+    for(i = 0; i < no_zones && state != _STATE_ERROR; ++i)
+    {
+        zone = &_g_coupling_ctx.zones[packed_zone_ir[i]];
+
+        packed_zones[i].src[0] = zone->a_vol_vals;
+        packed_zones[i].src_stride[0] = 1;
+
+        for(k = 1; k < packed_zones[i].no_fields; ++k)
+        {
+            packed_zones[i].src[k] = &zone->a_vec_vals[0][k - 1];
+            packed_zones[i].src_stride[k] = ND_ND;
+        }
+
+        packed_zones[i].f2a_mapping = zone->f2a_mapping;
+        packed_zones[i].no_f_cells = zone->no_f_cells;
+        packed_zones[i].no_a_elems = zone->no_a_elems;
+    }
+    #endif
+
+    host_to_node_int_2(state, no_zones);
+
+    if(state != _STATE_ERROR && no_zones > 0)
+    {
+        state = distributePackedZonesToNodesWithScatterPlans(
+                                                            packed_zones,
+                                                            no_zones
+                                                            );
+    }
+
+    for(i = 0; i < no_zones && state != _STATE_ERROR; ++i)
+    {
+        ir = packed_zone_ir[i];
+        zone = &_g_coupling_ctx.zones[ir];
+
+        #if RP_HOST && COUPLING_TRACE
+        traceRecordField(zone->config.cell_zone_id, TRACE_JH_IN, zone->a_vol_vals, 1,
+                         zone->no_a_elems);
+        if(packed_zones[i].no_fields > 1)
+        {
+            traceRecordField(zone->config.cell_zone_id, TRACE_LF_IN,
+                             (real *) zone->a_vec_vals, ND_ND, zone->no_a_elems);
+        }
+        #endif
+
+        correctVolumetricPropertyA2F(   
+                                    zone->a_vol_vals,
+                                    (zone->a_elem_vols != NULL) ?
+                                        zone->a_elem_vols : zone->a_static_elem_vols,
+                                    zone->no_a_elems,
+                                    zone->config.cell_zone_id,
+                                    UDM_JH
+                                    );
+    }
+
+    for(ir = 0; ir < _g_coupling_ctx.no_zones; ++ir)
+    {
+        freeCouplingZoneA2FResults(&_g_coupling_ctx.zones[ir]);
+    }
+
+    return state;
+}
+
+/* ------------------------------------------------------------------------- */
+
+int exchangeVolumetricPropertyA2FZone(
+                                        char ansys_vol_prop_file[],
+                                        int *f2a_mapping_zone,
+                                        int no_a_elems_zone,
+                                        int no_f_cells_zone,
+                                        int fluid_zone_id,
+                                        ScatterPlan *scatter_plan,
+                                        int udmi_idx,
+                                        real **static_elem_vols
+                                        )
+{
+    /* With static_elem_vols the element volumes are kept from the first 
+    file (see readElemValueAndStaticVolume())
+    */
+    int state = _STATE_OK;
+    real *vol_prop_to_fluent = NULL;
+
+    real *vol_prop_from_ansys = NULL;
+    real *elem_vol_from_ansys = NULL;
+
+    #if RP_HOST
+    state = readElemValueAndStaticVolume(
                                             ansys_vol_prop_file,
                                             &vol_prop_from_ansys,
                                             &elem_vol_from_ansys,
+                                            static_elem_vols,
                                             no_a_elems_zone
                                         );
     if(state != _STATE_ERROR )
@@ -857,22 +1771,26 @@ int exchangeVolumetricPropertyA2FZone(
 
     if(state != _STATE_ERROR)
     {
-        state = safeDistributeMappedArrayToNodesInCellZone(
+        state = distributeArrayToNodesWithScatterPlan(
                                                 vol_prop_to_fluent,
                                                 no_f_cells_zone,
                                                 udmi_idx,
-                                                f_compute_node_id_arr_full,
-                                                f_cell_id_arr_full,
-                                                f_cells_per_node,
+                                                scatter_plan,
                                                 fluid_zone_id
                                                 );
     }
 
     if(state != _STATE_ERROR)
     {
+        #if RP_HOST && COUPLING_TRACE
+        traceRecordField(fluid_zone_id, TRACE_JH_IN, vol_prop_from_ansys, 1,
+                         no_a_elems_zone);
+        #endif
+
         correctVolumetricPropertyA2F(   
                                     vol_prop_from_ansys,
-                                    elem_vol_from_ansys,
+                                    (static_elem_vols != NULL) ?
+                                        (*static_elem_vols) : elem_vol_from_ansys,
                                     no_a_elems_zone,
                                     fluid_zone_id,
                                     udmi_idx
@@ -906,9 +1824,7 @@ int exchangeVecPropertyA2FZone(
                                 int no_a_elems_zone,
                                 int no_f_cells_zone,
                                 int fluid_zone_id,
-                                int *f_compute_node_id_arr_full,
-                                int *f_cell_id_arr_full,
-                                int *f_cells_per_node,
+                                ScatterPlan *scatter_plan,
                                 const int udmis_vec[ND_ND]
                                 )
 {
@@ -989,13 +1905,11 @@ int exchangeVecPropertyA2FZone(
 
                 if(state != _STATE_ERROR)
                 { 
-                    state = safeDistributeMappedArrayToNodesInCellZone(
+                    state = distributeArrayToNodesWithScatterPlan(
                                                 tmp_1D_prop_to_fluent,
                                                 no_f_cells_zone,
                                                 udmis_vec[i],
-                                                f_compute_node_id_arr_full,
-                                                f_cell_id_arr_full,
-                                                f_cells_per_node,
+                                                scatter_plan,
                                                 fluid_zone_id
                                                                     );
                 }
@@ -1009,6 +1923,14 @@ int exchangeVecPropertyA2FZone(
         }
     }
 
+    #if RP_HOST && COUPLING_TRACE
+    if(state != _STATE_ERROR)
+    {
+        traceRecordField(fluid_zone_id, TRACE_LF_IN, (real *) vec_prop_from_ansys,
+                         ND_ND, no_a_elems_zone);
+    }
+    #endif
+
     #if RP_HOST
     if(vec_prop_from_ansys != NULL)
     {
@@ -1024,6 +1946,145 @@ int exchangeVecPropertyA2FZone(
     return state;
 }
 
+
+
+int exchangeMergedPropertiesA2FZone(
+                                    char ansys_merged_file[],
+                                    int *f2a_mapping_zone,
+                                    int no_a_elems_zone,
+                                    int no_f_cells_zone,
+                                    int fluid_zone_id,
+                                    ScatterPlan *scatter_plan,
+                                    int udmi_idx,
+                                    const int udmis_vec[ND_ND],
+                                    real **static_elem_vols
+                                    )
+{
+    /* Exchanges the volumetric property (udmi_idx) and the vector property 
+    (udmis_vec) of one zone from the merged file ansys_merged_file, which is 
+    read in one pass (see readMergedElemValuesFromAnsysOut()). Otherwise as 
+    exchangeVolumetricPropertyA2FZone() and exchangeVecPropertyA2FZone(), 
+    also with static_elem_vols
+    */
+    int state = _STATE_OK;
+    real *prop_to_fluent = NULL;
+    real *vol_prop_from_ansys = NULL;
+    real *elem_vol_from_ansys = NULL;
+    real (*vec_prop_from_ansys)[ND_ND] = NULL;
+    real (*vec_prop_to_fluent)[ND_ND] = NULL;
+    int i;
+    #if RP_HOST
+    int j;
+    #endif
+
+    #if RP_HOST
+    state = readMergedElemValuesAndStaticVolume(
+                                            ansys_merged_file,
+                                            _g_a2f_merged_columns,
+                                            _g_a2f_no_merged_columns,
+                                            &vol_prop_from_ansys,
+                                            &elem_vol_from_ansys,
+                                            &vec_prop_from_ansys,
+                                            static_elem_vols,
+                                            no_a_elems_zone
+                                            );
+
+    if(state != _STATE_ERROR)
+    {
+        prop_to_fluent = (real *) calloc(no_f_cells_zone, sizeof(real));
+        vec_prop_to_fluent = (real (*)[ND_ND]) 
+                            calloc(ND_ND * no_f_cells_zone, sizeof(real));
+
+        if(prop_to_fluent != NULL && vec_prop_to_fluent != NULL)
+        {
+            state = reorderRealND_ND_Arr(
+                                    vec_prop_from_ansys,
+                                    no_a_elems_zone,
+                                    f2a_mapping_zone,
+                                    vec_prop_to_fluent,
+                                    no_f_cells_zone
+                                );
+        }
+        else
+        {
+            Message("Error exchangeMergedPropertiesA2FZone(): memory "
+                    "allocation!\n");
+            state = _STATE_ERROR;
+        }
+    }
+    else
+    {
+        Message("Error reading %s in readMergedElemValuesFromAnsysOut()!\n",
+                ansys_merged_file);
+    }
+    #endif
+
+    host_to_node_int_1(state);
+
+    for(i = 0; i < 1 + ND_ND && state != _STATE_ERROR; ++i)
+    {
+        #if RP_HOST
+        if(i == 0)
+        {
+            state = reorderRealArr(
+                                    vol_prop_from_ansys,
+                                    no_a_elems_zone,
+                                    f2a_mapping_zone,
+                                    prop_to_fluent,
+                                    no_f_cells_zone
+                                  );
+        }
+        else
+        {
+            for(j = 0; j < no_f_cells_zone; ++j)
+            {
+                prop_to_fluent[j] = vec_prop_to_fluent[j][i - 1];
+            }
+        }
+        #endif
+
+        host_to_node_int_1(state);
+
+        if(state != _STATE_ERROR)
+        {
+            state = distributeArrayToNodesWithScatterPlan(
+                                            prop_to_fluent,
+                                            no_f_cells_zone,
+                                            (i == 0) ? udmi_idx : udmis_vec[i - 1],
+                                            scatter_plan,
+                                            fluid_zone_id
+                                            );
+        }
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        #if RP_HOST && COUPLING_TRACE
+        traceRecordField(fluid_zone_id, TRACE_JH_IN, vol_prop_from_ansys, 1,
+                         no_a_elems_zone);
+        traceRecordField(fluid_zone_id, TRACE_LF_IN, (real *) vec_prop_from_ansys,
+                         ND_ND, no_a_elems_zone);
+        #endif
+
+        correctVolumetricPropertyA2F(
+                                    vol_prop_from_ansys,
+                                    (static_elem_vols != NULL) ?
+                                        (*static_elem_vols) : elem_vol_from_ansys,
+                                    no_a_elems_zone,
+                                    fluid_zone_id,
+                                    udmi_idx
+                                    );
+    }
+
+    free(vol_prop_from_ansys);
+    free(elem_vol_from_ansys);
+    free(vec_prop_from_ansys);
+    free(prop_to_fluent);
+    free(vec_prop_to_fluent);
+
+    return state;
+}
+
 int exchangeVolumetricPropertyF2AZone(  
                                     char f2a_vol_prop_file[],
                                     int *a2f_mapping_zone,
@@ -1097,8 +2158,29 @@ void correctVolumetricPropertyA2F(
 
     #if RP_HOST
     int i = 0;
+
+    for(i=0;i<a_e_count;++i)
+    {   
+        a_vol_weighted_prop_sum = a_vol_weighted_prop_sum + a_e_prop[i]*a_e_vol[i];
+    }
     #endif
 
+    correctVolumetricPropertyA2FWithSum(
+                                    a_vol_weighted_prop_sum,
+                                    fluid_zone_id,
+                                    udmi_idx
+                                    );
+}
+
+void correctVolumetricPropertyA2FWithSum(
+                                    real a_vol_weighted_prop_sum,
+                                    int fluid_zone_id,
+                                    int udmi_idx
+                                )
+{
+    /* Correction of conservative property with the volume weighted sum of 
+    the ANSYS elements (host)
+    */
     #if RP_NODE
     real f_vol_weighted_prop_sum = 0;
     real corr_fac = 0;
@@ -1109,10 +2191,6 @@ void correctVolumetricPropertyA2F(
     #endif
 
     #if RP_HOST
-    for(i=0;i<a_e_count;++i)
-    {   
-        a_vol_weighted_prop_sum = a_vol_weighted_prop_sum + a_e_prop[i]*a_e_vol[i];
-    }
     Message("Host: Ansys sent heat: %lf W\n", a_vol_weighted_prop_sum);
     #endif
 
@@ -1123,7 +2201,7 @@ void correctVolumetricPropertyA2F(
 
     begin_c_loop_int(c, t) 
     {
-        f_vol_weighted_prop_sum += C_UDMI(c,t, udmi_idx)*C_VOLUME(c,t);
+        f_vol_weighted_prop_sum += C_COUPLING(c,t, udmi_idx)*C_VOLUME(c,t);
     }end_c_loop_int(c, t)
 
     f_vol_weighted_prop_sum = PRF_GRSUM1(f_vol_weighted_prop_sum);
@@ -1135,28 +2213,86 @@ void correctVolumetricPropertyA2F(
 
     begin_c_loop_int(c, t) 
     {
-        C_UDMI(c,t, udmi_idx) = corr_fac * C_UDMI(c,t, udmi_idx);
+        C_COUPLING(c,t, udmi_idx) = corr_fac * C_COUPLING(c,t, udmi_idx);
     }end_c_loop_int(c, t)
     #endif
 }
 /* ------------------------------------------------------------------------- */
 
 
+void recordAnsysOutputsOfZones(int coords)
+{
+    /*
+        With XC_RECORDING copies the coordinate files (coords) or the A2F
+        files ANSYS has written for the coupled zones into the recording.
+        Host only!
+    */
+    #if RP_HOST && XC_RECORDING
+    int ir;
+
+    for(ir = 0; ir < _g_no_coupling_zone_configs; ++ir)
+    {
+        if(coords)
+        {
+            xcRecordFile(_g_coupling_zone_configs[ir].a_coords_file);
+        }
+        else if(!_g_coupling_zone_configs[ir].a2f_coupling)
+        {
+            continue;
+        }
+        else if(
+                A2F_MERGED_FILE &&
+                _g_coupling_zone_configs[ir].a2f_property == JOULE_HEAT_PLUS_LORENTZ
+               )
+        {
+            xcRecordFile(_g_coupling_zone_configs[ir].a_merged_file);
+        }
+        else
+        {
+            xcRecordFile(_g_coupling_zone_configs[ir].a_jh_file);
+
+            if(_g_coupling_zone_configs[ir].a2f_property == JOULE_HEAT_PLUS_LORENTZ)
+            {
+                xcRecordFile(_g_coupling_zone_configs[ir].a_lf_file);
+            }
+        }
+    }
+    #endif
+}
+/* ------------------------------------------------------------------------- */
+
+
+
 int strictCoupling()
 {
     int state = _STATE_OK;
 
+    #if RP_HOST && COUPLING_TRACE
+    traceNextStep();
+    #endif
+
     if(state != _STATE_ERROR)
     {
         state = exchangeCellZones(FLUENT_READY);
     }
 
-    #if RP_HOST
+    #if NODE_ZERO_IO
+    /* wait for ansys on node 0 */
+    if(state != _STATE_ERROR)
+    {
+         state = syncWaitForCouplingOnNodeZero(_SYNC_DAT_);
+    }
+    #elif RP_HOST
     /* wait for ansys */
     if(state != _STATE_ERROR)
     {
          state = sync_wait_for_coupling(_SYNC_DAT_);
     }
+    /* only _STATE_OK means ANSYS_READY was read, not a timeout */
+    if(state == _STATE_OK)
+    {
+         recordAnsysOutputsOfZones(0);
+    }
     #endif /*RP_HOST*/ 
 
     if(state != _STATE_ERROR)
@@ -1193,12 +2329,15 @@ int hostWriteDebugCoords(
 int state = _STATE_OK;
 
 #if RP_HOST
-FILE *fp = NULL;
+TextWriter writer;
 int i = 0;
+int k = 0;
+/* 3D double precision coordinates are written as % #15.7E */
+const int exp_format = RP_3D && !IS_SINGLE_PRECISION;
 
-if ((fp = fopen(filename, "w")) == NULL)
+if (openTextWriter(&writer, filename) != _STATE_OK)
 {
-    Message("Error (hostWriteDebugField()): Unable to open %s for writing!\n"
+    threadMessage("Error (hostWriteDebugField()): Unable to open %s for writing!\n"
                 , filename);
     state = _STATE_ERROR;
 }
@@ -1209,47 +2348,41 @@ else
         if ( cell_id_arr_full == NULL 
             || coord_arr_full == NULL || compute_node_id_arr_full == NULL)
         {
-            Message("Error (hostWriteDebugField()): Can not export empty arrays!\n"
+            threadMessage("Error (hostWriteDebugField()): Can not export empty arrays!\n"
                         , filename);
             state = _STATE_ERROR;
         }
         else
         {
-            #if RP_3D
-            for (i = 0; i < arr_full_size; ++i)
-            {
-                if(IS_SINGLE_PRECISION)
-                    fprintf(fp, "%i %i %f %f %f\n", cell_id_arr_full[i],
-                             compute_node_id_arr_full[i],  
-                             coord_arr_full[i][0], coord_arr_full[i][1], 
-                             coord_arr_full[i][2]);
-                else
-                    fprintf(fp, "%i %2i % #15.7lE % #15.7lE % #15.7lE\n", cell_id_arr_full[i], 
-                            compute_node_id_arr_full[i], 
-                            coord_arr_full[i][0], coord_arr_full[i][1], 
-                            coord_arr_full[i][2]);
-            }
-            #else
             for (i = 0; i < arr_full_size; ++i)
             {
-                if(IS_SINGLE_PRECISION)
-                    fprintf(fp, "%i %i %f %f\n", cell_id_arr_full[i], 
-                             compute_node_id_arr_full[i],  
-                             coord_arr_full[i][0], coord_arr_full[i][1]);
-                else
-                    fprintf(fp, "%i %i %lf %lf\n", cell_id_arr_full[i], 
-                             compute_node_id_arr_full[i], 
-                             coord_arr_full[i][0], coord_arr_full[i][1]);
+                writeTextInt(&writer, cell_id_arr_full[i], 0);
+                writeTextChar(&writer, ' ');
+                writeTextInt(&writer, compute_node_id_arr_full[i], 
+                             exp_format ? 2 : 0);
+
+                for (k = 0; k < ND_ND; ++k)
+                {
+                    writeTextChar(&writer, ' ');
+
+                    if(exp_format)
+                        writeTextExp(&writer, coord_arr_full[i][k], 15, 7, 1);
+                    else
+                        writeTextFixed(&writer, coord_arr_full[i][k], 0, 6);
+                }
+                writeTextChar(&writer, '\n');
             }
-            #endif /* RP_3D */
         }
     }
     else
     {
-        Message("Warning (hostWriteDebugField()): Array sizes are zero!\n");
+        threadMessage("Warning (hostWriteDebugField()): Array sizes are zero!\n");
+        state = _STATE_ERROR;
+    }
+    if(closeTextWriter(&writer) != _STATE_OK)
+    {
         state = _STATE_ERROR;
     }
-    fclose(fp);
 }
 #endif
 
@@ -1259,104 +2392,17 @@ return state;
 
 void freeGlobalArrays()
 {
-    int ir = 0;
+    freeCouplingContext(&_g_coupling_ctx);
 
-    #if RP_HOST
-    if (_g_f2a_mappings_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_f2a_mappings_zone_arr[ir] != NULL)
-            {
-                free(_g_f2a_mappings_zone_arr[ir]);
-            }
-        }
-        free(_g_f2a_mappings_zone_arr);
-    }
+    freeZoneStorages();
 
-    if (_g_f2a_weights_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_f2a_weights_zone_arr[ir] != NULL)
-            {
-                free(_g_f2a_weights_zone_arr[ir]);
-            }
-        }
-        free(_g_f2a_weights_zone_arr);
-    }
-
-    if (_g_a2f_mappings_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_a2f_mappings_zone_arr[ir] != NULL)
-            {
-                free(_g_a2f_mappings_zone_arr[ir]);
-            }
-        }
-        free(_g_a2f_mappings_zone_arr);
-    }
-
-    if (_g_a2f_weights_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_a2f_weights_zone_arr[ir] != NULL)
-            {
-                free(_g_a2f_weights_zone_arr[ir]);
-            }
-        }
-        free(_g_a2f_weights_zone_arr);
-    }
+    #if RP_HOST
+    closeCouplingTrace();
+    closeXCRecording();
+    freeBackgroundWriter();
+    freeThreadPool();
     #endif
 
-    if (_g_f_no_cells_per_node_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_f_no_cells_per_node_zone_arr[ir] != NULL)
-            {
-                free(_g_f_no_cells_per_node_zone_arr[ir]);
-            }
-        }
-        free(_g_f_no_cells_per_node_zone_arr);
-    }
-    
-    if (_g_f_ordered_cids_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_f_ordered_cids_zone_arr[ir] != NULL)
-            {
-                free(_g_f_ordered_cids_zone_arr[ir]);
-            }
-        }
-        free(_g_f_ordered_cids_zone_arr);
-    }
-    
-    if (_g_f_ordered_myids_zone_arr != NULL)
-    {
-        for(ir=0; ir<_g_no_coupled_areas; ++ir)
-        {
-            if(_g_f_ordered_myids_zone_arr[ir] != NULL)
-            {
-                free(_g_f_ordered_myids_zone_arr[ir]);
-            }
-        }
-        free(_g_f_ordered_myids_zone_arr);
-    }
-
-    if (_g_no_f_cells_zone_arr != NULL)
-    {
-        free(_g_no_f_cells_zone_arr);
-    }
-
-    if (_g_no_a_elems_zone_arr != NULL)
-    {
-        free(_g_no_a_elems_zone_arr);
-    }
-
    #if RP_HOST
     Message("Global arrays set free\n");
    #endif 
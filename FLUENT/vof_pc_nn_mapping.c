@@ -321,7 +321,7 @@ int state = _STATE_OK;
     cells_in_thread = THREAD_N_ELEMENTS_INT(t);
 
 if(
-    N_UDM > noUDMI &&
+    N_COUPLING_FIELDS > noUDMI &&
     cells_in_thread == cells_in_node_n &&
     node_n_mapped_arr != NULL &&
     node_n_compute_node_id_arr != NULL &&
@@ -353,11 +353,11 @@ if(
         if(state != _STATE_ERROR)
         {
             if (i < cells_in_thread)
-                C_UDMI(c,t,noUDMI) = node_n_mapped_arr[i];
+                C_COUPLING(c,t,noUDMI) = node_n_mapped_arr[i];
         }
         else
         {
-            C_UDMI(c,t,noUDMI) = UDMI_ERROR_VALUE;
+            C_COUPLING(c,t,noUDMI) = UDMI_ERROR_VALUE;
         }
 
         ++i;
@@ -387,7 +387,7 @@ else
 
     }
 
-    if( N_UDM <= noUDMI)
+    if( N_COUPLING_FIELDS <= noUDMI)
     {
         Message("Error safeNodeArrayToCUDMI(): "
             "Not enough UDMI's for UDMI index!\n", noUDMI);
@@ -526,7 +526,7 @@ int getAnsysElementCountFromFileLength(char filename[])
 }
 
 
-int debugWriteMappings(
+static int writeDebugMappingFiles(
                             int *mappings_arr1_to_arr2, 
                             int size_arr_1,
                             int *mappings_arr2_to_arr1,
@@ -546,7 +546,7 @@ int debugWriteMappings(
 
     if(state != _STATE_OK)
     {
-        Message("Warning (debugWriteMappings()): Possible error in "
+        threadMessage("Warning (debugWriteMappings()): Possible error in "
                 "writeIntegerArrToFile()-1\n");
     }
     state  = writeIntegerArrToFile( 
@@ -556,12 +556,12 @@ int debugWriteMappings(
                                   );
     if(state != _STATE_OK)
     {
-        Message("Warning (debugWriteMappings()): Possible error in "
+        threadMessage("Warning (debugWriteMappings()): Possible error in "
                 "writeIntegerArrToFile()-2\n");
     }
     else
     {
-        Message("Info (debugWriteMappings()): Debug NN Mappings written to %s "
+        threadMessage("Info (debugWriteMappings()): Debug NN Mappings written to %s "
                 "and %s.\n"
                 , filename_arr1_to_arr2_mapping, filename_arr2_to_arr1_mapping);
     }
@@ -570,6 +570,102 @@ int debugWriteMappings(
 }
 
 
+#if DEBUG_BACKGROUND_WRITER
+/* copies of the mappings, written on the background writer thread */
+typedef struct debug_mappings_job_struct
+{
+    int *mappings_arr1_to_arr2;
+    int size_arr_1;
+    int *mappings_arr2_to_arr1;
+    int size_arr_2;
+    char filename_arr1_to_arr2_mapping[XC_PART_FILENAME_SIZE];
+    char filename_arr2_to_arr1_mapping[XC_PART_FILENAME_SIZE];
+} DebugMappingsJob;
+
+
+static int writeDebugMappingsJob(void *arg)
+{
+    DebugMappingsJob *job = (DebugMappingsJob *) arg;
+    int state;
+
+    state = writeDebugMappingFiles(
+                                    job->mappings_arr1_to_arr2,
+                                    job->size_arr_1,
+                                    job->mappings_arr2_to_arr1,
+                                    job->size_arr_2,
+                                    job->filename_arr1_to_arr2_mapping,
+                                    job->filename_arr2_to_arr1_mapping
+                                  );
+
+    free(job->mappings_arr1_to_arr2);
+    free(job->mappings_arr2_to_arr1);
+    free(job);
+
+    return state;
+}
+#endif
+
+
+int debugWriteMappings(
+                            int *mappings_arr1_to_arr2, 
+                            int size_arr_1,
+                            int *mappings_arr2_to_arr1,
+                            int size_arr_2, 
+                            char filename_arr1_to_arr2_mapping[],
+                            char filename_arr2_to_arr1_mapping[]
+                        )
+{
+/*
+    Writes both mappings to their files. With DEBUG_BACKGROUND_WRITER copies
+    of the mappings are written by the background writer thread, errors are
+    reported by flushBackgroundWriter() then.
+*/
+#if DEBUG_BACKGROUND_WRITER
+DebugMappingsJob *job = (DebugMappingsJob *) calloc(1, sizeof(DebugMappingsJob));
+
+if(job != NULL)
+{
+    job->size_arr_1 = size_arr_1;
+    job->size_arr_2 = size_arr_2;
+    job->mappings_arr1_to_arr2 = (int *) malloc((size_arr_1 + 1) * sizeof(int));
+    job->mappings_arr2_to_arr1 = (int *) malloc((size_arr_2 + 1) * sizeof(int));
+
+    if(
+        job->mappings_arr1_to_arr2 != NULL && job->mappings_arr2_to_arr1 != NULL &&
+        mappings_arr1_to_arr2 != NULL && mappings_arr2_to_arr1 != NULL
+      )
+    {
+        memcpy(job->mappings_arr1_to_arr2, mappings_arr1_to_arr2,
+               size_arr_1 * sizeof(int));
+        memcpy(job->mappings_arr2_to_arr1, mappings_arr2_to_arr1,
+               size_arr_2 * sizeof(int));
+        sprintf(job->filename_arr1_to_arr2_mapping, "%.*s",
+                XC_PART_FILENAME_SIZE - 1, filename_arr1_to_arr2_mapping);
+        sprintf(job->filename_arr2_to_arr1_mapping, "%.*s",
+                XC_PART_FILENAME_SIZE - 1, filename_arr2_to_arr1_mapping);
+
+        submitBackgroundWrite(writeDebugMappingsJob, job);
+
+        return _STATE_OK;
+    }
+
+    free(job->mappings_arr1_to_arr2);
+    free(job->mappings_arr2_to_arr1);
+    free(job);
+}
+#endif
+
+return writeDebugMappingFiles(
+                                mappings_arr1_to_arr2,
+                                size_arr_1,
+                                mappings_arr2_to_arr1,
+                                size_arr_2,
+                                filename_arr1_to_arr2_mapping,
+                                filename_arr2_to_arr1_mapping
+                             );
+}
+
+
 int writePropertyArrayToFileMapped(
                                     char filename[],
                                     real *property_arr_full,
@@ -15,6 +15,9 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 #ifndef VOF_PC_NN_MAPPING_H
 #include "vof_pc_main.h"
 #include "vof_pc_fluent_get_fields.h" 
+#include "vof_pc_zone_storage.h"
+#include "vof_pc_file_sync.h"
+#include "vof_pc_threads.h"
 #define VOF_PC_NN_MAPPING_H
 
 
@@ -0,0 +1,599 @@
+/*
+Utility functions to relay arrays between the host and the compute nodes
+(via node 0) in the order of the compute node loop
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_node_comm.h"
+
+#define NODE_COMM_NO_FORWARD -1
+
+/* relayed and dropped pieces of an array pass through this buffer */
+static char _g_relay_buf[NODE_COMM_RELAY_SIZE];
+
+
+static void sendArrayPieces(int to, void *arr, long no_bytes)
+{
+/*
+    Sends no_bytes of arr to process to in messages of at most
+    NODE_COMM_RELAY_SIZE bytes, counterpart of recvArrayPieces().
+*/
+long offset = 0;
+int n = 0;
+
+for(offset = 0; offset < no_bytes; offset += n)
+{
+    n = (no_bytes - offset < NODE_COMM_RELAY_SIZE) ?
+            (int) (no_bytes - offset) : NODE_COMM_RELAY_SIZE;
+    PRF_CSEND_CHAR(to, ((char *) arr) + offset, n, myid);
+}
+}
+
+
+static void recvArrayPieces(int from, void *arr, long no_bytes, int forward_to)
+{
+/*
+    Receives no_bytes sent by sendArrayPieces() on process from into arr and
+    forwards every piece to process forward_to (if not NODE_COMM_NO_FORWARD).
+    With arr == NULL the pieces only pass through a fixed buffer, so a relay
+    needs no allocation and a receiver still takes every message off the
+    channel after an allocation error.
+*/
+long offset = 0;
+int n = 0;
+char *piece = NULL;
+
+for(offset = 0; offset < no_bytes; offset += n)
+{
+    n = (no_bytes - offset < NODE_COMM_RELAY_SIZE) ?
+            (int) (no_bytes - offset) : NODE_COMM_RELAY_SIZE;
+    piece = (arr != NULL) ? ((char *) arr) + offset : _g_relay_buf;
+
+    PRF_CRECV_CHAR(from, piece, n, from);
+
+    if(forward_to != NODE_COMM_NO_FORWARD)
+    {
+        PRF_CSEND_CHAR(forward_to, piece, n, myid);
+    }
+}
+}
+
+
+#if RP_NODE
+static int recvNodeArray(
+                            int from,
+                            int count,
+                            int elem_size,
+                            void **node_arr,
+                            int *node_count
+                        )
+{
+/*
+    Receives count values of elem_size bytes from process from in the newly
+    allocated array (*node_arr). After an allocation error the values are
+    received and dropped and (*node_count) stays 0.
+*/
+int state = _STATE_OK;
+
+*node_arr = NULL;
+(*node_count) = 0;
+
+if(count > 0)
+{
+    *node_arr = calloc(count, elem_size);
+
+    if(*node_arr == NULL)
+    {
+        Message("Error (recvNodeArray()): Memory allocation error on node "
+                "%i!\n", myid);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        (*node_count) = count;
+    }
+
+    recvArrayPieces(from, *node_arr, (long) count * elem_size,
+                    NODE_COMM_NO_FORWARD);
+}
+
+return state;
+}
+#endif /* RP_NODE */
+
+
+static int hostToNodesArrays(
+                                void *arr_full,
+                                int elem_size,
+                                int *counts_per_node,
+                                void **node_arr,
+                                int *node_count
+                            )
+{
+/*
+    Implementation of hostToNodesIntArrays() and hostToNodesRealArrays() for
+    values of elem_size bytes. Node 0 relays the slices of the other nodes
+    without allocating them.
+
+    Order of sending and receiving is very important!
+*/
+int state = _STATE_OK;
+int pe;
+int count = 0;
+
+#if RP_HOST
+long offset = 0;
+
+compute_node_loop (pe)
+{
+    count = counts_per_node[pe];
+
+    PRF_CSEND_INT(node_zero, &count, 1, node_host);
+    sendArrayPieces(node_zero, ((char *) arr_full) + offset,
+                    (long) count * elem_size);
+    offset += (long) count * elem_size;
+}
+#endif /* RP_HOST */
+
+#if RP_NODE
+*node_arr = NULL;
+(*node_count) = 0;
+
+if (I_AM_NODE_ZERO_P)
+{
+    compute_node_loop (pe)
+    {
+        PRF_CRECV_INT(node_host, &count, 1, node_host);
+
+        if(pe == myid)
+        {
+            state = recvNodeArray(node_host, count, elem_size, node_arr,
+                                  node_count);
+        }
+        else
+        {
+            PRF_CSEND_INT(pe, &count, 1, myid);
+            recvArrayPieces(node_host, NULL, (long) count * elem_size, pe);
+        }
+    }
+}
+else
+{
+    PRF_CRECV_INT(node_zero, &count, 1, node_zero);
+
+    state = recvNodeArray(node_zero, count, elem_size, node_arr, node_count);
+}
+#endif /* RP_NODE */
+
+return state;
+}
+
+
+int hostToNodesIntArrays(
+                            int *arr_full,
+                            int *counts_per_node,
+                            int **node_arr,
+                            int *node_count
+                        )
+{
+/*
+    Sends the slices of arr_full (host), which holds counts_per_node[pe]
+    values for each compute node pe concatenated in compute node order, to
+    the compute nodes. Each node receives its slice in the newly allocated
+    array (*node_arr) of size (*node_count).
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+void *arr = NULL;
+
+state = hostToNodesArrays(arr_full, sizeof(int), counts_per_node, &arr,
+                          node_count);
+
+#if RP_NODE
+*node_arr = (int *) arr;
+#endif
+
+return state;
+}
+
+
+int hostToNodesRealArrays(
+                            xreal *arr_full,
+                            int *counts_per_node,
+                            xreal **node_arr,
+                            int *node_count
+                         )
+{
+/*
+    Same as hostToNodesIntArrays() for the xreal values of the coupling
+    fields.
+*/
+int state = _STATE_OK;
+void *arr = NULL;
+
+state = hostToNodesArrays(arr_full, sizeof(xreal), counts_per_node, &arr,
+                          node_count);
+
+#if RP_NODE
+*node_arr = (xreal *) arr;
+#endif
+
+return state;
+}
+
+
+int nodesToHostArrays(
+                        void *node_arr,
+                        int elem_size,
+                        int node_count,
+                        void **arr_full,
+                        int *size_arr_full,
+                        int *counts_per_node
+                     )
+{
+/*
+    Gathers the node arrays (node_arr of size node_count, values of elem_size
+    bytes) on the host. The host receives them concatenated in compute node
+    order in the newly allocated array (*arr_full) of size (*size_arr_full).
+    If counts_per_node is not NULL (host only, compute_node_count entries)
+    the count of each node is written to it. Node 0 relays the arrays of the
+    other nodes without allocating them, after an error the host still
+    receives all values.
+
+    Order of sending and receiving is very important!
+*/
+int state = _STATE_OK;
+int pe;
+int count = 0;
+int sum_count = 0;
+
+#if RP_NODE
+PRF_GSYNC();
+sum_count = PRF_GISUM1(node_count);
+
+pe = (I_AM_NODE_ZERO_P) ? node_host : node_zero;
+
+if (I_AM_NODE_ZERO_P)
+{
+    PRF_CSEND_INT(node_host, &sum_count, 1, myid);
+}
+
+PRF_CSEND_INT(pe, &node_count, 1, myid);
+sendArrayPieces(pe, node_arr, (long) node_count * elem_size);
+
+if (I_AM_NODE_ZERO_P)
+{
+    /* pe only acts as a counter in this loop */
+    compute_node_loop_not_zero (pe)
+    {
+        PRF_CRECV_INT(pe, &count, 1, pe);
+        PRF_CSEND_INT(node_host, &count, 1, myid);
+        recvArrayPieces(pe, NULL, (long) count * elem_size, node_host);
+    }
+}
+#endif /* RP_NODE */
+
+#if RP_HOST
+int offset = 0;
+
+*arr_full = NULL;
+(*size_arr_full) = 0;
+
+PRF_CRECV_INT(node_zero, &sum_count, 1, node_zero);
+
+if(sum_count > 0)
+{
+    *arr_full = calloc(sum_count, elem_size);
+
+    if(*arr_full == NULL)
+    {
+        Message("Error (nodesToHostArrays()): Memory allocation error!\n");
+        state = _STATE_ERROR;
+    }
+}
+
+/* pe only acts as a counter in this loop */
+compute_node_loop (pe)
+{
+    PRF_CRECV_INT(node_zero, &count, 1, node_zero);
+
+    if(counts_per_node != NULL)
+    {
+        counts_per_node[pe] = count;
+    }
+
+    if(state != _STATE_ERROR && offset + count > sum_count)
+    {
+        Message("Error (nodesToHostArrays()): Index out of bounds!\n");
+        state = _STATE_ERROR;
+    }
+
+    /* after an error the values are received and dropped */
+    recvArrayPieces(node_zero,
+                    (state != _STATE_ERROR) ?
+                        ((char *) *arr_full) + (long) offset * elem_size : NULL,
+                    (long) count * elem_size, NODE_COMM_NO_FORWARD);
+
+    if(state != _STATE_ERROR)
+    {
+        offset += count;
+    }
+}
+
+(*size_arr_full) = offset;
+#endif /* RP_HOST */
+
+return state;
+}
+
+
+int nodesToHostRealArrays(
+                            xreal *node_arr,
+                            int node_count,
+                            xreal **arr_full,
+                            int *size_arr_full,
+                            int *counts_per_node
+                         )
+{
+/*
+    nodesToHostArrays() for the xreal values of the coupling fields.
+*/
+int state = _STATE_OK;
+void *arr = NULL;
+
+state = nodesToHostArrays(node_arr, sizeof(xreal), node_count, &arr,
+                          size_arr_full, counts_per_node);
+
+#if RP_HOST
+*arr_full = (xreal *) arr;
+#endif
+
+return state;
+}
+
+
+int nodesToHostRealArraysChunked(
+                                    xreal *node_arr,
+                                    int node_count,
+                                    int chunk_size,
+                                    HostChunkFun chunk_fun,
+                                    void *chunk_ctx
+                                )
+{
+/*
+    Same as nodesToHostRealArrays(), but the host only holds chunks of at
+    most chunk_size values. chunk_fun(chunk_ctx, pe, offset, vals, count) is
+    called on the host for every received chunk of compute node pe, offset
+    is the index of vals[0] in node_arr of pe.
+
+    Order of sending and receiving is very important!
+*/
+int state = _STATE_OK;
+int pe;
+int count = 0;
+int offset = 0;
+int n = 0;
+xreal *chunk_arr = NULL;
+
+chunk_arr = (xreal *) calloc(chunk_size + 1, sizeof(xreal));
+
+if(chunk_arr == NULL || chunk_size < 1)
+{
+    Message("Error (nodesToHostRealArraysChunked()): Memory allocation error "
+            "or invalid chunk size!\n");
+    state = _STATE_ERROR;
+}
+
+state = reduceStateOverProcesses(state);
+
+#if RP_NODE
+if(state != _STATE_ERROR)
+{
+    if (I_AM_NODE_ZERO_P)
+    {
+        compute_node_loop (pe)
+        {
+            if(pe == myid)
+            {
+                count = node_count;
+            }
+            else
+            {
+                PRF_CRECV_INT(pe, &count, 1, pe);
+            }
+            PRF_CSEND_INT(node_host, &count, 1, myid);
+
+            for(offset = 0; offset < count; offset += chunk_size)
+            {
+                n = (count - offset < chunk_size) ? count - offset : chunk_size;
+
+                if(pe != myid)
+                {
+                    PRF_CRECV_XREAL(pe, chunk_arr, n, pe);
+                    PRF_CSEND_XREAL(node_host, chunk_arr, n, myid);
+                }
+                else
+                {
+                    PRF_CSEND_XREAL(node_host, node_arr + offset, n, myid);
+                }
+            }
+        }
+    }
+    else
+    {
+        PRF_CSEND_INT(node_zero, &node_count, 1, myid);
+
+        for(offset = 0; offset < node_count; offset += chunk_size)
+        {
+            n = (node_count - offset < chunk_size) ? 
+                    node_count - offset : chunk_size;
+            PRF_CSEND_XREAL(node_zero, node_arr + offset, n, myid);
+        }
+    }
+}
+#endif /* RP_NODE */
+
+#if RP_HOST
+if(state != _STATE_ERROR)
+{
+    /* pe only acts as a counter in this loop */
+    compute_node_loop (pe)
+    {
+        PRF_CRECV_INT(node_zero, &count, 1, node_zero);
+
+        for(offset = 0; offset < count; offset += chunk_size)
+        {
+            n = (count - offset < chunk_size) ? count - offset : chunk_size;
+            PRF_CRECV_XREAL(node_zero, chunk_arr, n, node_zero);
+            chunk_fun(chunk_ctx, pe, offset, chunk_arr, n);
+        }
+    }
+}
+#endif /* RP_HOST */
+
+free(chunk_arr);
+
+return state;
+}
+
+
+
+int reduceStateOverProcesses(int state)
+{
+/*
+    Returns the lowest (most severe) state of all compute nodes and the host
+    on all processes.
+*/
+int node_state = state;
+
+#if RP_NODE
+node_state = PRF_GILOW1(state);
+#endif
+
+node_to_host_int_1(node_state);
+
+if(node_state < state)
+{
+    state = node_state;
+}
+
+host_to_node_int_1(state);
+
+return state;
+}
+
+
+int hostSendToNodeViaNodeZero(
+                                int *int_arr,
+                                int no_ints,
+                                xreal *real_arr,
+                                int no_reals
+                             )
+{
+/*
+    Sends a message of ints and reals from the host to the next compute node
+    pe. Has to be called on the host once for every compute node in compute
+    node loop order, while the nodes call nodeRecvFromHostViaNodeZero() once.
+    This way only one node message has to be kept in memory on the host.
+*/
+int state = _STATE_OK;
+
+#if RP_HOST
+PRF_CSEND_INT(node_zero, &no_ints, 1, node_host);
+PRF_CSEND_INT(node_zero, &no_reals, 1, node_host);
+
+sendArrayPieces(node_zero, int_arr, (long) no_ints * sizeof(int));
+sendArrayPieces(node_zero, real_arr, (long) no_reals * sizeof(xreal));
+#endif
+
+return state;
+}
+
+
+int nodeRecvFromHostViaNodeZero(
+                                int **int_arr,
+                                int *no_ints,
+                                xreal **real_arr,
+                                int *no_reals
+                               )
+{
+/*
+    Node counterpart of hostSendToNodeViaNodeZero(), node 0 relays the
+    messages of all other nodes without allocating them. The received arrays
+    are newly allocated, after an allocation error the message is received
+    and dropped, both arrays are NULL and the error is returned for the
+    reduction by the caller.
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+int pe;
+int from = (I_AM_NODE_ZERO_P) ? node_host : node_zero;
+int counts[2];
+
+*int_arr = NULL;
+*real_arr = NULL;
+(*no_ints) = 0;
+(*no_reals) = 0;
+
+/* the first message of the compute node loop is the one of node 0 */
+if (I_AM_NODE_ZERO_P)
+{
+    PRF_CRECV_INT(node_host, &counts[0], 1, node_host);
+    PRF_CRECV_INT(node_host, &counts[1], 1, node_host);
+}
+else
+{
+    PRF_CRECV_INT(node_zero, counts, 2, node_zero);
+}
+
+*int_arr = (int *) calloc(counts[0] + 1, sizeof(int));
+*real_arr = (xreal *) calloc(counts[1] + 1, sizeof(xreal));
+
+if(*int_arr == NULL || *real_arr == NULL)
+{
+    Message("Error (nodeRecvFromHostViaNodeZero()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+
+    free(*int_arr);
+    free(*real_arr);
+    *int_arr = NULL;
+    *real_arr = NULL;
+}
+else
+{
+    (*no_ints) = counts[0];
+    (*no_reals) = counts[1];
+}
+
+recvArrayPieces(from, *int_arr, (long) counts[0] * sizeof(int),
+                NODE_COMM_NO_FORWARD);
+recvArrayPieces(from, *real_arr, (long) counts[1] * sizeof(xreal),
+                NODE_COMM_NO_FORWARD);
+
+if (I_AM_NODE_ZERO_P)
+{
+    compute_node_loop_not_zero (pe)
+    {
+        PRF_CRECV_INT(node_host, &counts[0], 1, node_host);
+        PRF_CRECV_INT(node_host, &counts[1], 1, node_host);
+
+        PRF_CSEND_INT(pe, counts, 2, myid);
+        recvArrayPieces(node_host, NULL, (long) counts[0] * sizeof(int), pe);
+        recvArrayPieces(node_host, NULL, (long) counts[1] * sizeof(xreal),
+                        pe);
+    }
+}
+#endif /* RP_NODE */
+
+return state;
+}
@@ -0,0 +1,81 @@
+/*
+Utility functions to relay arrays between the host and the compute nodes
+(via node 0) in the order of the compute node loop
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_NODE_COMM_H
+#include "vof_pc_main.h"
+#define VOF_PC_NODE_COMM_H
+
+/* largest message in bytes of an array relayed via node 0 */
+#define NODE_COMM_RELAY_SIZE 1048576
+
+/* called on the host for every received chunk of compute node pe */
+typedef void (*HostChunkFun)(void *chunk_ctx, int pe, int offset,
+                             xreal *vals, int count);
+
+int hostToNodesIntArrays(
+                            int *arr_full,
+                            int *counts_per_node,
+                            int **node_arr,
+                            int *node_count
+                        );
+
+int hostToNodesRealArrays(
+                            xreal *arr_full,
+                            int *counts_per_node,
+                            xreal **node_arr,
+                            int *node_count
+                         );
+
+int nodesToHostArrays(
+                        void *node_arr,
+                        int elem_size,
+                        int node_count,
+                        void **arr_full,
+                        int *size_arr_full,
+                        int *counts_per_node
+                     );
+
+int nodesToHostRealArrays(
+                            xreal *node_arr,
+                            int node_count,
+                            xreal **arr_full,
+                            int *size_arr_full,
+                            int *counts_per_node
+                         );
+
+int nodesToHostRealArraysChunked(
+                                    xreal *node_arr,
+                                    int node_count,
+                                    int chunk_size,
+                                    HostChunkFun chunk_fun,
+                                    void *chunk_ctx
+                                );
+
+int hostSendToNodeViaNodeZero(
+                                int *int_arr,
+                                int no_ints,
+                                xreal *real_arr,
+                                int no_reals
+                             );
+
+int nodeRecvFromHostViaNodeZero(
+                                int **int_arr,
+                                int *no_ints,
+                                xreal **real_arr,
+                                int *no_reals
+                               );
+
+int reduceStateOverProcesses(int state);
+
+#endif
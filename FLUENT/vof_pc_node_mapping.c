@@ -0,0 +1,279 @@
+/*
+Node-side application of the f2a mapping (A2F), the host only handles ANSYS
+element sized arrays (see A2F_NODE_MAPPING in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_node_mapping.h"
+
+
+int exchangeNodeMappedPropertiesA2FZone(
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                       )
+{
+/*
+    Reads the volumetric property and, if no_fields == 1 + ND_ND, the vector
+    property of a zone on the host and sends the ANSYS element values
+    (interleaved per element) to the compute nodes:
+
+    A2F_NODE_MAPPING_BROADCAST 1: all no_a_elems elements to every node
+    A2F_NODE_MAPPING_BROADCAST 0: each node only the elements of its list
+
+    The nodes apply the mapping of their own cells (see A2FStreamPlan) and
+    write udmi_idx[0] (volumetric) and udmi_idx[1..ND_ND] (vector).
+    The volume weighted sum of the volumetric property for the conservative
+    correction is returned in a_vol_weighted_prop_sum (host).
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int size_elem_vals = 0;
+xreal *elem_vals = NULL;
+
+#if RP_HOST
+int k, e;
+real *vol_prop_from_ansys = NULL;
+real *elem_vol_from_ansys = NULL;
+real (*vec_prop_from_ansys)[ND_ND] = NULL;
+#if !A2F_NODE_MAPPING_BROADCAST
+int pe, j;
+int offset = 0;
+xreal *node_vals = NULL;
+int max_no_elems = 0;
+#endif
+#endif
+
+#if RP_NODE && !A2F_NODE_MAPPING_BROADCAST
+int *dummy_header = NULL;
+int no_dummy_header = 0;
+#endif
+
+if(no_fields != 1 && no_fields != 1 + ND_ND)
+{
+    return _STATE_ERROR;
+}
+
+#if RP_HOST
+(*a_vol_weighted_prop_sum) = 0;
+
+state = readElemValueAndVolumeFromAnsysOut(
+                                        ansys_vol_prop_file,
+                                        &vol_prop_from_ansys,
+                                        &elem_vol_from_ansys,
+                                        plan->no_a_elems
+                                          );
+if(state != _STATE_ERROR && no_fields > 1)
+{
+    state = readElemValueVecFromAnsysOut(
+                                        ansys_vec_prop_file,
+                                        &vec_prop_from_ansys,
+                                        plan->no_a_elems
+                                        );
+}
+
+if(state != _STATE_ERROR)
+{
+    size_elem_vals = plan->no_a_elems * no_fields;
+    elem_vals = (xreal *) calloc(size_elem_vals + 1, sizeof(xreal));
+
+    if(elem_vals == NULL || plan->no_elems_per_node == NULL)
+    {
+        Message("Error (exchangeNodeMappedPropertiesA2FZone()): Memory "
+                "allocation error or uninitialized plan!\n");
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        for(e = 0; e < plan->no_a_elems; ++e)
+        {
+            (*a_vol_weighted_prop_sum) += vol_prop_from_ansys[e] *
+                                          elem_vol_from_ansys[e];
+
+            elem_vals[e*no_fields] = (xreal) vol_prop_from_ansys[e];
+            for(k = 1; k < no_fields; ++k)
+            {
+                elem_vals[e*no_fields + k] = (xreal) vec_prop_from_ansys[e][k - 1];
+            }
+        }
+    }
+}
+else
+{
+    Message("Error (exchangeNodeMappedPropertiesA2FZone()): Reading ANSYS "
+            "results for zone id %i failed!\n", fluid_zone_id);
+}
+
+free(vol_prop_from_ansys);
+free(elem_vol_from_ansys);
+free(vec_prop_from_ansys);
+#endif /* RP_HOST */
+
+host_to_node_int_2(state, size_elem_vals);
+
+if(state == _STATE_ERROR)
+{
+    #if RP_HOST
+    free(elem_vals);
+    #endif
+    return state;
+}
+
+#if A2F_NODE_MAPPING_BROADCAST
+#if RP_NODE
+elem_vals = (xreal *) calloc(size_elem_vals + 1, sizeof(xreal));
+
+if(elem_vals == NULL)
+{
+    Message("Error (exchangeNodeMappedPropertiesA2FZone()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+#endif
+state = reduceStateOverProcesses(state);
+
+if(state != _STATE_ERROR)
+{
+    host_to_node_xreal(elem_vals, size_elem_vals);
+}
+#else /* per node element lists */
+#if RP_HOST
+compute_node_loop (pe)
+{
+    if(plan->no_elems_per_node[pe] > max_no_elems)
+    {
+        max_no_elems = plan->no_elems_per_node[pe];
+    }
+}
+
+node_vals = (xreal *) calloc(max_no_elems * no_fields + 1, sizeof(xreal));
+
+if(node_vals == NULL)
+{
+    Message("Error (exchangeNodeMappedPropertiesA2FZone()): Memory allocation "
+            "error!\n");
+    state = _STATE_ERROR;
+}
+#endif
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    #if RP_HOST
+    compute_node_loop (pe)
+    {
+        for(j = 0; j < plan->no_elems_per_node[pe]; ++j)
+        {
+            e = plan->node_elem_idx[offset + j];
+
+            for(k = 0; k < no_fields; ++k)
+            {
+                node_vals[j*no_fields + k] = elem_vals[e*no_fields + k];
+            }
+        }
+        offset += plan->no_elems_per_node[pe];
+
+        hostSendToNodeViaNodeZero(NULL, 0, node_vals,
+                                  plan->no_elems_per_node[pe] * no_fields);
+    }
+    #endif
+
+    #if RP_NODE
+    state = nodeRecvFromHostViaNodeZero(&dummy_header, &no_dummy_header,
+                                        &elem_vals, &size_elem_vals);
+    free(dummy_header);
+
+    if(size_elem_vals != plan->no_elems_node * no_fields)
+    {
+        state = _STATE_ERROR;
+    }
+    #endif
+}
+
+#if RP_HOST
+free(node_vals);
+#endif
+state = reduceStateOverProcesses(state);
+#endif /* A2F_NODE_MAPPING_BROADCAST */
+
+#if A2F_NODE_MAPPING_BROADCAST
+writeNodeElemValuesToCells(plan, elem_vals, plan->node_elem_idx, no_fields,
+                           udmi_idx, state, fluid_zone_id);
+#else
+writeNodeElemValuesToCells(plan, elem_vals, NULL, no_fields, udmi_idx, state,
+                           fluid_zone_id);
+#endif
+
+free(elem_vals);
+
+return state;
+}
+
+
+void writeNodeElemValuesToCells(
+                                A2FStreamPlan *plan,
+                                xreal *elem_vals,
+                                int *elem_idx,
+                                int no_fields,
+                                const int udmi_idx[],
+                                int state,
+                                int fluid_zone_id
+                               )
+{
+/*
+    Writes the ANSYS element values elem_vals (no_fields interleaved per
+    element) to the UDMIs udmi_idx[] of the node-local cells of the zone.
+    Without elem_idx elem_vals holds the elements of the node's own list
+    (slot order), otherwise elem_idx[slot] is the index into elem_vals.
+    If state is _STATE_ERROR UDMI_ERROR_VALUE is written.
+*/
+#if RP_NODE
+cell_t c;
+Thread *t;
+Domain *domain = Get_Domain(1);
+int i = 0;
+int n, e;
+
+t = Lookup_Thread(domain, fluid_zone_id);
+
+if(state != _STATE_ERROR)
+{
+    begin_c_loop_int(c, t)
+    {
+        e = (elem_idx != NULL) ? elem_idx[plan->cell_elem_slot[i]] :
+                                 plan->cell_elem_slot[i];
+
+        for(n = 0; n < no_fields; ++n)
+        {
+            C_COUPLING(c,t,udmi_idx[n]) = elem_vals[e*no_fields + n];
+        }
+        ++i;
+    }
+    end_c_loop_int(c, t)
+}
+else
+{
+    begin_c_loop_int(c, t)
+    {
+        for(n = 0; n < no_fields; ++n)
+        {
+            C_COUPLING(c,t,udmi_idx[n]) = UDMI_ERROR_VALUE;
+        }
+    }
+    end_c_loop_int(c, t)
+}
+#endif /* RP_NODE */
+}
@@ -0,0 +1,41 @@
+/*
+Node-side application of the f2a mapping (A2F), the host only handles ANSYS
+element sized arrays (see A2F_NODE_MAPPING in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_NODE_MAPPING_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_host_streaming.h"
+#define VOF_PC_NODE_MAPPING_H
+
+int exchangeNodeMappedPropertiesA2FZone(
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                       );
+
+void writeNodeElemValuesToCells(
+                                A2FStreamPlan *plan,
+                                xreal *elem_vals,
+                                int *elem_idx,
+                                int no_fields,
+                                const int udmi_idx[],
+                                int state,
+                                int fluid_zone_id
+                               );
+
+#endif
@@ -0,0 +1,584 @@
+/*
+Coupling I/O on compute node 0 (see NODE_ZERO_IO in vof_pc_main.h): node 0
+reads and writes the exchange (XC) folder files, polls the sync file and
+distributes the values to the other compute nodes, the host only receives
+status codes.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_node_zero_io.h"
+
+
+int initNodeZeroIOPlanOfCellZone(
+                                    NodeZeroIOPlan *io_plan,
+                                    A2FStreamPlan *a2f_plan,
+                                    F2AAggregationPlan *f2a_plan,
+                                    int fluid_zone_id
+                                )
+{
+/*
+    Sends the host parts of a2f_plan and f2a_plan (either may be NULL, but
+    consistently on all processes) to compute node 0 once. Node 0 checks the
+    element and slot counts of every compute node against the counts the
+    other nodes hold in their own plans, so the per step messages between
+    the nodes always match.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int counts[4] = {0, 0, 0, 0}; /* elems, A2F elems full, F2A slots, weights */
+
+#if RP_HOST
+int pe;
+#endif
+
+#if RP_NODE
+int pe, i;
+int node_counts[2];
+#endif
+
+io_plan->no_a_elems = 0;
+io_plan->a2f_no_elems_per_node = NULL;
+io_plan->a2f_node_elem_idx = NULL;
+io_plan->a2f_no_elems_full = 0;
+io_plan->f2a_no_slots_per_node = NULL;
+io_plan->f2a_slot_elem_idx = NULL;
+io_plan->f2a_no_slots_full = 0;
+io_plan->f2a_elem_weight_sum = NULL;
+
+#if RP_HOST
+if(a2f_plan != NULL)
+{
+    if(a2f_plan->no_elems_per_node == NULL || a2f_plan->node_elem_idx == NULL)
+    {
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        counts[0] = a2f_plan->no_a_elems;
+        compute_node_loop (pe)
+        {
+            counts[1] += a2f_plan->no_elems_per_node[pe];
+        }
+    }
+}
+
+if(f2a_plan != NULL)
+{
+    if(f2a_plan->no_slots_per_node == NULL || f2a_plan->slot_elem_idx == NULL)
+    {
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        counts[0] = f2a_plan->no_a_elems;
+        counts[2] = f2a_plan->no_slots_full;
+        counts[3] = (f2a_plan->elem_weight_sum != NULL);
+    }
+}
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (initNodeZeroIOPlanOfCellZone()): Uninitialized plans for "
+            "zone id %i!\n", fluid_zone_id);
+}
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state == _STATE_ERROR)
+{
+    return state;
+}
+
+#if RP_HOST
+PRF_CSEND_INT(node_zero, counts, 4, node_host);
+
+/* node 0 acknowledges its allocations, the arrays are only sent then */
+PRF_CRECV_INT(node_zero, &state, 1, node_zero);
+
+if(a2f_plan != NULL && state != _STATE_ERROR)
+{
+    PRF_CSEND_INT(node_zero, a2f_plan->no_elems_per_node, compute_node_count,
+                  node_host);
+    PRF_CSEND_INT(node_zero, a2f_plan->node_elem_idx, counts[1], node_host);
+}
+
+if(f2a_plan != NULL && state != _STATE_ERROR)
+{
+    PRF_CSEND_INT(node_zero, f2a_plan->no_slots_per_node, compute_node_count,
+                  node_host);
+    PRF_CSEND_INT(node_zero, f2a_plan->slot_elem_idx, counts[2], node_host);
+
+    if(counts[3])
+    {
+        PRF_CSEND_REAL(node_zero, f2a_plan->elem_weight_sum, counts[0],
+                       node_host);
+    }
+}
+#endif /* RP_HOST */
+
+#if RP_NODE
+node_counts[0] = (a2f_plan != NULL) ? a2f_plan->no_elems_node : 0;
+node_counts[1] = (f2a_plan != NULL) ? f2a_plan->no_slots_node : 0;
+
+if (I_AM_NODE_ZERO_P)
+{
+    PRF_CRECV_INT(node_host, counts, 4, node_host);
+
+    io_plan->no_a_elems = counts[0];
+    io_plan->a2f_no_elems_full = counts[1];
+    io_plan->f2a_no_slots_full = counts[2];
+
+    io_plan->a2f_no_elems_per_node = (int *) calloc(compute_node_count, sizeof(int));
+    io_plan->a2f_node_elem_idx = (int *) calloc(counts[1] + 1, sizeof(int));
+    io_plan->f2a_no_slots_per_node = (int *) calloc(compute_node_count, sizeof(int));
+    io_plan->f2a_slot_elem_idx = (int *) calloc(counts[2] + 1, sizeof(int));
+
+    if(counts[3])
+    {
+        io_plan->f2a_elem_weight_sum = (real *) calloc(counts[0] + 1, sizeof(real));
+    }
+
+    if(
+        io_plan->a2f_no_elems_per_node == NULL ||
+        io_plan->a2f_node_elem_idx == NULL ||
+        io_plan->f2a_no_slots_per_node == NULL ||
+        io_plan->f2a_slot_elem_idx == NULL ||
+        (counts[3] && io_plan->f2a_elem_weight_sum == NULL)
+      )
+    {
+        Message("Error (initNodeZeroIOPlanOfCellZone()): Memory allocation "
+                "error on node zero!\n");
+        state = _STATE_ERROR;
+    }
+
+    PRF_CSEND_INT(node_host, &state, 1, myid);
+
+    if(state != _STATE_ERROR)
+    {
+        if(a2f_plan != NULL)
+        {
+            PRF_CRECV_INT(node_host, io_plan->a2f_no_elems_per_node,
+                          compute_node_count, node_host);
+            PRF_CRECV_INT(node_host, io_plan->a2f_node_elem_idx, counts[1],
+                          node_host);
+        }
+
+        if(f2a_plan != NULL)
+        {
+            PRF_CRECV_INT(node_host, io_plan->f2a_no_slots_per_node,
+                          compute_node_count, node_host);
+            PRF_CRECV_INT(node_host, io_plan->f2a_slot_elem_idx, counts[2],
+                          node_host);
+
+            if(counts[3])
+            {
+                PRF_CRECV_REAL(node_host, io_plan->f2a_elem_weight_sum,
+                               counts[0], node_host);
+            }
+        }
+    }
+
+    for(i = 0; i < io_plan->a2f_no_elems_full && state != _STATE_ERROR; ++i)
+    {
+        if(
+            io_plan->a2f_node_elem_idx[i] < 0 ||
+            io_plan->a2f_node_elem_idx[i] >= io_plan->no_a_elems
+          )
+        {
+            state = _STATE_ERROR;
+        }
+    }
+
+    for(i = 0; i < io_plan->f2a_no_slots_full && state != _STATE_ERROR; ++i)
+    {
+        if(
+            io_plan->f2a_slot_elem_idx[i] < 0 ||
+            io_plan->f2a_slot_elem_idx[i] >= io_plan->no_a_elems
+          )
+        {
+            state = _STATE_ERROR;
+        }
+    }
+
+    compute_node_loop (pe)
+    {
+        if(pe != myid)
+        {
+            PRF_CRECV_INT(pe, node_counts, 2, pe);
+        }
+
+        if(
+            state != _STATE_ERROR &&
+            (node_counts[0] != io_plan->a2f_no_elems_per_node[pe] ||
+             node_counts[1] != io_plan->f2a_no_slots_per_node[pe])
+          )
+        {
+            state = _STATE_ERROR;
+        }
+    }
+
+    if(state == _STATE_ERROR)
+    {
+        Message("Error (initNodeZeroIOPlanOfCellZone()): Plans of zone id %i "
+                "do not match on node zero!\n", fluid_zone_id);
+    }
+}
+else
+{
+    PRF_CSEND_INT(node_zero, node_counts, 2, myid);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state == _STATE_ERROR)
+{
+    freeNodeZeroIOPlan(io_plan);
+}
+
+return state;
+}
+
+
+int exchangeNodeZeroPropertiesA2FZone(
+                                        NodeZeroIOPlan *io_plan,
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                     )
+{
+/*
+    Like exchangeNodeMappedPropertiesA2FZone() (A2F_NODE_MAPPING_BROADCAST 0),
+    but the ANSYS files are read on compute node 0, which sends each node the
+    values of its element list directly. The host only receives the state and
+    the volume weighted sum a_vol_weighted_prop_sum, which is returned on all
+    processes.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+xreal *elem_vals = NULL;
+#endif
+
+(*a_vol_weighted_prop_sum) = 0;
+
+if(no_fields != 1 && no_fields != 1 + ND_ND)
+{
+    return _STATE_ERROR;
+}
+
+#if RP_NODE
+elem_vals = (xreal *) calloc(plan->no_elems_node * no_fields + 1,
+                             sizeof(xreal));
+
+if(elem_vals == NULL)
+{
+    Message("Error (exchangeNodeZeroPropertiesA2FZone()): Memory allocation "
+            "error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+
+if (I_AM_NODE_ZERO_P)
+{
+    int pe, j, k, e;
+    int offset = 0;
+    int max_no_elems = 0;
+    real *vol_prop_from_ansys = NULL;
+    real *elem_vol_from_ansys = NULL;
+    real (*vec_prop_from_ansys)[ND_ND] = NULL;
+    xreal *node_vals = NULL;
+
+    if(state != _STATE_ERROR)
+    {
+        state = readElemValueAndVolumeFromAnsysOut(
+                                            ansys_vol_prop_file,
+                                            &vol_prop_from_ansys,
+                                            &elem_vol_from_ansys,
+                                            io_plan->no_a_elems
+                                                  );
+    }
+    if(state != _STATE_ERROR && no_fields > 1)
+    {
+        state = readElemValueVecFromAnsysOut(
+                                            ansys_vec_prop_file,
+                                            &vec_prop_from_ansys,
+                                            io_plan->no_a_elems
+                                            );
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        compute_node_loop (pe)
+        {
+            if(io_plan->a2f_no_elems_per_node[pe] > max_no_elems)
+            {
+                max_no_elems = io_plan->a2f_no_elems_per_node[pe];
+            }
+        }
+
+        node_vals = (xreal *) calloc(max_no_elems * no_fields + 1,
+                                     sizeof(xreal));
+
+        if(node_vals == NULL)
+        {
+            Message("Error (exchangeNodeZeroPropertiesA2FZone()): Memory "
+                    "allocation error on node zero!\n");
+            state = _STATE_ERROR;
+        }
+        else
+        {
+            for(e = 0; e < io_plan->no_a_elems; ++e)
+            {
+                (*a_vol_weighted_prop_sum) += vol_prop_from_ansys[e] *
+                                              elem_vol_from_ansys[e];
+            }
+        }
+    }
+    else
+    {
+        Message("Error (exchangeNodeZeroPropertiesA2FZone()): Reading ANSYS "
+                "results for zone id %i failed!\n", fluid_zone_id);
+    }
+
+    state = PRF_GILOW1(state);
+
+    if(state != _STATE_ERROR)
+    {
+        compute_node_loop (pe)
+        {
+            xreal *vals = (pe == myid) ? elem_vals : node_vals;
+
+            for(j = 0; j < io_plan->a2f_no_elems_per_node[pe]; ++j)
+            {
+                e = io_plan->a2f_node_elem_idx[offset + j];
+
+                vals[j*no_fields] = (xreal) vol_prop_from_ansys[e];
+                for(k = 1; k < no_fields; ++k)
+                {
+                    vals[j*no_fields + k] = (xreal) vec_prop_from_ansys[e][k - 1];
+                }
+            }
+            offset += io_plan->a2f_no_elems_per_node[pe];
+
+            if(pe != myid)
+            {
+                PRF_CSEND_XREAL(pe, node_vals,
+                                io_plan->a2f_no_elems_per_node[pe] * no_fields,
+                                myid);
+            }
+        }
+    }
+
+    free(vol_prop_from_ansys);
+    free(elem_vol_from_ansys);
+    free(vec_prop_from_ansys);
+    free(node_vals);
+}
+else
+{
+    state = PRF_GILOW1(state);
+
+    if(state != _STATE_ERROR)
+    {
+        PRF_CRECV_XREAL(node_zero, elem_vals, plan->no_elems_node * no_fields,
+                        node_zero);
+    }
+}
+
+writeNodeElemValuesToCells(plan, elem_vals, NULL, no_fields, udmi_idx, state,
+                           fluid_zone_id);
+
+free(elem_vals);
+
+(*a_vol_weighted_prop_sum) = PRF_GRSUM1(*a_vol_weighted_prop_sum);
+#endif /* RP_NODE */
+
+node_to_host_real_1(*a_vol_weighted_prop_sum);
+
+return reduceStateOverProcesses(state);
+}
+
+
+int exchangeNodeZeroAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        NodeZeroIOPlan *io_plan,
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                             )
+{
+/*
+    Like exchangeAggregatedPropertyF2AZone(), but the element slots of all
+    nodes are gathered and written to f2a_vol_prop_file on compute node 0.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+xreal *node_vals = NULL;
+xreal *node_partials = NULL;
+int no_node_vals = 0;
+
+t = Lookup_Thread(domain, fluid_zone_id);
+no_node_vals = THREAD_N_ELEMENTS_INT(t);
+node_vals = (xreal *) calloc(no_node_vals + 1, sizeof(xreal));
+node_partials = (xreal *) calloc(plan->no_slots_node + 1, sizeof(xreal));
+
+if(node_vals == NULL || node_partials == NULL)
+{
+    Message("Error (exchangeNodeZeroAggregatedPropertyF2AZone()): Memory "
+            "allocation error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+else
+{
+    nodeGatherCellXValues(node_vals, C_VAL_WRAPPER_FUN, t);
+
+    aggregateNodeValuesToSlots(plan, node_vals, no_node_vals, node_partials);
+}
+
+if (I_AM_NODE_ZERO_P)
+{
+    int pe;
+    int offset = 0;
+    xreal *partials_full = NULL;
+    real *a_elem_vals = NULL;
+
+    partials_full = (xreal *) calloc(io_plan->f2a_no_slots_full + 1,
+                                     sizeof(xreal));
+    a_elem_vals = (real *) calloc(io_plan->no_a_elems + 1, sizeof(real));
+
+    if(partials_full == NULL || a_elem_vals == NULL)
+    {
+        Message("Error (exchangeNodeZeroAggregatedPropertyF2AZone()): Memory "
+                "allocation error on node zero!\n");
+        state = _STATE_ERROR;
+    }
+
+    state = PRF_GILOW1(state);
+
+    if(state != _STATE_ERROR)
+    {
+        compute_node_loop (pe)
+        {
+            if(pe == myid)
+            {
+                memcpy(partials_full + offset, node_partials,
+                       plan->no_slots_node * sizeof(xreal));
+            }
+            else
+            {
+                PRF_CRECV_XREAL(pe, partials_full + offset,
+                                io_plan->f2a_no_slots_per_node[pe], pe);
+            }
+            offset += io_plan->f2a_no_slots_per_node[pe];
+        }
+
+        aggregateSlotsToElements(
+                                    io_plan->f2a_slot_elem_idx,
+                                    partials_full,
+                                    io_plan->f2a_no_slots_full,
+                                    io_plan->f2a_elem_weight_sum,
+                                    a_elem_vals,
+                                    io_plan->no_a_elems
+                                );
+
+        state = xcWriteField(
+                                plan->xc_format,
+                                f2a_vol_prop_file,
+                                &a_elem_vals,
+                                1,
+                                1,
+                                io_plan->no_a_elems
+                            );
+
+        if(state == _STATE_ERROR)
+        {
+            Message("Error (exchangeNodeZeroAggregatedPropertyF2AZone()): "
+                    "Error in xcWriteField()!\n");
+        }
+        else
+        {
+            Message("Info (exchangeNodeZeroAggregatedPropertyF2AZone()): For "
+                    "zone id %i, done!\n", fluid_zone_id);
+        }
+    }
+
+    free(partials_full);
+    free(a_elem_vals);
+}
+else
+{
+    state = PRF_GILOW1(state);
+
+    if(state != _STATE_ERROR)
+    {
+        PRF_CSEND_XREAL(node_zero, node_partials, plan->no_slots_node, myid);
+    }
+}
+
+free(node_vals);
+free(node_partials);
+#endif /* RP_NODE */
+
+return reduceStateOverProcesses(state);
+}
+
+
+int syncWaitForCouplingOnNodeZero(char filename[])
+{
+/*
+    Runs sync_wait_for_coupling() on compute node 0, the state is returned
+    on all processes.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+if (I_AM_NODE_ZERO_P)
+{
+    state = sync_wait_for_coupling(filename);
+}
+#endif
+
+return reduceStateOverProcesses(state);
+}
+
+
+void freeNodeZeroIOPlan(NodeZeroIOPlan *io_plan)
+{
+    if(io_plan == NULL)
+    {
+        return;
+    }
+
+    free(io_plan->a2f_no_elems_per_node);
+    free(io_plan->a2f_node_elem_idx);
+    free(io_plan->f2a_no_slots_per_node);
+    free(io_plan->f2a_slot_elem_idx);
+    free(io_plan->f2a_elem_weight_sum);
+
+    io_plan->a2f_no_elems_per_node = NULL;
+    io_plan->a2f_node_elem_idx = NULL;
+    io_plan->f2a_no_slots_per_node = NULL;
+    io_plan->f2a_slot_elem_idx = NULL;
+    io_plan->f2a_elem_weight_sum = NULL;
+    io_plan->a2f_no_elems_full = 0;
+    io_plan->f2a_no_slots_full = 0;
+}
@@ -0,0 +1,79 @@
+/*
+Coupling I/O on compute node 0 (see NODE_ZERO_IO in vof_pc_main.h): node 0
+reads and writes the exchange (XC) folder files, polls the sync file and
+distributes the values to the other compute nodes, the host only receives
+status codes.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_NODE_ZERO_IO_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_file_sync.h"
+#include "vof_pc_read_ansys.h"
+#include "vof_pc_f2a_aggregation.h"
+#include "vof_pc_host_streaming.h"
+#include "vof_pc_node_mapping.h"
+#define VOF_PC_NODE_ZERO_IO_H
+
+/*
+The host parts of the A2F element lists (A2FStreamPlan) and of the F2A
+aggregation slots (F2AAggregationPlan) of one coupled zone, handed over to
+compute node 0 once during init. All arrays are only allocated on node 0.
+*/
+typedef struct node_zero_io_plan_struct
+{
+    int no_a_elems;
+
+    /* A2F: element lists of all nodes in compute node loop order */
+    int *a2f_no_elems_per_node;
+    int *a2f_node_elem_idx;
+    int a2f_no_elems_full;
+
+    /* F2A: element of every slot of all nodes, weights (or NULL) */
+    int *f2a_no_slots_per_node;
+    int *f2a_slot_elem_idx;
+    int f2a_no_slots_full;
+    real *f2a_elem_weight_sum;
+} NodeZeroIOPlan;
+
+
+int initNodeZeroIOPlanOfCellZone(
+                                    NodeZeroIOPlan *io_plan,
+                                    A2FStreamPlan *a2f_plan,
+                                    F2AAggregationPlan *f2a_plan,
+                                    int fluid_zone_id
+                                );
+
+int exchangeNodeZeroPropertiesA2FZone(
+                                        NodeZeroIOPlan *io_plan,
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                     );
+
+int exchangeNodeZeroAggregatedPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        NodeZeroIOPlan *io_plan,
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                             );
+
+int syncWaitForCouplingOnNodeZero(char filename[]);
+
+void freeNodeZeroIOPlan(NodeZeroIOPlan *io_plan);
+
+#endif
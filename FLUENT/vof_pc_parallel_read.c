@@ -0,0 +1,386 @@
+/*
+Parallel input of the A2F files: every compute node reads only the fixed
+width records of the ANSYS elements its cells are mapped to (see
+A2F_PARALLEL_READ in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_parallel_read.h"
+
+#if LINUX
+#include "fcntl.h"
+#include "sys/types.h"
+#endif
+
+
+#if RP_NODE
+/*
+ANSYS output file of one value row per element, written with a fixed width
+format like (E15.7) so every row has the same length rec_len including the
+line break.
+*/
+typedef struct fixed_record_file_struct
+{
+    #if LINUX
+    int fd;
+    #else
+    FILE *fp;
+    #endif
+    long rec_len;
+    int no_cols;
+    char *buf;
+} FixedRecordFile;
+
+
+static int readFixedRecordBytes(FixedRecordFile *file, char *buf, long length,
+                                long offset)
+{
+#if LINUX
+    return (pread(file->fd, buf, (size_t) length, (off_t) offset) ==
+            (ssize_t) length) ? _STATE_OK : _STATE_ERROR;
+#else
+    if(
+        fseek(file->fp, offset, SEEK_SET) != 0 ||
+        fread(buf, 1, (size_t) length, file->fp) != (size_t) length
+      )
+    {
+        return _STATE_ERROR;
+    }
+    return _STATE_OK;
+#endif
+}
+
+
+static int openFixedRecordFile(
+                                FixedRecordFile *file,
+                                char filename[],
+                                int no_cols,
+                                int no_a_elems
+                              )
+{
+/*
+    Opens filename and takes the record length from its first row, the file
+    must have the size of no_a_elems records.
+*/
+int state = _STATE_OK;
+char first_row[512];
+long size = 0;
+long n = 0;
+long k = 0;
+
+#if LINUX
+file->fd = open(filename, O_RDONLY);
+#else
+file->fp = fopen(filename, "rb");
+#endif
+file->rec_len = 0;
+file->no_cols = no_cols;
+file->buf = NULL;
+
+#if LINUX
+if(file->fd < 0)
+#else
+if(file->fp == NULL)
+#endif
+{
+    Message("Error (openFixedRecordFile()): Unable to open %s on node %i!\n",
+            filename, myid);
+    return _STATE_ERROR;
+}
+
+#if LINUX
+size = (long) lseek(file->fd, 0, SEEK_END);
+#else
+fseek(file->fp, 0, SEEK_END);
+size = ftell(file->fp);
+#endif
+
+n = (size < (long) sizeof(first_row)) ? size : (long) sizeof(first_row);
+
+if(n > 0 && readFixedRecordBytes(file, first_row, n, 0) == _STATE_OK)
+{
+    for(k = 0; k < n; ++k)
+    {
+        if(first_row[k] == '\n')
+        {
+            file->rec_len = k + 1;
+            break;
+        }
+    }
+}
+
+if(file->rec_len < 1 || size != (long) no_a_elems * file->rec_len)
+{
+    Message("Error (openFixedRecordFile()): %s has no fixed width records of "
+            "%i elements, disable A2F_PARALLEL_READ for this output!\n",
+            filename, no_a_elems);
+    state = _STATE_ERROR;
+}
+else
+{
+    file->buf = (char *) malloc(A2F_PARALLEL_READ_BLOCK_SIZE * file->rec_len + 1);
+
+    if(file->buf == NULL)
+    {
+        Message("Error (openFixedRecordFile()): Memory allocation error on "
+                "node %i!\n", myid);
+        state = _STATE_ERROR;
+    }
+}
+
+return state;
+}
+
+
+static int readFixedRecords(
+                            FixedRecordFile *file,
+                            const int *elem_idx,
+                            int first_elem,
+                            int no_elems,
+                            real *vals
+                           )
+{
+/*
+    Parses the no_cols values of no_elems records into vals (no_cols values
+    per record). The records are those of the ascending elements elem_idx[]
+    or, without elem_idx, of the elements first_elem, first_elem + 1, ...
+    Runs of consecutive elements are read in blocks of up to
+    A2F_PARALLEL_READ_BLOCK_SIZE records.
+*/
+int j = 0;
+int n, r, k, e;
+char *rec, *pos, *end;
+
+while(j < no_elems)
+{
+    e = (elem_idx != NULL) ? elem_idx[j] : first_elem + j;
+
+    n = 1;
+    while(
+            j + n < no_elems && n < A2F_PARALLEL_READ_BLOCK_SIZE &&
+            (elem_idx == NULL || elem_idx[j + n] == e + n)
+         )
+    {
+        ++n;
+    }
+
+    if(
+        readFixedRecordBytes(file, file->buf, n * file->rec_len,
+                             e * file->rec_len) != _STATE_OK
+      )
+    {
+        Message("Error (readFixedRecords()): Reading records of elements "
+                "%i to %i failed on node %i!\n", e, e + n - 1, myid);
+        return _STATE_ERROR;
+    }
+    file->buf[n * file->rec_len] = '\0';
+
+    for(r = 0; r < n; ++r)
+    {
+        rec = file->buf + r * file->rec_len;
+        pos = rec;
+
+        for(k = 0; k < file->no_cols; ++k)
+        {
+            vals[(j + r) * file->no_cols + k] = (real) strtod(pos, &end);
+
+            if(end == pos || end >= rec + file->rec_len)
+            {
+                Message("Error (readFixedRecords()): Wrong record of element "
+                        "%i on node %i!\n", e + r, myid);
+                return _STATE_ERROR;
+            }
+            pos = end;
+        }
+    }
+
+    j += n;
+}
+
+return _STATE_OK;
+}
+
+
+static void closeFixedRecordFile(FixedRecordFile *file)
+{
+#if LINUX
+    if(file->fd >= 0)
+    {
+        close(file->fd);
+    }
+    file->fd = -1;
+#else
+    if(file->fp != NULL)
+    {
+        fclose(file->fp);
+    }
+    file->fp = NULL;
+#endif
+    free(file->buf);
+    file->buf = NULL;
+}
+#endif /* RP_NODE */
+
+
+int exchangeParallelReadPropertiesA2FZone(
+                                        A2FStreamPlan *plan,
+                                        char ansys_vol_prop_file[],
+                                        char ansys_vec_prop_file[],
+                                        int no_fields,
+                                        const int udmi_idx[],
+                                        real *a_vol_weighted_prop_sum,
+                                        int fluid_zone_id
+                                         )
+{
+/*
+    Every compute node reads the records of the elements of its element list
+    (see A2FStreamPlan) from the ANSYS files and writes udmi_idx[0]
+    (volumetric) and udmi_idx[1..ND_ND] (vector) of its cells. For the
+    conservative correction every node additionally reads an equal share of
+    the volumetric file, the volume weighted sum a_vol_weighted_prop_sum is
+    returned on all processes. The host only takes part in the state
+    reduction. The exchange folder has to be on a file system shared by all
+    compute nodes.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+FixedRecordFile vol_file;
+FixedRecordFile vec_file;
+real *vol_vals = NULL;
+real *vec_vals = NULL;
+xreal *elem_vals = NULL;
+int first_sum_elem, no_sum_elems;
+int j, k, n;
+#endif
+
+(*a_vol_weighted_prop_sum) = 0;
+
+if(no_fields != 1 && no_fields != 1 + ND_ND)
+{
+    return _STATE_ERROR;
+}
+
+#if RP_NODE
+if(plan->no_a_elems < 1)
+{
+    Message("Error (exchangeParallelReadPropertiesA2FZone()): Unknown ANSYS "
+            "element count for zone id %i on node %i!\n", fluid_zone_id, myid);
+    state = _STATE_ERROR;
+}
+
+if(
+    openFixedRecordFile(&vol_file, ansys_vol_prop_file, 2,
+                        plan->no_a_elems) == _STATE_ERROR
+  )
+{
+    state = _STATE_ERROR;
+}
+
+if(no_fields > 1)
+{
+    if(
+        openFixedRecordFile(&vec_file, ansys_vec_prop_file, ND_ND,
+                            plan->no_a_elems) == _STATE_ERROR
+      )
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+vol_vals = (real *) calloc(2 * (plan->no_elems_node +
+                                A2F_PARALLEL_READ_BLOCK_SIZE), sizeof(real));
+vec_vals = (real *) calloc(ND_ND * plan->no_elems_node + 1, sizeof(real));
+elem_vals = (xreal *) calloc(no_fields * plan->no_elems_node + 1,
+                             sizeof(xreal));
+
+if(vol_vals == NULL || vec_vals == NULL || elem_vals == NULL)
+{
+    Message("Error (exchangeParallelReadPropertiesA2FZone()): Memory "
+            "allocation error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+
+/* equal share of all elements for the volume weighted sum */
+first_sum_elem = (int) (((double) plan->no_a_elems * myid) /
+                        compute_node_count);
+no_sum_elems = (int) (((double) plan->no_a_elems * (myid + 1)) /
+                      compute_node_count) - first_sum_elem;
+
+for(j = 0; j < no_sum_elems && state != _STATE_ERROR;
+    j += A2F_PARALLEL_READ_BLOCK_SIZE)
+{
+    n = no_sum_elems - j;
+    n = (n < A2F_PARALLEL_READ_BLOCK_SIZE) ? n : A2F_PARALLEL_READ_BLOCK_SIZE;
+
+    state = readFixedRecords(&vol_file, NULL, first_sum_elem + j, n, vol_vals);
+
+    for(k = 0; k < n && state != _STATE_ERROR; ++k)
+    {
+        (*a_vol_weighted_prop_sum) += vol_vals[2*k] * vol_vals[2*k + 1];
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    state = readFixedRecords(&vol_file, plan->node_elem_idx, 0,
+                             plan->no_elems_node, vol_vals);
+}
+if(state != _STATE_ERROR && no_fields > 1)
+{
+    state = readFixedRecords(&vec_file, plan->node_elem_idx, 0,
+                             plan->no_elems_node, vec_vals);
+}
+
+if(state != _STATE_ERROR)
+{
+    for(j = 0; j < plan->no_elems_node; ++j)
+    {
+        elem_vals[j*no_fields] = (xreal) vol_vals[2*j];
+        for(k = 1; k < no_fields; ++k)
+        {
+            elem_vals[j*no_fields + k] = (xreal) vec_vals[j*ND_ND + k - 1];
+        }
+    }
+}
+
+closeFixedRecordFile(&vol_file);
+if(no_fields > 1)
+{
+    closeFixedRecordFile(&vec_file);
+}
+free(vol_vals);
+free(vec_vals);
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+#if RP_NODE
+writeNodeElemValuesToCells(plan, elem_vals, NULL, no_fields, udmi_idx, state,
+                           fluid_zone_id);
+free(elem_vals);
+
+(*a_vol_weighted_prop_sum) = PRF_GRSUM1(*a_vol_weighted_prop_sum);
+#endif
+
+node_to_host_real_1(*a_vol_weighted_prop_sum);
+
+#if RP_HOST
+if(state == _STATE_ERROR)
+{
+    Message("Error (exchangeParallelReadPropertiesA2FZone()): Reading ANSYS "
+            "results for zone id %i failed!\n", fluid_zone_id);
+}
+#endif
+
+return state;
+}
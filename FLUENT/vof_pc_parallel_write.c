@@ -0,0 +1,397 @@
+/*
+Parallel output of the F2A file: every compute node writes the fixed width
+records of its ANSYS elements directly into the preallocated file (see
+F2A_PARALLEL_WRITE in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_parallel_write.h"
+
+#if LINUX
+#include "fcntl.h"
+#include "sys/types.h"
+#endif
+
+
+#if RP_NODE
+static int preallocateF2AFile(char filename[], int no_a_elems)
+{
+/*
+    Creates filename with the size of no_a_elems fixed width records.
+*/
+int state = _STATE_OK;
+long size = (long) no_a_elems * F2A_STREAM_RECORD_LEN;
+
+#if LINUX
+int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+if(fd < 0 || ftruncate(fd, (off_t) size) != 0)
+{
+    state = _STATE_ERROR;
+}
+if(fd >= 0)
+{
+    close(fd);
+}
+#else
+FILE *fp = fopen(filename, "wb");
+
+if(fp == NULL)
+{
+    state = _STATE_ERROR;
+}
+else
+{
+    if(
+        size > 0 &&
+        (fseek(fp, size - 1, SEEK_SET) != 0 || fputc('\n', fp) == EOF)
+      )
+    {
+        state = _STATE_ERROR;
+    }
+    fclose(fp);
+}
+#endif
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (preallocateF2AFile()): Unable to create %s with %li "
+            "bytes!\n", filename, size);
+}
+
+return state;
+}
+
+
+static int writeF2ARecordsOfNode(
+                                    char filename[],
+                                    F2AParallelWritePlan *pw_plan,
+                                    xreal *node_partials
+                                )
+{
+/*
+    Formats the records of all slots of the node and writes every run of
+    consecutive elements with a single pwrite (fseek/fwrite on Windows) at
+    the offset of its first element.
+*/
+int state = _STATE_OK;
+char *rec_buf = NULL;
+char rec[TEXT_WRITER_MAX_FIELD];
+double val;
+int k, run_start;
+long offset, length;
+
+#if LINUX
+int fd = -1;
+#else
+FILE *fp = NULL;
+#endif
+
+if(pw_plan->no_slots_node < 1)
+{
+    return state;
+}
+
+rec_buf = (char *) malloc(pw_plan->no_slots_node * F2A_STREAM_RECORD_LEN + 1);
+
+if(rec_buf == NULL)
+{
+    Message("Error (writeF2ARecordsOfNode()): Memory allocation error on "
+            "node %i!\n", myid);
+    return _STATE_ERROR;
+}
+
+for(k = 0; k < pw_plan->no_slots_node; ++k)
+{
+    val = (double) node_partials[k];
+    val = (val < 0.0) ? 0.0 : ((val > 1.0) ? 1.0 : val);
+
+    rec[formatFixed(rec, val, 8, 6)] = '\n';
+    memcpy(rec_buf + k * F2A_STREAM_RECORD_LEN, rec, F2A_STREAM_RECORD_LEN);
+}
+
+#if LINUX
+fd = open(filename, O_WRONLY);
+
+if(fd < 0)
+{
+    state = _STATE_ERROR;
+}
+#else
+fp = fopen(filename, "r+b");
+
+if(fp == NULL)
+{
+    state = _STATE_ERROR;
+}
+#endif
+
+run_start = 0;
+for(k = 1; k <= pw_plan->no_slots_node && state != _STATE_ERROR; ++k)
+{
+    if(
+        k < pw_plan->no_slots_node &&
+        pw_plan->slot_elem_idx_node[k] == pw_plan->slot_elem_idx_node[k - 1] + 1
+      )
+    {
+        continue;
+    }
+
+    offset = (long) pw_plan->slot_elem_idx_node[run_start] *
+             F2A_STREAM_RECORD_LEN;
+    length = (long) (k - run_start) * F2A_STREAM_RECORD_LEN;
+
+    #if LINUX
+    if(
+        pwrite(fd, rec_buf + run_start * F2A_STREAM_RECORD_LEN,
+               (size_t) length, (off_t) offset) != (ssize_t) length
+      )
+    #else
+    if(
+        fseek(fp, offset, SEEK_SET) != 0 ||
+        fwrite(rec_buf + run_start * F2A_STREAM_RECORD_LEN, 1,
+               (size_t) length, fp) != (size_t) length
+      )
+    #endif
+    {
+        state = _STATE_ERROR;
+    }
+
+    run_start = k;
+}
+
+#if LINUX
+#if XC_PUBLISH_FSYNC
+if(state != _STATE_ERROR && fsync(fd) != 0)
+{
+    state = _STATE_ERROR;
+}
+#endif
+if(fd >= 0)
+{
+    close(fd);
+}
+#else
+if(state != _STATE_ERROR && flushExchangeFile(fp) != _STATE_OK)
+{
+    state = _STATE_ERROR;
+}
+if(fp != NULL && fclose(fp) != 0)
+{
+    state = _STATE_ERROR;
+}
+#endif
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (writeF2ARecordsOfNode()): Writing to %s failed on node "
+            "%i!\n", filename, myid);
+}
+
+free(rec_buf);
+
+return state;
+}
+#endif /* RP_NODE */
+
+
+int initF2AParallelWritePlanOfCellZone(
+                                        F2AParallelWritePlan *pw_plan,
+                                        F2AAggregationPlan *plan,
+                                        int fluid_zone_id
+                                      )
+{
+/*
+    Sends each compute node the ANSYS element count and the ANSYS element
+    indices of its slots of an F2A_AGG_PICK aggregation plan once.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+int k;
+#endif
+
+pw_plan->no_a_elems = plan->no_a_elems;
+pw_plan->no_slots_node = 0;
+pw_plan->slot_elem_idx_node = NULL;
+
+#if RP_HOST
+if(
+    plan->aggregation_mode != F2A_AGG_PICK ||
+    plan->no_slots_per_node == NULL ||
+    plan->slot_elem_idx == NULL ||
+    plan->no_slots_full != plan->no_a_elems
+  )
+{
+    Message("Error (initF2AParallelWritePlanOfCellZone()): Only initialized "
+            "F2A_AGG_PICK plans can be written in parallel!\n");
+    state = _STATE_ERROR;
+}
+#endif
+
+/* node 0 preallocates the file with the host's element count */
+host_to_node_int_2(state, pw_plan->no_a_elems);
+
+if(state == _STATE_ERROR)
+{
+    return state;
+}
+
+#if RP_HOST
+hostToNodesIntArrays(plan->slot_elem_idx, plan->no_slots_per_node,
+                     &pw_plan->slot_elem_idx_node, &pw_plan->no_slots_node);
+#endif
+
+#if RP_NODE
+state = hostToNodesIntArrays(NULL, NULL, &pw_plan->slot_elem_idx_node,
+                             &pw_plan->no_slots_node);
+
+if(state != _STATE_ERROR && pw_plan->no_slots_node != plan->no_slots_node)
+{
+    state = _STATE_ERROR;
+}
+
+for(k = 0; k < pw_plan->no_slots_node && state != _STATE_ERROR; ++k)
+{
+    if(
+        pw_plan->slot_elem_idx_node[k] < 0 ||
+        pw_plan->slot_elem_idx_node[k] >= pw_plan->no_a_elems ||
+        (k > 0 &&
+         pw_plan->slot_elem_idx_node[k] <= pw_plan->slot_elem_idx_node[k - 1])
+      )
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (initF2AParallelWritePlanOfCellZone()): Wrong element "
+            "slots for zone id %i on node %i!\n", fluid_zone_id, myid);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state == _STATE_ERROR)
+{
+    freeF2AParallelWritePlan(pw_plan);
+}
+
+return state;
+}
+
+
+int exchangeParallelWrittenPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AParallelWritePlan *pw_plan,
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                          )
+{
+/*
+    Writes the ANSYS element values of an F2A_AGG_PICK zone without the
+    host: node 0 preallocates the part file of f2a_vol_prop_file, all nodes
+    write the records of their elements at fixed offsets and node 0 renames
+    the complete file to f2a_vol_prop_file. The part file is used also
+    without XC_ATOMIC_PUBLISH, ANSYS would see the preallocated file
+    otherwise. The exchange folder has to be on a file system shared by all
+    compute nodes.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+char part_file[XC_PART_FILENAME_SIZE];
+
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+xreal *node_vals = NULL;
+xreal *node_partials = NULL;
+int no_node_vals = 0;
+#endif
+
+sprintf(part_file, "%.250s%s", f2a_vol_prop_file, XC_PART_FILE_SUFFIX);
+
+#if RP_NODE
+t = Lookup_Thread(domain, fluid_zone_id);
+no_node_vals = THREAD_N_ELEMENTS_INT(t);
+node_vals = (xreal *) calloc(no_node_vals + 1, sizeof(xreal));
+node_partials = (xreal *) calloc(plan->no_slots_node + 1, sizeof(xreal));
+
+if(node_vals == NULL || node_partials == NULL)
+{
+    Message("Error (exchangeParallelWrittenPropertyF2AZone()): Memory "
+            "allocation error on node %i!\n", myid);
+    state = _STATE_ERROR;
+}
+else
+{
+    nodeGatherCellXValues(node_vals, C_VAL_WRAPPER_FUN, t);
+
+    aggregateNodeValuesToSlots(plan, node_vals, no_node_vals, node_partials);
+}
+
+free(node_vals);
+
+if(I_AM_NODE_ZERO_P && state != _STATE_ERROR)
+{
+    state = preallocateF2AFile(part_file, pw_plan->no_a_elems);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+#if RP_NODE
+if(state != _STATE_ERROR)
+{
+    state = writeF2ARecordsOfNode(part_file, pw_plan, node_partials);
+}
+
+free(node_partials);
+#endif
+
+state = reduceStateOverProcesses(state);
+
+#if RP_NODE
+if(I_AM_NODE_ZERO_P)
+{
+    state = renameExchangeFile(part_file, f2a_vol_prop_file, state);
+}
+#endif
+
+state = reduceStateOverProcesses(state);
+
+#if RP_HOST
+if(state != _STATE_ERROR)
+{
+    Message("Info (exchangeParallelWrittenPropertyF2AZone()): For zone id %i, "
+            "done!\n", fluid_zone_id);
+}
+#endif
+
+return state;
+}
+
+
+void freeF2AParallelWritePlan(F2AParallelWritePlan *pw_plan)
+{
+    if(pw_plan == NULL)
+    {
+        return;
+    }
+
+    free(pw_plan->slot_elem_idx_node);
+
+    pw_plan->slot_elem_idx_node = NULL;
+    pw_plan->no_slots_node = 0;
+}
@@ -0,0 +1,54 @@
+/*
+Parallel output of the F2A file: every compute node writes the fixed width
+records of its ANSYS elements directly into the preallocated file (see
+F2A_PARALLEL_WRITE in vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_PARALLEL_WRITE_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_f2a_aggregation.h"
+#include "vof_pc_host_streaming.h"
+#define VOF_PC_PARALLEL_WRITE_H
+
+/*
+With F2A_AGG_PICK every ANSYS element has exactly one slot on one compute
+node, so each node owns the records of its slot elements. Every node holds
+the (ascending) element indices of its slots.
+*/
+typedef struct f2a_parallel_write_plan_struct
+{
+    int no_a_elems;
+
+    /* compute nodes */
+    int no_slots_node;
+    int *slot_elem_idx_node;
+} F2AParallelWritePlan;
+
+
+int initF2AParallelWritePlanOfCellZone(
+                                        F2AParallelWritePlan *pw_plan,
+                                        F2AAggregationPlan *plan,
+                                        int fluid_zone_id
+                                      );
+
+int exchangeParallelWrittenPropertyF2AZone(
+                                        char f2a_vol_prop_file[],
+                                        F2AParallelWritePlan *pw_plan,
+                                        F2AAggregationPlan *plan,
+                                        real (*C_VAL_WRAPPER_FUN)(cell_t, Thread*),
+                                        int fluid_zone_id
+                                          );
+
+void freeF2AParallelWritePlan(F2AParallelWritePlan *pw_plan);
+
+#endif
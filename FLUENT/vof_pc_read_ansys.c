@@ -13,6 +13,647 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 #include "vof_pc_read_ansys.h"
 
+#if LINUX
+#include "fcntl.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#endif
+#include "float.h"
+
+/* longest number passed to strtod() by parseAnsysReal() */
+#define ANSYS_TABLE_MAX_TOKEN 63
+
+/*
+ANSYS output file mapped into memory (LINUX) or read into memory as a whole,
+parsed in one pass by parseAnsysTableRows()
+*/
+typedef struct ansys_table_struct
+{
+    char *data;
+    long size;
+} AnsysTable;
+
+#if RP_HOST || NODE_ZERO_IO
+/* powers of ten which are exact in double precision */
+static const double _g_exact_pow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static int openAnsysTable(AnsysTable *table, char filename[])
+{
+/*
+    Maps filename read only into memory, on other systems than LINUX it is
+    read into a buffer of the file size.
+*/
+#if LINUX
+int fd = -1;
+struct stat st;
+void *data;
+#else
+FILE *fp = NULL;
+#endif
+
+table->data = NULL;
+table->size = 0;
+
+#if LINUX
+fd = open(filename, O_RDONLY);
+
+if(fd < 0)
+{
+    return _STATE_ERROR;
+}
+
+if(fstat(fd, &st) != 0)
+{
+    close(fd);
+    return _STATE_ERROR;
+}
+
+table->size = (long) st.st_size;
+
+if(table->size > 0)
+{
+    data = mmap(NULL, (size_t) table->size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if(data == MAP_FAILED)
+    {
+        close(fd);
+        table->size = 0;
+        return _STATE_ERROR;
+    }
+
+    madvise(data, (size_t) table->size, MADV_SEQUENTIAL);
+    table->data = (char *) data;
+}
+
+close(fd);
+#else
+fp = fopen(filename, "rb");
+
+if(fp == NULL)
+{
+    return _STATE_ERROR;
+}
+
+fseek(fp, 0, SEEK_END);
+table->size = ftell(fp);
+fseek(fp, 0, SEEK_SET);
+
+if(table->size > 0)
+{
+    table->data = (char *) malloc((size_t) table->size);
+
+    if(
+        table->data == NULL ||
+        fread(table->data, 1, (size_t) table->size, fp) != (size_t) table->size
+      )
+    {
+        free(table->data);
+        table->data = NULL;
+        table->size = 0;
+        fclose(fp);
+        return _STATE_ERROR;
+    }
+}
+else
+{
+    table->size = 0;
+}
+
+fclose(fp);
+#endif
+
+return _STATE_OK;
+}
+
+
+static void closeAnsysTable(AnsysTable *table)
+{
+#if LINUX
+    if(table->data != NULL)
+    {
+        munmap(table->data, (size_t) table->size);
+    }
+#else
+    free(table->data);
+#endif
+    table->data = NULL;
+    table->size = 0;
+}
+
+
+static int isAnsysTableSpace(char ch)
+{
+    return (ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' ||
+            ch == '\v' || ch == '\f');
+}
+
+
+static const char *parseAnsysRealToken(
+                                        const char *pos,
+                                        const char *end,
+                                        real *val
+                                      )
+{
+/*
+    strtod()/strtof() of the token at pos, returns the position after the
+    number or NULL if there is none.
+*/
+char buf[ANSYS_TABLE_MAX_TOKEN + 1];
+char *buf_end = NULL;
+int len = 0;
+
+while(pos + len < end && len < ANSYS_TABLE_MAX_TOKEN && !isAnsysTableSpace(pos[len]))
+{
+    buf[len] = pos[len];
+    ++len;
+}
+buf[len] = '\0';
+
+if(IS_SINGLE_PRECISION)
+{
+    (*val) = (real) strtof(buf, &buf_end);
+}
+else
+{
+    (*val) = (real) strtod(buf, &buf_end);
+}
+
+return (buf_end == buf) ? NULL : pos + (buf_end - buf);
+}
+
+
+static const char *parseAnsysReal(const char *pos, const char *end, real *val)
+{
+/*
+    Parses the number at pos to the same value as fscanf(" %lE") resp. " %e"
+    and returns the position after it, NULL if there is none. Decimal numbers
+    of up to 15 significant digits and a power of ten of at most 22 (e.g. all
+    E15.7 values) are exact in double precision as integer mantissa times or
+    divided by an exact power of ten. Other numbers, and single precision
+    values which lie exactly in between two floats, are passed to strtod() or
+    strtof().
+*/
+const char *start = pos;
+unsigned long long mantissa = 0;
+int no_sig_digits = 0;
+int any_digit = 0;
+int exp10 = 0;
+int exp_val = 0;
+int exp_negative = 0;
+int negative = 0;
+const char *exp_pos;
+double dval;
+float fval;
+float fnext;
+
+if(pos < end && (*pos == '+' || *pos == '-'))
+{
+    negative = (*pos == '-');
+    ++pos;
+}
+
+while(pos < end && *pos >= '0' && *pos <= '9')
+{
+    any_digit = 1;
+    if(mantissa > 0 || *pos != '0')
+    {
+        mantissa = mantissa * 10 + (unsigned long long) (*pos - '0');
+        ++no_sig_digits;
+    }
+    ++pos;
+}
+
+if(pos < end && *pos == '.')
+{
+    ++pos;
+    while(pos < end && *pos >= '0' && *pos <= '9')
+    {
+        any_digit = 1;
+        if(mantissa > 0 || *pos != '0')
+        {
+            mantissa = mantissa * 10 + (unsigned long long) (*pos - '0');
+            ++no_sig_digits;
+        }
+        --exp10;
+        ++pos;
+    }
+}
+
+if(pos < end && (*pos == 'e' || *pos == 'E'))
+{
+    exp_pos = pos + 1;
+
+    if(exp_pos < end && (*exp_pos == '+' || *exp_pos == '-'))
+    {
+        exp_negative = (*exp_pos == '-');
+        ++exp_pos;
+    }
+
+    if(exp_pos < end && *exp_pos >= '0' && *exp_pos <= '9')
+    {
+        pos = exp_pos;
+        while(pos < end && *pos >= '0' && *pos <= '9' && exp_val < 10000)
+        {
+            exp_val = exp_val * 10 + (*pos - '0');
+            ++pos;
+        }
+        exp10 += exp_negative ? -exp_val : exp_val;
+    }
+}
+
+if(
+    !any_digit || no_sig_digits > 15 || exp10 < -22 || exp10 > 22 ||
+    (pos < end && !isAnsysTableSpace(*pos))
+  )
+{
+    return parseAnsysRealToken(start, end, val);
+}
+
+dval = (double) mantissa;
+dval = (exp10 < 0) ? dval / _g_exact_pow10[-exp10] : dval * _g_exact_pow10[exp10];
+dval = negative ? -dval : dval;
+
+if(IS_SINGLE_PRECISION)
+{
+    if(dval != 0.0 && (fabs(dval) < FLT_MIN || fabs(dval) > FLT_MAX))
+    {
+        return parseAnsysRealToken(start, end, val);
+    }
+
+    /* rounding the double is exact unless it is a midpoint of two floats */
+    fval = (float) dval;
+    if((double) fval != dval)
+    {
+        fnext = nextafterf(fval, (dval > fval) ? FLT_MAX : -FLT_MAX);
+
+        if(dval - (double) fval == (double) fnext - dval)
+        {
+            return parseAnsysRealToken(start, end, val);
+        }
+    }
+}
+
+(*val) = (real) dval;
+
+return pos;
+}
+
+
+static int parseAnsysTableRows(
+                                const char **pos,
+                                const char *end,
+                                int no_cols,
+                                real *cols[],
+                                int stride,
+                                int first_row,
+                                int max_rows
+                              )
+{
+/*
+    Parses rows of no_cols whitespace separated numbers from *pos on, value
+    k of row i goes to cols[k][i * stride], starting with row first_row, until
+    max_rows rows are reached or no further complete row follows. Like a loop
+    of fscanf() line breaks are not distinguished from other whitespace.
+    Returns the number of parsed rows, *pos is behind the last one.
+*/
+const char *p = *pos;
+int i = first_row;
+int k;
+real val[A2F_MAX_COLUMNS];
+
+while(i < max_rows)
+{
+    for(k = 0; k < no_cols; ++k)
+    {
+        while(p < end && isAnsysTableSpace(*p))
+        {
+            ++p;
+        }
+
+        if(p >= end || (p = parseAnsysReal(p, end, &val[k])) == NULL)
+        {
+            return i - first_row;
+        }
+    }
+
+    for(k = 0; k < no_cols; ++k)
+    {
+        if(cols[k] != NULL)
+        {
+            cols[k][i * stride] = val[k];
+        }
+    }
+
+    (*pos) = p;
+    ++i;
+}
+
+return i - first_row;
+}
+
+
+static int hasAnsysTableMoreRows(const char *pos, const char *end)
+{
+    real val;
+
+    while(pos < end && isAnsysTableSpace(*pos))
+    {
+        ++pos;
+    }
+
+    return (pos < end && parseAnsysReal(pos, end, &val) != NULL);
+}
+
+
+/*
+Line aligned part of an ANSYS table, parsed by a task of the thread pool
+into the rows first_row to first_row + no_rows - 1 of the output arrays
+*/
+typedef struct ansys_table_chunk_struct
+{
+    const char *begin;
+    const char *end;
+    int first_row;
+    int no_rows;
+    int no_cols;
+    real **cols;
+    int stride;
+    int state;
+} AnsysTableChunk;
+
+
+static void countAnsysTableChunkRowsTask(void *arg)
+{
+/*
+    Counts the lines of the chunk which are not blank, one row each.
+*/
+AnsysTableChunk *chunk = (AnsysTableChunk *) arg;
+const char *pos = chunk->begin;
+const char *eol;
+
+chunk->no_rows = 0;
+
+while(pos < chunk->end)
+{
+    eol = (const char *) memchr(pos, '\n', (size_t) (chunk->end - pos));
+    eol = (eol != NULL) ? eol : chunk->end;
+
+    while(pos < eol && isAnsysTableSpace(*pos))
+    {
+        ++pos;
+    }
+    if(pos < eol)
+    {
+        ++chunk->no_rows;
+    }
+
+    pos = eol + 1;
+}
+}
+
+
+static void parseAnsysTableChunkTask(void *arg)
+{
+/*
+    Parses the rows of the chunk, which must consist of exactly the counted
+    rows, otherwise its state is set to _STATE_ERROR.
+*/
+AnsysTableChunk *chunk = (AnsysTableChunk *) arg;
+const char *pos = chunk->begin;
+
+chunk->state = _STATE_OK;
+
+if(
+    parseAnsysTableRows(&pos, chunk->end, chunk->no_cols, chunk->cols,
+                        chunk->stride, chunk->first_row,
+                        chunk->first_row + chunk->no_rows) != chunk->no_rows
+  )
+{
+    chunk->state = _STATE_ERROR;
+}
+
+while(pos < chunk->end && isAnsysTableSpace(*pos))
+{
+    ++pos;
+}
+
+if(pos < chunk->end)
+{
+    chunk->state = _STATE_ERROR;
+}
+}
+
+
+static int splitAnsysTable(
+                            AnsysTable *table,
+                            int no_cols,
+                            AnsysTableChunk **chunks
+                          )
+{
+/*
+    Splits the table into line aligned chunks of about ANSYS_TABLE_CHUNK_SIZE
+    bytes and counts the rows of all chunks concurrently, the rows of a chunk
+    follow those of the chunks before (prefix sum). Returns the number of
+    chunks, 0 if the table is not parsed in chunks (too small, no thread pool
+    or memory).
+*/
+ThreadTaskGroup group;
+const char *end = table->data + table->size;
+const char *pos;
+int no_chunks = 0;
+int i;
+
+(*chunks) = NULL;
+
+if(!ANSYS_PARALLEL_PARSE || threadPoolSize() < 1)
+{
+    return 0;
+}
+
+no_chunks = (int) (table->size / ANSYS_TABLE_CHUNK_SIZE);
+no_chunks = (no_chunks < VOF_PC_THREAD_QUEUE_SIZE) ? no_chunks : VOF_PC_THREAD_QUEUE_SIZE;
+
+if(no_chunks < 2)
+{
+    return 0;
+}
+
+(*chunks) = (AnsysTableChunk *) calloc(no_chunks, sizeof(AnsysTableChunk));
+
+if((*chunks) == NULL)
+{
+    return 0;
+}
+
+pos = table->data;
+for(i = 0; i < no_chunks; ++i)
+{
+    (*chunks)[i].begin = pos;
+
+    if(i < no_chunks - 1)
+    {
+        pos = table->data + (table->size / no_chunks) * (i + 1);
+        pos = (pos < (*chunks)[i].begin) ? (*chunks)[i].begin : pos;
+        pos = (const char *) memchr(pos, '\n', (size_t) (end - pos));
+        pos = (pos != NULL) ? pos + 1 : end;
+    }
+    else
+    {
+        pos = end;
+    }
+
+    (*chunks)[i].end = pos;
+    (*chunks)[i].no_cols = no_cols;
+}
+
+initThreadTaskGroup(&group);
+for(i = 0; i < no_chunks; ++i)
+{
+    submitThreadTask(&group, countAnsysTableChunkRowsTask, &(*chunks)[i]);
+}
+waitThreadTaskGroup(&group);
+
+for(i = 1; i < no_chunks; ++i)
+{
+    (*chunks)[i].first_row = (*chunks)[i-1].first_row + (*chunks)[i-1].no_rows;
+}
+
+return no_chunks;
+}
+
+
+static int parseAnsysTableChunks(
+                                    AnsysTableChunk *chunks,
+                                    int no_chunks,
+                                    real *cols[],
+                                    int stride
+                                )
+{
+/*
+    Parses all chunks concurrently, returns _STATE_ERROR if any chunk does
+    not consist of exactly its counted rows (e.g. rows spanning lines), the
+    table then has to be parsed as a whole.
+*/
+ThreadTaskGroup group;
+int state = _STATE_OK;
+int i;
+
+initThreadTaskGroup(&group);
+for(i = 0; i < no_chunks; ++i)
+{
+    chunks[i].cols = cols;
+    chunks[i].stride = stride;
+    submitThreadTask(&group, parseAnsysTableChunkTask, &chunks[i]);
+}
+waitThreadTaskGroup(&group);
+
+for(i = 0; i < no_chunks; ++i)
+{
+    if(chunks[i].state == _STATE_ERROR)
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+return state;
+}
+
+
+static int parseAnsysTable(
+                            AnsysTable *table,
+                            int no_cols,
+                            real *cols[],
+                            int stride,
+                            int max_rows,
+                            int *more_rows
+                          )
+{
+/*
+    Parses the table into max_rows rows at most (see parseAnsysTableRows()),
+    in chunks on the thread pool if possible. more_rows is set if the table
+    has further rows. Returns the number of parsed rows.
+*/
+AnsysTableChunk *chunks = NULL;
+const char *pos = table->data;
+int no_chunks;
+int no_rows = 0;
+
+(*more_rows) = 0;
+
+no_chunks = splitAnsysTable(table, no_cols, &chunks);
+
+if(no_chunks > 0)
+{
+    no_rows = chunks[no_chunks-1].first_row + chunks[no_chunks-1].no_rows;
+
+    if(
+        no_rows <= max_rows &&
+        parseAnsysTableChunks(chunks, no_chunks, cols, stride) == _STATE_OK
+      )
+    {
+        free(chunks);
+        return no_rows;
+    }
+}
+
+free(chunks);
+
+no_rows = parseAnsysTableRows(&pos, table->data + table->size, no_cols, cols,
+                              stride, 0, max_rows);
+
+(*more_rows) = hasAnsysTableMoreRows(pos, table->data + table->size);
+
+return no_rows;
+}
+#endif /* RP_HOST || NODE_ZERO_IO */
+
+
+int readAnsysTableColumns(
+                            char filename[],
+                            int no_cols,
+                            real *cols[],
+                            int stride,
+                            int max_rows,
+                            int *no_rows,
+                            int *more_rows
+                         )
+{
+/*
+    Reads the text table filename into max_rows rows at most, value k of row
+    i to cols[k][i * stride] (the text backend of vof_pc_exchange_backend.c).
+*/
+int state = _STATE_OK;
+
+#if RP_HOST || NODE_ZERO_IO
+AnsysTable table;
+#endif
+
+(*no_rows) = 0;
+(*more_rows) = 0;
+
+#if RP_HOST || NODE_ZERO_IO
+if(openAnsysTable(&table, filename) != _STATE_OK)
+{
+    state = _STATE_ERROR;
+}
+else
+{
+    (*no_rows) = parseAnsysTable(&table, no_cols, cols, stride, max_rows,
+                                 more_rows);
+    closeAnsysTable(&table);
+}
+#else
+state = _STATE_ERROR;
+#endif
+
+return state;
+}
+
+
 int readElemValueVecFromAnsysOut(
                                     char filename[],
                                     real (**e_vec_prop)[ND_ND],
@@ -21,105 +662,52 @@ int readElemValueVecFromAnsysOut(
 {
 int state = _STATE_OK;
 
-#if RP_HOST
-FILE *fp;
-int i = 0;
+#if RP_HOST || NODE_ZERO_IO
+const XCBackend *backend = xcBackend(xcFormatOfFile(filename));
+XCFile file;
+real *cols[ND_ND];
+int no_rows = 0;
+int more_rows = 0;
+int k;
 *e_vec_prop = NULL;
 *e_vec_prop = (real (*)[ND_ND]) calloc(ND_ND * no_e, sizeof(real));
 
 if(*e_vec_prop == NULL)
 {
-    Message("Error (readElemValueVecFromAnsysOut()):  Memory "
+    threadMessage("Error (readElemValueVecFromAnsysOut()):  Memory "
             "allocation error!Not enough Memory? \n");
     state = _STATE_ERROR;
 }
 else
 {
-    if ((fp = fopen(filename, "r")) == NULL)
+    file.backend = backend;
+
+    if (backend->open(&file, filename, XC_READ) != _STATE_OK)
     {
-        Message("Error (readElemValueVecFromAnsysOut()): Unable to "
+        threadMessage("Error (readElemValueVecFromAnsysOut()): Unable to "
                 "open %s, create Ansys output first!\n", filename);
         state = _STATE_ERROR;
     }
     else
     {
-        Message("Reading %i vector properties from file %s\n", no_e, filename);
+        threadMessage("Reading %i vector properties from file %s\n", no_e, filename);
 
-        #if RP_3D
-        if (IS_SINGLE_PRECISION) 
-        {
-            while(fscanf(fp, " %e %e %e",    &(*e_vec_prop)[i][0], 
-                                            &(*e_vec_prop)[i][1],
-                                            &(*e_vec_prop)[i][2]
-                        ) == 3)
-            {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueVecFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    state = _STATE_ERROR;
-                    break;
-                }
-            }
-        } 
-        else 
+        for(k = 0; k < ND_ND; ++k)
         {
-            while(fscanf(fp, " %lE %lE %lE",&(*e_vec_prop)[i][0], 
-                                            &(*e_vec_prop)[i][1],
-                                            &(*e_vec_prop)[i][2]
-                        ) == 3)
-            {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueVecFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    break;
-                }
-            }
+            cols[k] = &(*e_vec_prop)[0][k];
         }
-        #else
-        if (IS_SINGLE_PRECISION) 
-        {
-            while(fscanf(fp, " %e %e",   &(*e_vec_prop)[i][0], 
-                                        &(*e_vec_prop)[i][1]
-                ) == 2)
-            {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueVecFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    break;
-                }
-            }
-        } 
-        else 
+
+        state = backend->readField(&file, cols, ND_ND, ND_ND, no_e, &no_rows,
+                                   &more_rows);
+
+        if(more_rows)
         {
-            while(fscanf(fp, " %lE %lE", &(*e_vec_prop)[i][0], 
-                                        &(*e_vec_prop)[i][1]
-                        ) == 2)
-            {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueVecFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    break;
-                }
-            }
+            threadMessage("Warning (readElemValueVecFromAnsysOut()): "
+                    "Reading %s, file has more lines than there is space "
+                    "in coupling arrays", filename);
+            state = _STATE_ERROR;
         }
-        #endif
-        fclose(fp);
+        backend->commit(&file);
     }
 }
 #endif
@@ -135,203 +723,442 @@ int readElemValueAndVolumeFromAnsysOut(
                                             int no_e
                                         )
 {
+/*
+    Reads the value and volume column of filename, only the value column if
+    e_vol is NULL. The file may then still hold the volume column, which is
+    skipped.
+*/
 int state = _STATE_OK;
-#if RP_HOST
-FILE *fp;
-int i = 0;
+#if RP_HOST || NODE_ZERO_IO
+const XCBackend *backend = xcBackend(xcFormatOfFile(filename));
+XCFile file;
+real *cols[2];
+int no_cols = 1;
+int no_rows = 0;
+int more_rows = 0;
 *e_prop = NULL;
 (*e_prop) = (real *) calloc(no_e, sizeof(real));
-*e_vol = NULL;
-(*e_vol) = (real *) calloc(no_e, sizeof(real));
+if(e_vol != NULL)
+{
+    *e_vol = NULL;
+    (*e_vol) = (real *) calloc(no_e, sizeof(real));
+}
 
-if( *e_prop == NULL || *e_vol == NULL)
+if( *e_prop == NULL || (e_vol != NULL && *e_vol == NULL))
 {
-    Message("Error (readElemValueAndVolumeFromAnsysOut()):  Memory "
+    threadMessage("Error (readElemValueAndVolumeFromAnsysOut()):  Memory "
             "allocation error!Not enough Memory? \n");
     state = _STATE_ERROR;
 }
 else
 {
-    if ((fp = fopen(filename, "r")) == NULL)
+    file.backend = backend;
+
+    if (backend->open(&file, filename, XC_READ) != _STATE_OK)
     {
-        Message("Error (readElemValueAndVolumeFromAnsysOut()): Unable to "
+        threadMessage("Error (readElemValueAndVolumeFromAnsysOut()): Unable to "
                 "open %s, create Ansys output first!\n", filename);
         state = _STATE_ERROR;
     }
     else
     {
-        Message("Reading %i volume properties from file %s\n",no_e, filename);
+        threadMessage("Reading %i volume properties from file %s\n",no_e, filename);
+
+        cols[0] = (*e_prop);
+        cols[1] = (e_vol != NULL) ? (*e_vol) : NULL;
+        no_cols = (e_vol != NULL || file.no_cols >= 2) ? 2 : 1;
 
-        if (IS_SINGLE_PRECISION) 
+        state = backend->readField(&file, cols, no_cols, 1, no_e, &no_rows,
+                                   &more_rows);
+
+        if(more_rows)
         {
-            while(fscanf(fp, " %e %e", &(*e_prop)[i],&(*e_vol)[i]) == 2)
-            {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueAndVolumeFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    state = _STATE_ERROR;
-                    break;
-                }
-            }
-        } 
-        else 
+            threadMessage("Warning (readElemValueAndVolumeFromAnsysOut()): "
+                    "Reading %s, file has more lines than there is space "
+                    "in coupling arrays", filename);
+            state = _STATE_ERROR;
+        }
+        backend->commit(&file);
+    }
+}
+#endif
+return state;
+}
+
+
+int readMergedElemValuesFromAnsysOut(
+                                        char filename[],
+                                        const int columns[],
+                                        int no_cols,
+                                        real **e_prop,
+                                        real **e_vol,
+                                        real (**e_vec_prop)[ND_ND],
+                                        int no_e
+                                    )
+{
+/*
+    Reads all columns of the merged A2F file filename in one pass and sorts
+    them by columns[] (see enum a2fColumns) into e_prop, e_vol and, if
+    e_vec_prop is not NULL, e_vec_prop. The value and volume column are
+    required, so are the ND_ND vector columns if e_vec_prop is given.
+    Without e_vol (volumes kept from an earlier file) the volume column is
+    skipped, the file may then also leave it out (one column less than
+    no_cols, the following columns move up).
+*/
+int state = _STATE_OK;
+#if RP_HOST || NODE_ZERO_IO
+const XCBackend *backend = xcBackend(xcFormatOfFile(filename));
+XCFile file;
+real *rows = NULL;
+real *cols[A2F_MAX_COLUMNS];
+int file_columns[A2F_MAX_COLUMNS];
+int no_file_cols = 0;
+int no_found[A2F_COL_VEC_Z + 1];
+int no_rows = 0;
+int more_rows = 0;
+int i, k;
+real *dst;
+int dst_stride;
+#endif
+
+*e_prop = NULL;
+if(e_vol != NULL)
+{
+    *e_vol = NULL;
+}
+if(e_vec_prop != NULL)
+{
+    *e_vec_prop = NULL;
+}
+
+#if RP_HOST || NODE_ZERO_IO
+memset(no_found, 0, sizeof(no_found));
+
+for(k = 0; k < no_cols && k < A2F_MAX_COLUMNS; ++k)
+{
+    if(columns[k] >= A2F_COL_SKIP && columns[k] <= A2F_COL_VEC_Z)
+    {
+        ++no_found[columns[k]];
+    }
+}
+
+if(
+    no_cols < 2 || no_cols > A2F_MAX_COLUMNS ||
+    no_found[A2F_COL_VALUE] != 1 || no_found[A2F_COL_VOLUME] != 1 ||
+    (e_vec_prop != NULL &&
+     (no_found[A2F_COL_VEC_X] != 1 || no_found[A2F_COL_VEC_Y] != 1 ||
+      (ND_ND == 3 && no_found[A2F_COL_VEC_Z] != 1)))
+  )
+{
+    threadMessage("Error (readMergedElemValuesFromAnsysOut()): Wrong columns for "
+            "%s!\n", filename);
+    return _STATE_ERROR;
+}
+
+rows = (real *) calloc(no_cols * no_e + 1, sizeof(real));
+(*e_prop) = (real *) calloc(no_e + 1, sizeof(real));
+if(e_vol != NULL)
+{
+    (*e_vol) = (real *) calloc(no_e + 1, sizeof(real));
+}
+if(e_vec_prop != NULL)
+{
+    *e_vec_prop = (real (*)[ND_ND]) calloc(ND_ND * no_e + 1, sizeof(real));
+}
+
+if(
+    rows == NULL || *e_prop == NULL || (e_vol != NULL && *e_vol == NULL) ||
+    (e_vec_prop != NULL && *e_vec_prop == NULL)
+  )
+{
+    threadMessage("Error (readMergedElemValuesFromAnsysOut()):  Memory "
+            "allocation error!Not enough Memory? \n");
+    state = _STATE_ERROR;
+}
+else
+{
+    file.backend = backend;
+
+    if (backend->open(&file, filename, XC_READ) != _STATE_OK)
+    {
+        threadMessage("Error (readMergedElemValuesFromAnsysOut()): Unable to "
+                "open %s, create Ansys output first!\n", filename);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        for(k = 0; k < no_cols; ++k)
         {
-            while(fscanf(fp, " %lE %lE", &(*e_prop)[i],&(*e_vol)[i]) == 2)
+            if(
+                columns[k] != A2F_COL_VOLUME || e_vol != NULL ||
+                file.no_cols != no_cols - 1
+              )
             {
-                ++i;
-
-                if(i > no_e)
-                {
-                    Message("Warning (readElemValueAndVolumeFromAnsysOut()): "
-                            "Reading %s, file has more lines than there is space "
-                            "in coupling arrays", filename);
-                    break;
-                }
+                file_columns[no_file_cols] = columns[k];
+                cols[no_file_cols] = &rows[no_file_cols];
+                ++no_file_cols;
             }
         }
-        fclose(fp);
+
+        threadMessage("Reading %i elements with %i columns from file %s\n", no_e,
+                no_file_cols, filename);
+
+        state = backend->readField(&file, cols, no_file_cols, no_file_cols,
+                                   no_e, &no_rows, &more_rows);
+
+        if(more_rows)
+        {
+            threadMessage("Warning (readMergedElemValuesFromAnsysOut()): "
+                    "Reading %s, file has more lines than there is space "
+                    "in coupling arrays", filename);
+            state = _STATE_ERROR;
+        }
+        backend->commit(&file);
     }
 }
+
+for(k = 0; k < no_file_cols && state != _STATE_ERROR; ++k)
+{
+    dst = NULL;
+    dst_stride = 1;
+
+    if(file_columns[k] == A2F_COL_VALUE)
+    {
+        dst = (*e_prop);
+    }
+    else if(file_columns[k] == A2F_COL_VOLUME && e_vol != NULL)
+    {
+        dst = (*e_vol);
+    }
+    else if(
+            e_vec_prop != NULL && file_columns[k] >= A2F_COL_VEC_X &&
+            file_columns[k] - A2F_COL_VEC_X < ND_ND
+           )
+    {
+        dst = &(*e_vec_prop)[0][file_columns[k] - A2F_COL_VEC_X];
+        dst_stride = ND_ND;
+    }
+
+    for(i = 0; dst != NULL && i < no_rows; ++i)
+    {
+        dst[i * dst_stride] = rows[i * no_file_cols + k];
+    }
+}
+
+free(rows);
 #endif
+
 return state;
 }
 
 
-
 int readCoordinatesFromAnsysOut(
                                 char filename[],
                                 real (**coord_arr_ansys)[ND_ND],
                                 int *size_coord_arr_ansys
                             )
 {
-    /* Where is the error? */
-    FILE *fp = NULL;
+/*
+    Reads all element coordinates of filename. If the table is parsed in
+    chunks the array is sized by their row count, otherwise by the length of
+    the first row and grown while parsing.
+*/
     int state = _STATE_OK;
-    real dummy;
-    int i = 0;
+
+    #if RP_HOST || NODE_ZERO_IO
+    AnsysTable table;
+    const char *pos = NULL;
+    const char *end = NULL;
+    const char *eol = NULL;
+    real (*arr)[ND_ND] = NULL;
+    real *cols[ND_ND];
+    AnsysTableChunk *chunks = NULL;
+    int no_chunks = 0;
+    int parsed = 0;
     int ansys_elements = 0;
+    int capacity = 0;
+    int k;
+    #endif
 
-    state = countLinesOfFile(filename, &ansys_elements);
     (*coord_arr_ansys) = NULL;
+    (*size_coord_arr_ansys) = 0;
 
-    if (state != _STATE_ERROR)
+    #if RP_HOST || NODE_ZERO_IO
+    if (openAnsysTable(&table, filename) != _STATE_OK)
     {
-        (*coord_arr_ansys) = (real (*)[ND_ND]) calloc(ND_ND * ansys_elements, sizeof(real));
+        threadMessage("Error (readCoordinatesAnsysAllOut()): Unable to "
+            "open %s, create Ansys output first!\n", filename);
+        return _STATE_ERROR;
     }
-    else
+
+    threadMessage("Info (readCoordinatesAnsysAllOut()):Reading element "
+            "coordinates from ANSYS table %s...\n", filename);
+
+    pos = table.data;
+    end = table.data + table.size;
+
+    no_chunks = splitAnsysTable(&table, ND_ND, &chunks);
+
+    if(no_chunks > 0)
     {
-        Message("Error (readCoordinatesAnsysAllOut()):  Error in "
-                "getAnsysElementCountFromFileLength().\n");
+        capacity = chunks[no_chunks-1].first_row + chunks[no_chunks-1].no_rows + 1;
+        (*coord_arr_ansys) = (real (*)[ND_ND]) malloc(ND_ND * capacity * sizeof(real));
+
+        if((*coord_arr_ansys) != NULL)
+        {
+            for(k = 0; k < ND_ND; ++k)
+            {
+                cols[k] = &(*coord_arr_ansys)[0][k];
+            }
+
+            if(parseAnsysTableChunks(chunks, no_chunks, cols, ND_ND) == _STATE_OK)
+            {
+                ansys_elements = capacity - 1;
+                parsed = 1;
+            }
+        }
     }
+    free(chunks);
 
-    if((*coord_arr_ansys) == NULL)
+    if(capacity < 1)
     {
-        Message("Error (readCoordinatesAnsysAllOut()): Memory "
-                "allocation error! Not enough Memory? \n");
-        state = _STATE_ERROR;
+        eol = (table.size > 0) ? (const char *) memchr(pos, '\n', (size_t) table.size) : NULL;
+        capacity = (eol != NULL) ? (int) (table.size / (eol - pos + 1)) + 1 : 1;
     }
-    else if (state != _STATE_ERROR)
+
+    while(!parsed && state != _STATE_ERROR)
     {
-        if ((fp = fopen(filename, "r")) == NULL)
+        arr = (real (*)[ND_ND]) realloc((*coord_arr_ansys),
+                                        ND_ND * capacity * sizeof(real));
+
+        if(arr == NULL)
         {
-            Message("Error (readCoordinatesAnsysAllOut()): Unable to "
-                "open %s, create Ansys output first!\n", filename);
+            threadMessage("Error (readCoordinatesAnsysAllOut()): Memory "
+                    "allocation error! Not enough Memory? \n");
             state = _STATE_ERROR;
+            break;
         }
-        else
+        (*coord_arr_ansys) = arr;
+
+        for(k = 0; k < ND_ND; ++k)
         {
-            Message("Info (readCoordinatesAnsysAllOut()):Reading element "
-                    "coordinates from ANSYS table %s...\n", filename);
+            cols[k] = &arr[0][k];
+        }
 
-            #if RP_3D
-            if (IS_SINGLE_PRECISION)
-            {
-                while(fscanf(fp, " %e %e %e", 
-                &(*coord_arr_ansys)[i][0], &(*coord_arr_ansys)[i][1], &(*coord_arr_ansys)[i][2]) == 3)
-                {
-                    ++i;
-
-                    if(i > ansys_elements)
-                    {
-                        Message("Warning (readCoordinatesAnsysAllOut()): "
-                        "Problem while reading file %s," 
-                        "count of read lines not equal to assumed element "
-                        "count please check file or function "
-                        "getAnsysElementCountFromFileLength()\n", filename);
-                        state = _STATE_ERROR;
-                        break;
-                    }
-                }
-                
-            } 
-            else 
-            {
-                while(fscanf(fp, " %lE %lE %lE",
-                &(*coord_arr_ansys)[i][0], &(*coord_arr_ansys)[i][1], &(*coord_arr_ansys)[i][2]) == 3)
-                {
-                    ++i;
-
-                    if(i > ansys_elements)
-                    {
-                        Message("Warning (readCoordinatesAnsysAllOut()): "
-                        "Problem while reading file %s," 
-                        "count of read lines not equal to assumed element "
-                        "count please check file or function "
-                        "getAnsysElementCountFromFileLength()\n", filename);
-                        state = _STATE_ERROR;
-                        break;
-                    }
-                }
-            }
-            #else 
-            if (IS_SINGLE_PRECISION) 
-            {
-                while(fscanf(fp, " %e %e", 
-                    &(*coord_arr_ansys)[i][0], &(*coord_arr_ansys)[i][1]) == 2)
-                {
-                    ++i;
-
-                    if(i > ansys_elements)
-                    {
-                        Message("Warning (readCoordinatesAnsysAllOut()): "
-                        "Problem while reading file %s," 
-                        "count of read lines not equal to assumed element "
-                        "count please check file or function "
-                        "getAnsysElementCountFromFileLength()\n", filename);
-                        state = _STATE_ERROR;
-                        break;
-                    }
-                }
-            } 
-            else 
-            {
-                while(fscanf(fp, " %lE %lE", 
-                    &(*coord_arr_ansys)[i][0], &(*coord_arr_ansys)[i][1]) == 2)
-                {
-                    ++i;
-
-                    if(i > ansys_elements)
-                    {
-                        Message("Warning (readCoordinatesAnsysAllOut()): "
-                        "Problem while reading file %s," 
-                        "count of read lines not equal to assumed element "
-                        "count please check file or function "
-                        "getAnsysElementCountFromFileLength()\n", filename);
-                        state = _STATE_ERROR;
-                        break;
-                    }
-                }
-            }
-            #endif
-           fclose(fp);
+        ansys_elements += parseAnsysTableRows(&pos, end, ND_ND, cols, ND_ND,
+                                              ansys_elements, capacity);
+
+        if(ansys_elements < capacity)
+        {
+            break;
         }
+        capacity *= 2;
+    }
+
+    closeAnsysTable(&table);
+
+    if(state == _STATE_ERROR)
+    {
+        free(*coord_arr_ansys);
+        (*coord_arr_ansys) = NULL;
+        ansys_elements = 0;
     }
+    else if(ansys_elements < 1)
+    {
+        threadMessage("Warning (readCoordinatesAnsysAllOut()): No element "
+                "coordinates in file %s!\n", filename);
+        state = _STATE_ERROR;
+    }
+
     (*size_coord_arr_ansys) = ansys_elements;
-    
+    #endif
 
     return state;
 }
+
+
+int openAnsysOutStream(
+                        AnsysOutStream *stream,
+                        char filename[],
+                        int no_cols
+                      )
+{
+/*
+    Opens an ANSYS output file with no_cols columns per element for reading
+    it in chunks of elements with readAnsysOutStreamChunk().
+*/
+int state = _STATE_OK;
+
+stream->fp = NULL;
+stream->filename = filename;
+stream->no_cols = no_cols;
+stream->no_rows_read = 0;
+
+#if RP_HOST
+if ((stream->fp = fopen(filename, "r")) == NULL)
+{
+    threadMessage("Error (openAnsysOutStream()): Unable to open %s, create Ansys "
+            "output first!\n", filename);
+    state = _STATE_ERROR;
+}
+#endif
+
+return state;
+}
+
+
+int readAnsysOutStreamChunk(
+                            AnsysOutStream *stream,
+                            real *chunk_arr,
+                            int no_rows
+                           )
+{
+/*
+    Reads the next no_rows elements of stream to chunk_arr, which must hold
+    no_rows * stream->no_cols values (row major). Returns _STATE_ERROR if
+    the file ends before.
+*/
+int state = _STATE_OK;
+
+#if RP_HOST
+int i, k;
+double val;
+
+if(stream->fp == NULL)
+{
+    return _STATE_ERROR;
+}
+
+for(i = 0; i < no_rows && state != _STATE_ERROR; ++i)
+{
+    for(k = 0; k < stream->no_cols; ++k)
+    {
+        if(fscanf(stream->fp, " %lE", &val) != 1)
+        {
+            threadMessage("Error (readAnsysOutStreamChunk()): File %s ends after "
+                    "%i elements!\n", stream->filename, stream->no_rows_read);
+            state = _STATE_ERROR;
+            break;
+        }
+        chunk_arr[i * stream->no_cols + k] = (real) val;
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        ++stream->no_rows_read;
+    }
+}
+#endif
+
+return state;
+}
+
+
+void closeAnsysOutStream(AnsysOutStream *stream)
+{
+    if(stream->fp != NULL)
+    {
+        fclose(stream->fp);
+        stream->fp = NULL;
+    }
+}
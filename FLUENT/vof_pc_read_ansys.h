@@ -13,20 +13,79 @@ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLI
 */
 #ifndef VOF_PC_READ_ANSYS_H
 #include "vof_pc_main.h"
+#include "vof_pc_threads.h"
+#include "vof_pc_exchange_backend.h"
 #define VOF_PC_READ_ANSYS_H
 
-int readJouleHeatAndLorentzForcesFromAnsysOut(
-                                                char filename[],
-                                                real (**lorentz_force)[ND_ND],
-                                                real **joule_heat,
-                                                int length_arr
-                                             );
+/* ANSYS output file read in chunks of elements (see openAnsysOutStream()) */
+typedef struct ansys_out_stream_struct
+{
+    FILE *fp;
+    char *filename;
+    int no_cols;
+    int no_rows_read;
+} AnsysOutStream;
 
-
-int readCoordinatesAnsysAllOut(
+int readElemValueVecFromAnsysOut(
                                     char filename[],
-                                    real (**coord_arr_ansys)[ND_ND],
-                                    int *size_coord_arr_ansys
+                                    real (**e_vec_prop)[ND_ND],
+                                    int no_e
                                 );
 
+int readElemValueAndVolumeFromAnsysOut(
+                                            char filename[],
+                                            real **e_prop,
+                                            real **e_vol,
+                                            int no_e
+                                        );
+
+/*
+Columns of a merged A2F file, e.g. the ANSYS_TO_FLUENT_OUT.DAT of
+apdl_example.ans is {A2F_COL_VALUE, A2F_COL_VEC_X, A2F_COL_VEC_Y,
+A2F_COL_VEC_Z, A2F_COL_VOLUME}. A2F_COL_VEC_Z is skipped in 2D.
+*/
+enum a2fColumns {A2F_COL_SKIP=0, A2F_COL_VALUE, A2F_COL_VOLUME,
+                 A2F_COL_VEC_X, A2F_COL_VEC_Y, A2F_COL_VEC_Z};
+#define A2F_MAX_COLUMNS 16
+
+int readMergedElemValuesFromAnsysOut(
+                                        char filename[],
+                                        const int columns[],
+                                        int no_cols,
+                                        real **e_prop,
+                                        real **e_vol,
+                                        real (**e_vec_prop)[ND_ND],
+                                        int no_e
+                                    );
+
+int readAnsysTableColumns(
+                            char filename[],
+                            int no_cols,
+                            real *cols[],
+                            int stride,
+                            int max_rows,
+                            int *no_rows,
+                            int *more_rows
+                         );
+
+int readCoordinatesFromAnsysOut(
+                                char filename[],
+                                real (**coord_arr_ansys)[ND_ND],
+                                int *size_coord_arr_ansys
+                            );
+
+int openAnsysOutStream(
+                        AnsysOutStream *stream,
+                        char filename[],
+                        int no_cols
+                      );
+
+int readAnsysOutStreamChunk(
+                            AnsysOutStream *stream,
+                            real *chunk_arr,
+                            int no_rows
+                           );
+
+void closeAnsysOutStream(AnsysOutStream *stream);
+
 #endif
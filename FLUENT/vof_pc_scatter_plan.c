@@ -0,0 +1,741 @@
+/*
+Scatter plans for distributing host arrays ordered by compute node and cell
+to the compute nodes. The cell ordering of each node is validated once at init
+against a hash, afterwards only the values are sent.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_scatter_plan.h"
+
+#if RP_HOST
+static int _g_scatter_plan_version = 0;
+#endif
+
+#if RP_NODE
+static unsigned int hashCellOrderingOfNode(Thread *t)
+{
+    cell_t c;
+    unsigned int hash = HASH_INIT;
+
+    hash = hashIntUpdate(hash, myid);
+    hash = hashIntUpdate(hash, THREAD_N_ELEMENTS_INT(t));
+
+    begin_c_loop_int(c, t)
+    {
+        hash = hashIntUpdate(hash, (int) c);
+    }
+    end_c_loop_int(c, t)
+
+    return hash;
+}
+#endif
+
+
+int initScatterPlanOfCellZone(
+                                ScatterPlan *plan,
+                                int *f_ordered_cids_zone,
+                                int *f_ordered_myids_zone,
+                                int *f_cells_per_node,
+                                int no_f_cells_zone,
+                                int fluid_zone_id
+                             )
+{
+/*
+    Computes the hash of the cell ordering of every compute node from the
+    ordering arrays on the host and sends version and hash to the nodes, which
+    validate it against their own cell loop once.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int *header_arr = NULL;
+int *header_per_node = NULL;
+int no_header = 0;
+
+#if RP_HOST
+int pe;
+int i = 0;
+int i_start = 0;
+unsigned int hash;
+#endif
+
+plan->version = 0;
+plan->cells_per_node = NULL;
+plan->node_hash = NULL;
+plan->validated_version = -1;
+plan->validated_hash = 0;
+
+#if RP_HOST
+++_g_scatter_plan_version;
+plan->version = _g_scatter_plan_version;
+
+plan->cells_per_node = (int *) calloc(compute_node_count, sizeof(int));
+plan->node_hash = (unsigned int *) calloc(compute_node_count, sizeof(unsigned int));
+header_arr = (int *) calloc(2 * compute_node_count, sizeof(int));
+header_per_node = (int *) calloc(compute_node_count, sizeof(int));
+
+if(
+    plan->cells_per_node == NULL || plan->node_hash == NULL ||
+    header_arr == NULL || header_per_node == NULL ||
+    f_ordered_cids_zone == NULL || f_ordered_myids_zone == NULL ||
+    f_cells_per_node == NULL
+  )
+{
+    Message("Error (initScatterPlanOfCellZone()): Memory allocation error or "
+            "missing ordering arrays for zone id %i!\n", fluid_zone_id);
+    state = _STATE_ERROR;
+}
+else
+{
+    compute_node_loop (pe)
+    {
+        plan->cells_per_node[pe] = f_cells_per_node[pe];
+
+        if(i_start + f_cells_per_node[pe] > no_f_cells_zone)
+        {
+            Message("Error (initScatterPlanOfCellZone()): Index out of "
+                    "bounds!\n");
+            state = _STATE_ERROR;
+            break;
+        }
+
+        hash = HASH_INIT;
+        hash = hashIntUpdate(hash, pe);
+        hash = hashIntUpdate(hash, f_cells_per_node[pe]);
+
+        for(i = i_start; i < i_start + f_cells_per_node[pe]; ++i)
+        {
+            if(f_ordered_myids_zone[i] != pe)
+            {
+                Message("Error (initScatterPlanOfCellZone()): Wrong compute "
+                        "node ordering!\n");
+                state = _STATE_ERROR;
+                break;
+            }
+            hash = hashIntUpdate(hash, f_ordered_cids_zone[i]);
+        }
+
+        plan->node_hash[pe] = hash;
+        header_arr[2*pe] = plan->version;
+        header_arr[2*pe + 1] = (int) hash;
+        header_per_node[pe] = 2;
+
+        i_start += f_cells_per_node[pe];
+    }
+}
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    state = hostToNodesIntArrays(header_arr, header_per_node,
+                                 &header_arr, &no_header);
+    #if RP_NODE
+    if(state != _STATE_ERROR && no_header == 2)
+    {
+        state = validateScatterPlanOnNode(
+                                            plan,
+                                            header_arr[0],
+                                            (unsigned int) header_arr[1],
+                                            fluid_zone_id
+                                         );
+    }
+    else
+    {
+        state = _STATE_ERROR;
+    }
+    #endif
+}
+
+state = reduceStateOverProcesses(state);
+
+#if RP_HOST
+if(state != _STATE_ERROR)
+{
+    Message("Info (initScatterPlanOfCellZone()): Scatter plan version %i "
+            "validated for zone id %i.\n", plan->version, fluid_zone_id);
+}
+#endif
+
+free(header_arr);
+free(header_per_node);
+
+if(state == _STATE_ERROR)
+{
+    freeScatterPlan(plan);
+}
+
+return state;
+}
+
+
+int validateScatterPlanOnNode(
+                                ScatterPlan *plan,
+                                int version,
+                                unsigned int hash,
+                                int fluid_zone_id
+                             )
+{
+/*
+    Returns _STATE_OK if the cell ordering of the node matches the host hash.
+    The cell loop is only hashed again if version or hash have changed since
+    the last successful validation.
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+Thread *t;
+Domain *domain = Get_Domain(1);
+
+if(version != plan->validated_version || hash != plan->validated_hash)
+{
+    t = Lookup_Thread(domain, fluid_zone_id);
+
+    if(hashCellOrderingOfNode(t) == hash)
+    {
+        plan->validated_version = version;
+        plan->validated_hash = hash;
+
+        #if VOF_PC_DEBUG
+        Message("Debug Info (validateScatterPlanOnNode()): Node %i validated "
+                "scatter plan version %i.\n", myid, version);
+        #endif
+    }
+    else
+    {
+        Message("Error (validateScatterPlanOnNode()): Cell ordering of node %i "
+                "does not match scatter plan version %i, repartitioned? "
+                "Please initialize the coupling again!\n", myid, version);
+        plan->validated_version = -1;
+        state = _STATE_ERROR;
+    }
+}
+#endif
+
+return state;
+}
+
+
+int distributeArrayToNodesWithScatterPlan(
+                                            real *mapped_arr,
+                                            int size_mapped_arr,
+                                            int noUDMI,
+                                            ScatterPlan *plan,
+                                            int fluid_zone_id
+                                         )
+{
+/*
+    Distributes mapped_arr (host, ordered from node 0 to node p) to the UDMI
+    noUDMI of the interior cells of fluid zone fluid_zone_id. Besides the
+    values only version and hash of the plan are sent, the values as xreal.
+*/
+int state = _STATE_OK;
+int *header_arr = NULL;
+int *header_per_node = NULL;
+int no_header = 0;
+xreal *send_vals = NULL;
+xreal *node_vals = NULL;
+int no_node_vals = 0;
+
+#if RP_HOST
+int pe;
+int sum_cells = 0;
+int ic;
+#endif
+
+#if RP_NODE
+cell_t c;
+Thread *t;
+Domain *domain = Get_Domain(1);
+int i = 0;
+#endif
+
+#if RP_HOST
+header_arr = (int *) calloc(3 * compute_node_count, sizeof(int));
+header_per_node = (int *) calloc(compute_node_count, sizeof(int));
+
+if(
+    header_arr == NULL || header_per_node == NULL ||
+    plan->cells_per_node == NULL || mapped_arr == NULL
+  )
+{
+    Message("Error (distributeArrayToNodesWithScatterPlan()): Memory "
+            "allocation error or uninitialized scatter plan!\n");
+    state = _STATE_ERROR;
+}
+else
+{
+    compute_node_loop (pe)
+    {
+        header_arr[3*pe] = plan->version;
+        header_arr[3*pe + 1] = (int) plan->node_hash[pe];
+        header_arr[3*pe + 2] = plan->cells_per_node[pe];
+        header_per_node[pe] = 3;
+        sum_cells += plan->cells_per_node[pe];
+    }
+
+    if(sum_cells != size_mapped_arr)
+    {
+        Message("Error (distributeArrayToNodesWithScatterPlan()): Array size "
+                "%i does not match scatter plan size %i!\n", size_mapped_arr,
+                sum_cells);
+        state = _STATE_ERROR;
+    }
+}
+
+if(state != _STATE_ERROR && sizeof(xreal) != sizeof(real))
+{
+    send_vals = (xreal *) calloc(size_mapped_arr + 1, sizeof(xreal));
+
+    if(send_vals == NULL)
+    {
+        Message("Error (distributeArrayToNodesWithScatterPlan()): Memory "
+                "allocation error!\n");
+        state = _STATE_ERROR;
+    }
+
+    for(ic = 0; ic < size_mapped_arr && send_vals != NULL; ++ic)
+    {
+        send_vals[ic] = (xreal) mapped_arr[ic];
+    }
+}
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    hostToNodesIntArrays(header_arr, header_per_node, &header_arr, &no_header);
+    hostToNodesRealArrays(
+                            (send_vals != NULL) ? send_vals : (xreal *) mapped_arr,
+                            plan->cells_per_node,
+                            &node_vals,
+                            &no_node_vals
+                          );
+}
+
+#if RP_NODE
+if(state != _STATE_ERROR)
+{
+    t = Lookup_Thread(domain, fluid_zone_id);
+
+    if(
+        no_header != 3 || N_COUPLING_FIELDS <= noUDMI ||
+        header_arr[2] != THREAD_N_ELEMENTS_INT(t) ||
+        no_node_vals != header_arr[2]
+      )
+    {
+        Message("Error (distributeArrayToNodesWithScatterPlan()): Missmatch "
+                "of cell count or UDMI index on node %i!\n", myid);
+        state = _STATE_ERROR;
+    }
+    else
+    {
+        state = validateScatterPlanOnNode(
+                                            plan,
+                                            header_arr[0],
+                                            (unsigned int) header_arr[1],
+                                            fluid_zone_id
+                                         );
+    }
+
+    if(state != _STATE_ERROR)
+    {
+        begin_c_loop_int(c, t)
+        {
+            C_COUPLING(c,t,noUDMI) = node_vals[i];
+            ++i;
+        }
+        end_c_loop_int(c, t)
+    }
+    else if(N_COUPLING_FIELDS > noUDMI)
+    {
+        begin_c_loop_int(c, t)
+        {
+            C_COUPLING(c,t,noUDMI) = UDMI_ERROR_VALUE;
+        }
+        end_c_loop_int(c, t)
+    }
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+free(header_arr);
+free(header_per_node);
+free(send_vals);
+free(node_vals);
+
+return state;
+}
+
+
+#if RP_HOST
+typedef struct packed_node_task_struct
+{
+    PackedScatterZone *zones;
+    int no_zones;
+    int *zone_offset; /* first cell of the node in each zone */
+    int pe;
+    int *header_arr;
+    xreal *node_vals;
+    int no_node_vals;
+} PackedNodeTask;
+
+
+static void packNodeMessageOfPackedZones(void *arg)
+{
+/*
+    Packs header and values of compute node task->pe, may run on a thread of
+    the pool (see vof_pc_threads.h).
+*/
+    PackedNodeTask *task = (PackedNodeTask *) arg;
+    PackedScatterZone *zones = task->zones;
+    int iz, i, k;
+    int e;
+    int j = 0;
+    int no_cells;
+
+    task->header_arr[0] = task->no_zones;
+
+    for(iz = 0; iz < task->no_zones; ++iz)
+    {
+        no_cells = zones[iz].plan->cells_per_node[task->pe];
+
+        task->header_arr[1 + PACKED_SCATTER_HEADER_PER_ZONE*iz] =
+            zones[iz].plan->version;
+        task->header_arr[2 + PACKED_SCATTER_HEADER_PER_ZONE*iz] =
+            (int) zones[iz].plan->node_hash[task->pe];
+        task->header_arr[3 + PACKED_SCATTER_HEADER_PER_ZONE*iz] = no_cells;
+        task->header_arr[4 + PACKED_SCATTER_HEADER_PER_ZONE*iz] =
+            zones[iz].no_fields;
+
+        for(i = task->zone_offset[iz]; i < task->zone_offset[iz] + no_cells; ++i)
+        {
+            e = zones[iz].f2a_mapping[i];
+
+            for(k = 0; k < zones[iz].no_fields; ++k)
+            {
+                task->node_vals[j] = 
+                    (xreal) zones[iz].src[k][e * zones[iz].src_stride[k]];
+                ++j;
+            }
+        }
+    }
+
+    task->no_node_vals = j;
+}
+#endif
+
+
+int distributePackedZonesToNodesWithScatterPlans(
+                                                    PackedScatterZone *zones,
+                                                    int no_zones
+                                                )
+{
+/*
+    Distributes all fields of all zones (see PackedScatterZone) with one
+    message per compute node and writes them on the nodes in a single cell
+    loop per zone. The host packs the message of each node directly from the
+    ANSYS element arrays, only PACKED_SCATTER_NO_BUFFERS node buffers are held
+    at a time.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+int *header_arr = NULL;
+int no_header = 0;
+xreal *node_vals = NULL;
+int no_node_vals = 0;
+int iz, k;
+
+#if RP_HOST
+int pe;
+int i, slot;
+int sum_cells;
+int no_vals = 0;
+int max_no_vals = 0;
+int *zone_offset = NULL;
+PackedNodeTask pack_tasks[PACKED_SCATTER_NO_BUFFERS];
+ThreadTaskGroup pack_groups[PACKED_SCATTER_NO_BUFFERS];
+#endif
+
+#if RP_NODE
+cell_t c;
+Thread *t;
+Domain *domain = Get_Domain(1);
+int *h;
+int j = 0;
+int zone_state;
+#endif
+
+#if RP_HOST
+memset(pack_tasks, 0, sizeof(pack_tasks));
+
+no_header = 1 + PACKED_SCATTER_HEADER_PER_ZONE * no_zones;
+zone_offset = (int *) calloc(compute_node_count * no_zones + 1, sizeof(int));
+
+if(zone_offset == NULL)
+{
+    Message("Error (distributePackedZonesToNodesWithScatterPlans()): Memory "
+            "allocation error!\n");
+    state = _STATE_ERROR;
+}
+
+/* check sizes and mappings once, before anything is sent */
+for(iz = 0; iz < no_zones && state != _STATE_ERROR; ++iz)
+{
+    if(
+        zones[iz].plan == NULL || zones[iz].plan->cells_per_node == NULL ||
+        zones[iz].f2a_mapping == NULL || zones[iz].no_fields < 1 ||
+        zones[iz].no_fields > PACKED_SCATTER_MAX_FIELDS
+      )
+    {
+        Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                "Uninitialized zone %i!\n", zones[iz].fluid_zone_id);
+        state = _STATE_ERROR;
+        break;
+    }
+
+    for(k = 0; k < zones[iz].no_fields; ++k)
+    {
+        if(zones[iz].src[k] == NULL || zones[iz].src_stride[k] < 1)
+        {
+            Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                    "Missing field %i for zone %i!\n", k,
+                    zones[iz].fluid_zone_id);
+            state = _STATE_ERROR;
+        }
+    }
+
+    sum_cells = 0;
+    compute_node_loop (pe)
+    {
+        zone_offset[pe * no_zones + iz] = sum_cells;
+        sum_cells += zones[iz].plan->cells_per_node[pe];
+    }
+
+    if(sum_cells != zones[iz].no_f_cells)
+    {
+        Message("Error (distributePackedZonesToNodesWithScatterPlans()): Zone "
+                "%i has %i cells, but scatter plan size is %i!\n",
+                zones[iz].fluid_zone_id, zones[iz].no_f_cells, sum_cells);
+        state = _STATE_ERROR;
+    }
+
+    for(i = 0; i < zones[iz].no_f_cells && state != _STATE_ERROR; ++i)
+    {
+        if(
+            zones[iz].f2a_mapping[i] < 0 ||
+            zones[iz].f2a_mapping[i] >= zones[iz].no_a_elems
+          )
+        {
+            Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                    "Mapping index out of bounds for zone %i!\n",
+                    zones[iz].fluid_zone_id);
+            state = _STATE_ERROR;
+        }
+    }
+}
+
+if(state != _STATE_ERROR)
+{
+    compute_node_loop (pe)
+    {
+        no_vals = 0;
+        for(iz = 0; iz < no_zones; ++iz)
+        {
+            no_vals += zones[iz].plan->cells_per_node[pe] * zones[iz].no_fields;
+        }
+        if(no_vals > max_no_vals)
+        {
+            max_no_vals = no_vals;
+        }
+    }
+
+    for(slot = 0; slot < PACKED_SCATTER_NO_BUFFERS; ++slot)
+    {
+        initThreadTaskGroup(&pack_groups[slot]);
+
+        pack_tasks[slot].zones = zones;
+        pack_tasks[slot].no_zones = no_zones;
+        pack_tasks[slot].header_arr = (int *) calloc(no_header, sizeof(int));
+        pack_tasks[slot].node_vals = (xreal *) calloc(max_no_vals + 1, 
+                                                      sizeof(xreal));
+
+        if(pack_tasks[slot].header_arr == NULL || 
+           pack_tasks[slot].node_vals == NULL)
+        {
+            Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                    "Memory allocation error!\n");
+            state = _STATE_ERROR;
+        }
+    }
+}
+#endif /* RP_HOST */
+
+host_to_node_int_1(state);
+
+if(state != _STATE_ERROR)
+{
+    #if RP_HOST
+    /* with A2F_PIPELINED_EXCHANGE the messages of the next nodes are packed 
+    by the thread pool while the message of node pe is sent */
+    for(pe = -(PACKED_SCATTER_NO_BUFFERS - 1); pe < compute_node_count; ++pe)
+    {
+        i = pe + PACKED_SCATTER_NO_BUFFERS - 1;
+
+        if(i < compute_node_count)
+        {
+            pack_tasks[i % PACKED_SCATTER_NO_BUFFERS].pe = i;
+            pack_tasks[i % PACKED_SCATTER_NO_BUFFERS].zone_offset = 
+                zone_offset + i * no_zones;
+            submitThreadTask(&pack_groups[i % PACKED_SCATTER_NO_BUFFERS],
+                             packNodeMessageOfPackedZones,
+                             &pack_tasks[i % PACKED_SCATTER_NO_BUFFERS]);
+        }
+
+        if(pe < 0)
+        {
+            continue;
+        }
+
+        slot = pe % PACKED_SCATTER_NO_BUFFERS;
+        waitThreadTaskGroup(&pack_groups[slot]);
+
+        hostSendToNodeViaNodeZero(pack_tasks[slot].header_arr, no_header,
+                                  pack_tasks[slot].node_vals,
+                                  pack_tasks[slot].no_node_vals);
+    }
+    #endif /* RP_HOST */
+
+    #if RP_NODE
+    state = nodeRecvFromHostViaNodeZero(&header_arr, &no_header,
+                                        &node_vals, &no_node_vals);
+    #endif
+}
+
+#if RP_NODE
+if(state != _STATE_ERROR)
+{
+    if(
+        no_header != 1 + PACKED_SCATTER_HEADER_PER_ZONE * no_zones ||
+        header_arr[0] != no_zones
+      )
+    {
+        Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                "Wrong header on node %i!\n", myid);
+        state = _STATE_ERROR;
+    }
+
+    for(iz = 0; iz < no_zones; ++iz)
+    {
+        t = Lookup_Thread(domain, zones[iz].fluid_zone_id);
+        h = header_arr + 1 + PACKED_SCATTER_HEADER_PER_ZONE * iz;
+        zone_state = state;
+
+        for(k = 0; k < zones[iz].no_fields; ++k)
+        {
+            if(N_COUPLING_FIELDS <= zones[iz].udmi_idx[k])
+            {
+                zone_state = _STATE_ERROR;
+            }
+        }
+
+        if(
+            zone_state != _STATE_ERROR &&
+            (
+                h[2] != THREAD_N_ELEMENTS_INT(t) ||
+                h[3] != zones[iz].no_fields ||
+                j + h[2] * h[3] > no_node_vals
+            )
+          )
+        {
+            Message("Error (distributePackedZonesToNodesWithScatterPlans()): "
+                    "Missmatch of cell or field count on node %i for zone "
+                    "%i!\n", myid, zones[iz].fluid_zone_id);
+            zone_state = _STATE_ERROR;
+        }
+
+        if(zone_state != _STATE_ERROR)
+        {
+            zone_state = validateScatterPlanOnNode(
+                                                    zones[iz].plan,
+                                                    h[0],
+                                                    (unsigned int) h[1],
+                                                    zones[iz].fluid_zone_id
+                                                  );
+        }
+
+        if(zone_state != _STATE_ERROR)
+        {
+            begin_c_loop_int(c, t)
+            {
+                for(k = 0; k < zones[iz].no_fields; ++k)
+                {
+                    C_COUPLING(c,t,zones[iz].udmi_idx[k]) = node_vals[j];
+                    ++j;
+                }
+            }
+            end_c_loop_int(c, t)
+        }
+        else
+        {
+            begin_c_loop_int(c, t)
+            {
+                for(k = 0; k < zones[iz].no_fields; ++k)
+                {
+                    if(N_COUPLING_FIELDS > zones[iz].udmi_idx[k])
+                    {
+                        C_COUPLING(c,t,zones[iz].udmi_idx[k]) = UDMI_ERROR_VALUE;
+                    }
+                }
+            }
+            end_c_loop_int(c, t)
+
+            state = _STATE_ERROR;
+        }
+    }
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+#if RP_HOST
+free(zone_offset);
+
+for(slot = 0; slot < PACKED_SCATTER_NO_BUFFERS; ++slot)
+{
+    free(pack_tasks[slot].header_arr);
+    free(pack_tasks[slot].node_vals);
+}
+#endif
+free(header_arr);
+free(node_vals);
+
+return state;
+}
+
+
+void freeScatterPlan(ScatterPlan *plan)
+{
+    if(plan == NULL)
+    {
+        return;
+    }
+
+    free(plan->cells_per_node);
+    free(plan->node_hash);
+
+    plan->cells_per_node = NULL;
+    plan->node_hash = NULL;
+    plan->validated_version = -1;
+    plan->validated_hash = 0;
+}
@@ -0,0 +1,111 @@
+/*
+Scatter plans for distributing host arrays ordered by compute node and cell
+to the compute nodes. The cell ordering of each node is validated once at init
+against a hash, afterwards only the values are sent.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_SCATTER_PLAN_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#include "vof_pc_threads.h"
+#include "vof_pc_zone_storage.h"
+#define VOF_PC_SCATTER_PLAN_H
+
+/*
+The hash of a compute node is built from its id, its cell count and the ids of
+its interior cells in cell loop order (see hashCellOrderingOfNode()).
+*/
+typedef struct scatter_plan_struct
+{
+    int version;
+
+    /* host */
+    int *cells_per_node;
+    unsigned int *node_hash;
+
+    /* compute nodes */
+    int validated_version;
+    unsigned int validated_hash;
+} ScatterPlan;
+
+#define PACKED_SCATTER_MAX_FIELDS (1 + ND_ND)
+#define PACKED_SCATTER_HEADER_PER_ZONE 4
+
+/* node messages packed ahead while sending (see A2F_PIPELINED_EXCHANGE) */
+#if A2F_PIPELINED_EXCHANGE
+#define PACKED_SCATTER_NO_BUFFERS 2
+#else
+#define PACKED_SCATTER_NO_BUFFERS 1
+#endif
+
+/*
+One coupled zone of a packed scatter. All zones are sent in one message per
+compute node with the header
+
+no_zones, [version, hash, no_cells, no_fields] per zone
+
+followed by the values of each zone interleaved per cell:
+
+cell 0: field 0 ... field no_fields-1, cell 1: field 0 ...
+
+On the host field k of Fluent cell i is read directly from the ANSYS element
+array as src[k][f2a_mapping[i] * src_stride[k]], so no reordered cell arrays
+are needed. Nodes only need fluid_zone_id, plan, no_fields and udmi_idx.
+*/
+typedef struct packed_scatter_zone_struct
+{
+    int fluid_zone_id;
+    ScatterPlan *plan;
+    int no_fields;
+    int udmi_idx[PACKED_SCATTER_MAX_FIELDS];
+
+    /* host */
+    real *src[PACKED_SCATTER_MAX_FIELDS];
+    int src_stride[PACKED_SCATTER_MAX_FIELDS];
+    int *f2a_mapping;
+    int no_f_cells;
+    int no_a_elems;
+} PackedScatterZone;
+
+
+int initScatterPlanOfCellZone(
+                                ScatterPlan *plan,
+                                int *f_ordered_cids_zone,
+                                int *f_ordered_myids_zone,
+                                int *f_cells_per_node,
+                                int no_f_cells_zone,
+                                int fluid_zone_id
+                             );
+
+int distributeArrayToNodesWithScatterPlan(
+                                            real *mapped_arr,
+                                            int size_mapped_arr,
+                                            int noUDMI,
+                                            ScatterPlan *plan,
+                                            int fluid_zone_id
+                                         );
+
+int distributePackedZonesToNodesWithScatterPlans(
+                                                    PackedScatterZone *zones,
+                                                    int no_zones
+                                                );
+
+int validateScatterPlanOnNode(
+                                ScatterPlan *plan,
+                                int version,
+                                unsigned int hash,
+                                int fluid_zone_id
+                             );
+
+void freeScatterPlan(ScatterPlan *plan);
+
+#endif
@@ -0,0 +1,363 @@
+/*
+Buffered output of text tables: numbers are formatted like printf (%*i, %*.*f
+and % #*.*E) by table driven digit generation into a large buffer, which is
+written in blocks.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_text_writer.h"
+
+/* fast paths up to this many decimals, printf otherwise */
+#define TEXT_WRITER_MAX_DECIMALS 9
+
+static const char _g_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const double _g_text_pow10[23] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+static int writeDigits(char *dst, unsigned long long val, int min_digits)
+{
+/*
+    Writes the decimal digits of val, zero padded to min_digits, two digits
+    per table lookup. Returns the number of digits.
+*/
+char tmp[24];
+int pos = 24;
+int n;
+unsigned int pair;
+
+while(val >= 100)
+{
+    pair = (unsigned int) (val % 100) * 2;
+    val /= 100;
+    tmp[--pos] = _g_digit_pairs[pair + 1];
+    tmp[--pos] = _g_digit_pairs[pair];
+}
+if(val >= 10)
+{
+    pair = (unsigned int) val * 2;
+    tmp[--pos] = _g_digit_pairs[pair + 1];
+    tmp[--pos] = _g_digit_pairs[pair];
+}
+else
+{
+    tmp[--pos] = (char) ('0' + val);
+}
+while(24 - pos < min_digits)
+{
+    tmp[--pos] = '0';
+}
+
+n = 24 - pos;
+memcpy(dst, tmp + pos, n);
+
+return n;
+}
+
+
+static int padField(char *dst, int len, int width)
+{
+/*
+    Right aligns the len characters of dst in a field of width.
+*/
+    if(len >= width)
+    {
+        return len;
+    }
+
+    memmove(dst + width - len, dst, len);
+    memset(dst, ' ', width - len);
+
+    return width;
+}
+
+
+static int roundScaled(double scaled, unsigned long long *q)
+{
+/*
+    Rounds the (non negative) scaled value to an integer as printf rounds the
+    exact value. Scaling rounded once, so values close to a tie are left to
+    printf (_STATE_ERROR).
+*/
+    double r = floor(scaled);
+    double frac = scaled - r;
+
+    if(fabs(frac - 0.5) <= scaled * 4.5e-16)
+    {
+        return _STATE_ERROR;
+    }
+
+    (*q) = (unsigned long long) r + (frac > 0.5);
+
+    return _STATE_OK;
+}
+
+
+int formatInt(char *dst, int val, int width)
+{
+/*
+    As sprintf(dst, "%*i", width, val) without the terminating '\0'.
+*/
+    int len = 0;
+    unsigned long long u = (val < 0) ? (unsigned long long) (-(long long) val) :
+                                       (unsigned long long) val;
+
+    if(val < 0)
+    {
+        dst[len++] = '-';
+    }
+    len += writeDigits(dst + len, u, 1);
+
+    return padField(dst, len, width);
+}
+
+
+int formatFixed(char *dst, double val, int width, int decimals)
+{
+/*
+    As sprintf(dst, "%*.*f", width, decimals, val) without the terminating
+    '\0', dst needs TEXT_WRITER_MAX_FIELD characters.
+*/
+double a = fabs(val);
+unsigned long long q;
+int len = 0;
+
+if(
+    decimals < 0 || decimals > TEXT_WRITER_MAX_DECIMALS ||
+    !(a < 1e15 / _g_text_pow10[decimals]) ||
+    roundScaled(a * _g_text_pow10[decimals], &q) != _STATE_OK
+  )
+{
+    return snprintf(dst, TEXT_WRITER_MAX_FIELD, "%*.*f", width, decimals, val);
+}
+
+if(signbit(val))
+{
+    dst[len++] = '-';
+}
+len += writeDigits(dst + len, q / (unsigned long long) _g_text_pow10[decimals], 1);
+if(decimals > 0)
+{
+    dst[len++] = '.';
+    len += writeDigits(dst + len,
+                       q % (unsigned long long) _g_text_pow10[decimals], decimals);
+}
+
+return padField(dst, len, width);
+}
+
+
+int formatExp(char *dst, double val, int width, int decimals, int space_sign)
+{
+/*
+    As sprintf(dst, "% #*.*E", width, decimals, val) (space_sign) or
+    "%#*.*E" without the terminating '\0'.
+*/
+double a = fabs(val);
+double scaled;
+unsigned long long q = 0;
+int e, k, len = 0;
+
+if(decimals < 0 || decimals > TEXT_WRITER_MAX_DECIMALS || !(a < 1e300))
+{
+    return snprintf(dst, TEXT_WRITER_MAX_FIELD, space_sign ? "% #*.*E" : "%#*.*E",
+                    width, decimals, val);
+}
+
+e = 0;
+if(a > 0)
+{
+    e = (int) floor(log10(a));
+    k = decimals - e;
+
+    if(k < -22 || k > 22)
+    {
+        return snprintf(dst, TEXT_WRITER_MAX_FIELD,
+                        space_sign ? "% #*.*E" : "%#*.*E", width, decimals, val);
+    }
+
+    scaled = (k >= 0) ? a * _g_text_pow10[k] : a / _g_text_pow10[-k];
+
+    /* log10() may be off by one close to powers of ten */
+    if(
+        scaled < _g_text_pow10[decimals] ||
+        scaled >= _g_text_pow10[decimals + 1] ||
+        roundScaled(scaled, &q) != _STATE_OK
+      )
+    {
+        return snprintf(dst, TEXT_WRITER_MAX_FIELD,
+                        space_sign ? "% #*.*E" : "%#*.*E", width, decimals, val);
+    }
+
+    if(q == (unsigned long long) _g_text_pow10[decimals + 1])
+    {
+        q /= 10;
+        ++e;
+    }
+}
+
+if(signbit(val))
+{
+    dst[len++] = '-';
+}
+else if(space_sign)
+{
+    dst[len++] = ' ';
+}
+
+dst[len++] = (char) ('0' + (int) (q / (unsigned long long) _g_text_pow10[decimals]));
+dst[len++] = '.';
+if(decimals > 0)
+{
+    len += writeDigits(dst + len,
+                       q % (unsigned long long) _g_text_pow10[decimals], decimals);
+}
+dst[len++] = 'E';
+dst[len++] = (e < 0) ? '-' : '+';
+len += writeDigits(dst + len, (unsigned long long) ((e < 0) ? -e : e), 2);
+
+return padField(dst, len, width);
+}
+
+
+int openTextWriter(TextWriter *writer, char filename[])
+{
+/*
+    Opens filename for writing, the file is written under its part file name
+    and published by closeTextWriter().
+*/
+    writer->len = 0;
+    writer->state = _STATE_OK;
+    writer->buf = NULL;
+    sprintf(writer->filename, "%.*s", XC_PART_FILENAME_SIZE - 1, filename);
+    exchangePartFileName(writer->part_file, filename);
+    writer->fp = fopen(writer->part_file, "w");
+
+    if(writer->fp == NULL)
+    {
+        writer->state = _STATE_ERROR;
+        return _STATE_ERROR;
+    }
+
+    writer->buf = (char *) malloc(TEXT_WRITER_BUFFER_SIZE);
+
+    if(writer->buf == NULL)
+    {
+        fclose(writer->fp);
+        writer->fp = NULL;
+        writer->state = publishExchangeFile(writer->part_file, writer->filename,
+                                            _STATE_ERROR);
+    }
+
+    return writer->state;
+}
+
+
+static void flushTextWriter(TextWriter *writer)
+{
+    if(writer->len > 0 && writer->state != _STATE_ERROR)
+    {
+        if(fwrite(writer->buf, 1, writer->len, writer->fp) != (size_t) writer->len)
+        {
+            writer->state = _STATE_ERROR;
+        }
+    }
+    writer->len = 0;
+}
+
+
+static char *reserveTextWriter(TextWriter *writer)
+{
+/*
+    Returns the end of the buffer with room for one field.
+*/
+    if(writer->len + TEXT_WRITER_MAX_FIELD > TEXT_WRITER_BUFFER_SIZE)
+    {
+        flushTextWriter(writer);
+    }
+
+    return writer->buf + writer->len;
+}
+
+
+void writeTextInt(TextWriter *writer, int val, int width)
+{
+    char *dst = reserveTextWriter(writer);
+
+    writer->len += formatInt(dst, val, width);
+}
+
+
+void writeTextFixed(TextWriter *writer, double val, int width, int decimals)
+{
+    char *dst = reserveTextWriter(writer);
+
+    writer->len += formatFixed(dst, val, width, decimals);
+}
+
+
+void writeTextExp(
+                    TextWriter *writer,
+                    double val,
+                    int width,
+                    int decimals,
+                    int space_sign
+                 )
+{
+    char *dst = reserveTextWriter(writer);
+
+    writer->len += formatExp(dst, val, width, decimals, space_sign);
+}
+
+
+void writeTextChar(TextWriter *writer, char ch)
+{
+    char *dst = reserveTextWriter(writer);
+
+    (*dst) = ch;
+    ++writer->len;
+}
+
+
+int closeTextWriter(TextWriter *writer)
+{
+/*
+    Writes the rest of the buffer, closes the file and publishes it, returns
+    _STATE_ERROR if any write failed (the file is not published then).
+*/
+    if(writer->fp != NULL)
+    {
+        flushTextWriter(writer);
+
+        if(
+            (writer->state != _STATE_ERROR && flushExchangeFile(writer->fp) != _STATE_OK) ||
+            fclose(writer->fp) != 0
+          )
+        {
+            writer->state = _STATE_ERROR;
+        }
+        writer->fp = NULL;
+
+        writer->state = publishExchangeFile(writer->part_file, writer->filename,
+                                            writer->state);
+    }
+
+    free(writer->buf);
+    writer->buf = NULL;
+
+    return writer->state;
+}
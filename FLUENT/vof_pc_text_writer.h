@@ -0,0 +1,62 @@
+/*
+Buffered output of text tables: numbers are formatted like printf (%*i, %*.*f
+and % #*.*E) by table driven digit generation into a large buffer, which is
+written in blocks.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_TEXT_WRITER_H
+#include "vof_pc_main.h"
+#include "vof_pc_file_sync.h"
+#define VOF_PC_TEXT_WRITER_H
+
+/* bytes collected before a block is written */
+#define TEXT_WRITER_BUFFER_SIZE 1048576
+
+/* longest field, %f of the largest double included */
+#define TEXT_WRITER_MAX_FIELD 400
+
+typedef struct text_writer_struct
+{
+    FILE *fp;
+    char *buf;
+    int len;
+    int state;
+    char filename[XC_PART_FILENAME_SIZE];
+    char part_file[XC_PART_FILENAME_SIZE];
+} TextWriter;
+
+
+int formatInt(char *dst, int val, int width);
+
+int formatFixed(char *dst, double val, int width, int decimals);
+
+int formatExp(char *dst, double val, int width, int decimals, int space_sign);
+
+int openTextWriter(TextWriter *writer, char filename[]);
+
+void writeTextInt(TextWriter *writer, int val, int width);
+
+void writeTextFixed(TextWriter *writer, double val, int width, int decimals);
+
+void writeTextExp(
+                    TextWriter *writer,
+                    double val,
+                    int width,
+                    int decimals,
+                    int space_sign
+                 );
+
+void writeTextChar(TextWriter *writer, char ch);
+
+int closeTextWriter(TextWriter *writer);
+
+#endif
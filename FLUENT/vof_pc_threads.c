@@ -0,0 +1,680 @@
+/*
+Small task pool for running independent host side work (file parsing, packing
+of node messages) concurrently and a background writer thread for debug
+files. Uses pthreads if LINUX is set and Win32 threads otherwise.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_threads.h"
+#include "stdarg.h"
+
+#if LINUX
+#include "pthread.h"
+
+typedef pthread_t vof_pc_thread_t;
+typedef pthread_mutex_t vof_pc_mutex_t;
+typedef pthread_cond_t vof_pc_cond_t;
+
+#define MUTEX_INIT(M) pthread_mutex_init(M, NULL)
+#define MUTEX_LOCK(M) pthread_mutex_lock(M)
+#define MUTEX_UNLOCK(M) pthread_mutex_unlock(M)
+#define MUTEX_FREE(M) pthread_mutex_destroy(M)
+#define COND_INIT(C) pthread_cond_init(C, NULL)
+#define COND_WAIT(C, M) pthread_cond_wait(C, M)
+#define COND_BROADCAST(C) pthread_cond_broadcast(C)
+#define COND_FREE(C) pthread_cond_destroy(C)
+#define THREAD_LOCAL __thread
+#else
+#include "windows.h"
+
+typedef HANDLE vof_pc_thread_t;
+typedef CRITICAL_SECTION vof_pc_mutex_t;
+typedef CONDITION_VARIABLE vof_pc_cond_t;
+
+#define MUTEX_INIT(M) InitializeCriticalSection(M)
+#define MUTEX_LOCK(M) EnterCriticalSection(M)
+#define MUTEX_UNLOCK(M) LeaveCriticalSection(M)
+#define MUTEX_FREE(M) DeleteCriticalSection(M)
+#define COND_INIT(C) InitializeConditionVariable(C)
+#define COND_WAIT(C, M) SleepConditionVariableCS(C, M, INFINITE)
+#define COND_BROADCAST(C) WakeAllConditionVariable(C)
+#define COND_FREE(C)
+#define THREAD_LOCAL __declspec(thread)
+#endif
+
+typedef struct thread_task_struct
+{
+    ThreadTaskFun fun;
+    void *arg;
+    ThreadTaskGroup *group;
+} ThreadTask;
+
+typedef struct thread_pool_struct
+{
+    int no_threads;
+    int shutdown;
+    vof_pc_thread_t *threads;
+
+    vof_pc_mutex_t lock;
+    vof_pc_cond_t task_cond; /* new task or shutdown */
+    vof_pc_cond_t done_cond; /* task of any group done */
+
+    ThreadTask queue[VOF_PC_THREAD_QUEUE_SIZE];
+    int queue_head;
+    int queue_count;
+} ThreadPool;
+
+static ThreadPool _g_thread_pool;
+static int _g_thread_pool_running = 0;
+
+typedef struct background_write_struct
+{
+    BackgroundWriteFun fun;
+    void *job;
+} BackgroundWrite;
+
+typedef struct background_writer_struct
+{
+    int shutdown;
+    int busy; /* a job is being written */
+    int no_failed;
+    vof_pc_thread_t thread;
+
+    vof_pc_mutex_t lock;
+    vof_pc_cond_t job_cond; /* new job or shutdown */
+    vof_pc_cond_t done_cond; /* job written */
+
+    BackgroundWrite queue[VOF_PC_WRITER_QUEUE_SIZE];
+    int queue_head;
+    int queue_count;
+} BackgroundWriter;
+
+static BackgroundWriter _g_background_writer;
+static int _g_background_writer_running = 0;
+
+/* text of threadMessage() on the worker threads, printed by the main thread */
+typedef struct thread_messages_struct
+{
+    vof_pc_mutex_t lock;
+    char *text;
+    int len;
+    int size;
+} ThreadMessages;
+
+static ThreadMessages _g_thread_messages;
+static int _g_thread_messages_ready = 0;
+static THREAD_LOCAL int _g_on_worker_thread = 0;
+
+
+static void initThreadMessages()
+{
+/*
+    Called by the main thread before it starts any worker thread.
+*/
+    if(!_g_thread_messages_ready)
+    {
+        memset(&_g_thread_messages, 0, sizeof(ThreadMessages));
+        MUTEX_INIT(&_g_thread_messages.lock);
+        _g_thread_messages_ready = 1;
+    }
+}
+
+
+void threadMessage(const char *format, ...)
+{
+/*
+    Message() for code which may run on a worker thread of the pool or on
+    the writer thread. Message() is not thread safe, so on these threads the
+    text is kept until the main thread prints it (see printThreadMessages()).
+*/
+char line[THREAD_MESSAGE_SIZE];
+char *text = NULL;
+int n = 0;
+int size = 0;
+va_list args;
+
+va_start(args, format);
+n = vsnprintf(line, THREAD_MESSAGE_SIZE, format, args);
+va_end(args);
+
+if(!_g_on_worker_thread)
+{
+    Message("%s", line);
+    return;
+}
+
+if(n < 0)
+{
+    return;
+}
+n = (n < THREAD_MESSAGE_SIZE) ? n : THREAD_MESSAGE_SIZE - 1;
+
+MUTEX_LOCK(&_g_thread_messages.lock);
+
+if(_g_thread_messages.len + n + 1 > _g_thread_messages.size)
+{
+    size = 2 * (_g_thread_messages.len + n + 1);
+    text = (char *) realloc(_g_thread_messages.text, size);
+
+    /* without memory the message is lost, there is no way to report it */
+    if(text != NULL)
+    {
+        _g_thread_messages.text = text;
+        _g_thread_messages.size = size;
+    }
+}
+
+if(_g_thread_messages.len + n + 1 <= _g_thread_messages.size)
+{
+    memcpy(_g_thread_messages.text + _g_thread_messages.len, line, n + 1);
+    _g_thread_messages.len += n;
+}
+
+MUTEX_UNLOCK(&_g_thread_messages.lock);
+}
+
+
+void printThreadMessages()
+{
+/*
+    Prints the text of threadMessage() of the worker threads so far, does
+    nothing on a worker thread.
+*/
+char *text = NULL;
+
+if(!_g_thread_messages_ready || _g_on_worker_thread)
+{
+    return;
+}
+
+MUTEX_LOCK(&_g_thread_messages.lock);
+text = _g_thread_messages.text;
+_g_thread_messages.text = NULL;
+_g_thread_messages.len = 0;
+_g_thread_messages.size = 0;
+MUTEX_UNLOCK(&_g_thread_messages.lock);
+
+if(text != NULL)
+{
+    Message("%s", text);
+    free(text);
+}
+}
+
+
+static int popThreadTask(ThreadTask *task)
+{
+/*
+    Takes the oldest task from the queue, lock must be held!
+*/
+    if(_g_thread_pool.queue_count < 1)
+    {
+        return 0;
+    }
+
+    *task = _g_thread_pool.queue[_g_thread_pool.queue_head];
+    _g_thread_pool.queue_head =
+        (_g_thread_pool.queue_head + 1) % VOF_PC_THREAD_QUEUE_SIZE;
+    --_g_thread_pool.queue_count;
+
+    return 1;
+}
+
+
+static void runThreadTask(ThreadTask *task)
+{
+/*
+    Executes task without holding the lock and marks it as done afterwards.
+*/
+    task->fun(task->arg);
+
+    MUTEX_LOCK(&_g_thread_pool.lock);
+    --(task->group->no_pending);
+    COND_BROADCAST(&_g_thread_pool.done_cond);
+    MUTEX_UNLOCK(&_g_thread_pool.lock);
+}
+
+
+#if LINUX
+static void *threadPoolWorker(void *arg)
+#else
+static DWORD WINAPI threadPoolWorker(LPVOID arg)
+#endif
+{
+    ThreadTask task;
+
+    (void) arg;
+
+    _g_on_worker_thread = 1;
+
+    MUTEX_LOCK(&_g_thread_pool.lock);
+
+    while(!_g_thread_pool.shutdown)
+    {
+        if(popThreadTask(&task))
+        {
+            MUTEX_UNLOCK(&_g_thread_pool.lock);
+            runThreadTask(&task);
+            MUTEX_LOCK(&_g_thread_pool.lock);
+        }
+        else
+        {
+            COND_WAIT(&_g_thread_pool.task_cond, &_g_thread_pool.lock);
+        }
+    }
+
+    MUTEX_UNLOCK(&_g_thread_pool.lock);
+
+    return 0;
+}
+
+
+int initThreadPool(int no_threads)
+{
+/*
+    Starts no_threads worker threads. With no_threads < 1 or if the threads
+    can not be started all tasks are executed directly in
+    submitThreadTask().
+*/
+int state = _STATE_OK;
+int i;
+
+if(_g_thread_pool_running || no_threads < 1)
+{
+    return state;
+}
+
+memset(&_g_thread_pool, 0, sizeof(ThreadPool));
+initThreadMessages();
+
+_g_thread_pool.threads = (vof_pc_thread_t *)
+                            calloc(no_threads, sizeof(vof_pc_thread_t));
+
+if(_g_thread_pool.threads == NULL)
+{
+    Message("Warning (initThreadPool()): Memory allocation error, tasks will "
+            "be executed sequentially!\n");
+    return _STATE_WARNING;
+}
+
+MUTEX_INIT(&_g_thread_pool.lock);
+COND_INIT(&_g_thread_pool.task_cond);
+COND_INIT(&_g_thread_pool.done_cond);
+
+for(i = 0; i < no_threads; ++i)
+{
+    #if LINUX
+    if(pthread_create(&_g_thread_pool.threads[i], NULL,
+                      threadPoolWorker, NULL) != 0)
+    #else
+    _g_thread_pool.threads[i] = CreateThread(NULL, 0, threadPoolWorker,
+                                             NULL, 0, NULL);
+    if(_g_thread_pool.threads[i] == NULL)
+    #endif
+    {
+        Message("Warning (initThreadPool()): Only %i of %i threads could be "
+                "started!\n", i, no_threads);
+        state = _STATE_WARNING;
+        break;
+    }
+}
+
+_g_thread_pool.no_threads = i;
+_g_thread_pool_running = 1;
+
+if(i == 0)
+{
+    freeThreadPool();
+}
+
+return state;
+}
+
+
+void initThreadTaskGroup(ThreadTaskGroup *group)
+{
+    group->no_pending = 0;
+}
+
+
+void submitThreadTask(ThreadTaskGroup *group, ThreadTaskFun fun, void *arg)
+{
+/*
+    Queues fun(arg) for execution by the pool. If the pool is not running
+    or the queue is full the task is executed directly.
+*/
+ThreadTask task;
+
+task.fun = fun;
+task.arg = arg;
+task.group = group;
+
+if(_g_thread_pool_running)
+{
+    MUTEX_LOCK(&_g_thread_pool.lock);
+
+    if(_g_thread_pool.queue_count < VOF_PC_THREAD_QUEUE_SIZE)
+    {
+        _g_thread_pool.queue[(_g_thread_pool.queue_head +
+                              _g_thread_pool.queue_count) %
+                             VOF_PC_THREAD_QUEUE_SIZE] = task;
+        ++_g_thread_pool.queue_count;
+        ++(group->no_pending);
+
+        COND_BROADCAST(&_g_thread_pool.task_cond);
+        MUTEX_UNLOCK(&_g_thread_pool.lock);
+        return;
+    }
+
+    MUTEX_UNLOCK(&_g_thread_pool.lock);
+}
+
+fun(arg);
+}
+
+
+void waitThreadTaskGroup(ThreadTaskGroup *group)
+{
+/*
+    Waits until all tasks of group are done, queued tasks (of any group) are
+    executed by the waiting thread in the meantime.
+*/
+ThreadTask task;
+
+if(!_g_thread_pool_running)
+{
+    return;
+}
+
+MUTEX_LOCK(&_g_thread_pool.lock);
+
+while(group->no_pending > 0)
+{
+    if(popThreadTask(&task))
+    {
+        MUTEX_UNLOCK(&_g_thread_pool.lock);
+        runThreadTask(&task);
+        MUTEX_LOCK(&_g_thread_pool.lock);
+    }
+    else
+    {
+        COND_WAIT(&_g_thread_pool.done_cond, &_g_thread_pool.lock);
+    }
+}
+
+MUTEX_UNLOCK(&_g_thread_pool.lock);
+
+printThreadMessages();
+}
+
+
+int threadPoolSize()
+{
+    /* number of running worker threads, 0 if tasks run sequentially */
+    return _g_thread_pool_running ? _g_thread_pool.no_threads : 0;
+}
+
+
+void freeThreadPool()
+{
+/*
+    Stops all worker threads, remaining queued tasks are executed by the
+    calling thread first.
+*/
+ThreadTask task;
+int i;
+
+if(!_g_thread_pool_running)
+{
+    return;
+}
+
+MUTEX_LOCK(&_g_thread_pool.lock);
+
+while(popThreadTask(&task))
+{
+    MUTEX_UNLOCK(&_g_thread_pool.lock);
+    runThreadTask(&task);
+    MUTEX_LOCK(&_g_thread_pool.lock);
+}
+
+_g_thread_pool.shutdown = 1;
+COND_BROADCAST(&_g_thread_pool.task_cond);
+MUTEX_UNLOCK(&_g_thread_pool.lock);
+
+for(i = 0; i < _g_thread_pool.no_threads; ++i)
+{
+    #if LINUX
+    pthread_join(_g_thread_pool.threads[i], NULL);
+    #else
+    WaitForSingleObject(_g_thread_pool.threads[i], INFINITE);
+    CloseHandle(_g_thread_pool.threads[i]);
+    #endif
+}
+
+COND_FREE(&_g_thread_pool.task_cond);
+COND_FREE(&_g_thread_pool.done_cond);
+MUTEX_FREE(&_g_thread_pool.lock);
+
+free(_g_thread_pool.threads);
+_g_thread_pool.threads = NULL;
+_g_thread_pool.no_threads = 0;
+_g_thread_pool_running = 0;
+
+printThreadMessages();
+}
+
+
+#if LINUX
+static void *backgroundWriterWorker(void *arg)
+#else
+static DWORD WINAPI backgroundWriterWorker(LPVOID arg)
+#endif
+{
+    BackgroundWriter *writer = &_g_background_writer;
+    BackgroundWrite write;
+    int state;
+
+    (void) arg;
+
+    _g_on_worker_thread = 1;
+
+    MUTEX_LOCK(&writer->lock);
+
+    while(1)
+    {
+        if(writer->queue_count > 0)
+        {
+            write = writer->queue[writer->queue_head];
+            writer->queue_head = (writer->queue_head + 1) %
+                                 VOF_PC_WRITER_QUEUE_SIZE;
+            --writer->queue_count;
+            writer->busy = 1;
+            COND_BROADCAST(&writer->done_cond);
+            MUTEX_UNLOCK(&writer->lock);
+
+            state = write.fun(write.job);
+
+            MUTEX_LOCK(&writer->lock);
+            if(state == _STATE_ERROR)
+            {
+                ++writer->no_failed;
+            }
+            writer->busy = 0;
+            COND_BROADCAST(&writer->done_cond);
+        }
+        else if(writer->shutdown)
+        {
+            break;
+        }
+        else
+        {
+            COND_WAIT(&writer->job_cond, &writer->lock);
+        }
+    }
+
+    MUTEX_UNLOCK(&writer->lock);
+
+    return 0;
+}
+
+
+static int initBackgroundWriter()
+{
+/*
+    Starts the writer thread, returns _STATE_ERROR if it can not be started.
+*/
+    BackgroundWriter *writer = &_g_background_writer;
+
+    memset(writer, 0, sizeof(BackgroundWriter));
+    initThreadMessages();
+
+    MUTEX_INIT(&writer->lock);
+    COND_INIT(&writer->job_cond);
+    COND_INIT(&writer->done_cond);
+
+    #if LINUX
+    if(pthread_create(&writer->thread, NULL, backgroundWriterWorker, NULL) != 0)
+    #else
+    writer->thread = CreateThread(NULL, 0, backgroundWriterWorker, NULL, 0, NULL);
+    if(writer->thread == NULL)
+    #endif
+    {
+        COND_FREE(&writer->job_cond);
+        COND_FREE(&writer->done_cond);
+        MUTEX_FREE(&writer->lock);
+        return _STATE_ERROR;
+    }
+
+    _g_background_writer_running = 1;
+
+    return _STATE_OK;
+}
+
+
+void submitBackgroundWrite(BackgroundWriteFun fun, void *job)
+{
+/*
+    Hands job over to the writer thread, which is started with the first
+    job. Blocks while VOF_PC_WRITER_QUEUE_SIZE jobs are waiting. If the
+    thread can not be started the job is written directly.
+*/
+BackgroundWriter *writer = &_g_background_writer;
+BackgroundWrite write;
+
+if(!_g_background_writer_running && initBackgroundWriter() != _STATE_OK)
+{
+    Message("Warning (submitBackgroundWrite()): Writer thread could not be "
+            "started, writing directly!\n");
+
+    if(fun(job) == _STATE_ERROR)
+    {
+        Message("Warning (submitBackgroundWrite()): Writing a debug file "
+                "failed!\n");
+    }
+    return;
+}
+
+write.fun = fun;
+write.job = job;
+
+printThreadMessages();
+
+MUTEX_LOCK(&writer->lock);
+
+while(writer->queue_count == VOF_PC_WRITER_QUEUE_SIZE)
+{
+    COND_WAIT(&writer->done_cond, &writer->lock);
+}
+
+writer->queue[(writer->queue_head + writer->queue_count) %
+              VOF_PC_WRITER_QUEUE_SIZE] = write;
+++writer->queue_count;
+
+COND_BROADCAST(&writer->job_cond);
+MUTEX_UNLOCK(&writer->lock);
+}
+
+
+int flushBackgroundWriter()
+{
+/*
+    Waits until all submitted jobs are written, returns _STATE_WARNING if
+    any of them failed since the last flush.
+*/
+BackgroundWriter *writer = &_g_background_writer;
+int no_failed = 0;
+
+if(!_g_background_writer_running)
+{
+    return _STATE_OK;
+}
+
+MUTEX_LOCK(&writer->lock);
+
+while(writer->queue_count > 0 || writer->busy)
+{
+    COND_WAIT(&writer->done_cond, &writer->lock);
+}
+
+no_failed = writer->no_failed;
+writer->no_failed = 0;
+
+MUTEX_UNLOCK(&writer->lock);
+
+printThreadMessages();
+
+if(no_failed > 0)
+{
+    Message("Warning (flushBackgroundWriter()): %i debug file(s) could not be "
+            "written!\n", no_failed);
+    return _STATE_WARNING;
+}
+
+return _STATE_OK;
+}
+
+
+int freeBackgroundWriter()
+{
+/*
+    Writes all submitted jobs and stops the writer thread.
+*/
+BackgroundWriter *writer = &_g_background_writer;
+int state = _STATE_OK;
+
+if(!_g_background_writer_running)
+{
+    return state;
+}
+
+state = flushBackgroundWriter();
+
+MUTEX_LOCK(&writer->lock);
+writer->shutdown = 1;
+COND_BROADCAST(&writer->job_cond);
+MUTEX_UNLOCK(&writer->lock);
+
+#if LINUX
+pthread_join(writer->thread, NULL);
+#else
+WaitForSingleObject(writer->thread, INFINITE);
+CloseHandle(writer->thread);
+#endif
+
+COND_FREE(&writer->job_cond);
+COND_FREE(&writer->done_cond);
+MUTEX_FREE(&writer->lock);
+
+_g_background_writer_running = 0;
+
+return state;
+}
@@ -0,0 +1,71 @@
+/*
+Small task pool for running independent host side work (file parsing, packing
+of node messages) concurrently and a background writer thread for debug
+files. Uses pthreads if LINUX is set and Win32 threads otherwise.
+
+Tasks and writer jobs must not call any Fluent API function, their messages
+go through threadMessage(), all communication with the compute nodes has to
+stay on the calling thread!
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_THREADS_H
+#include "vof_pc_main.h"
+#define VOF_PC_THREADS_H
+
+#define VOF_PC_THREAD_QUEUE_SIZE 64
+
+/* longest text of one threadMessage() call */
+#define THREAD_MESSAGE_SIZE 1024
+
+typedef void (*ThreadTaskFun)(void *arg);
+
+/* writes the file of job, frees job and returns the state */
+typedef int (*BackgroundWriteFun)(void *job);
+
+/*
+Tasks are submitted to a group, waitThreadTaskGroup() returns after all tasks
+of the group are done. The waiting thread executes queued tasks itself, so
+groups may also be waited for inside of tasks.
+*/
+typedef struct thread_task_group_struct
+{
+    volatile int no_pending;
+} ThreadTaskGroup;
+
+
+int initThreadPool(int no_threads);
+
+void initThreadTaskGroup(ThreadTaskGroup *group);
+
+void submitThreadTask(ThreadTaskGroup *group, ThreadTaskFun fun, void *arg);
+
+void waitThreadTaskGroup(ThreadTaskGroup *group);
+
+int threadPoolSize();
+
+void freeThreadPool();
+
+void threadMessage(const char *format, ...);
+
+/*
+Called by the main thread after waitThreadTaskGroup() and by the writer
+functions, so tasks and writer jobs do not have to be waited for explicitly
+*/
+void printThreadMessages();
+
+void submitBackgroundWrite(BackgroundWriteFun fun, void *job);
+
+int flushBackgroundWriter();
+
+int freeBackgroundWriter();
+
+#endif
@@ -0,0 +1,553 @@
+/*
+Binary trace of the exchanged ANSYS element fields of every coupling step
+(see COUPLING_TRACE in vof_pc_main.h). The values are copied by the coupling
+and encoded and appended to the trace by the background writer thread.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_trace.h"
+
+#if LINUX
+#define TRACE_FSEEK fseeko
+#define TRACE_FTELL ftello
+#else
+#define TRACE_FSEEK _fseeki64
+#define TRACE_FTELL _ftelli64
+#endif
+
+/* previous values of one zone and field for delta records */
+typedef struct trace_field_struct
+{
+    int zone_id;
+    int field;
+    int no_bytes;
+    int no_records; /* since the last record without delta */
+    unsigned char *prev;
+} TraceField;
+
+/* only accessed by the background writer thread while the trace is open */
+typedef struct trace_file_struct
+{
+    FILE *fp;
+    FILE *index_fp;
+    long long size;
+    int failed; /* no records are appended after a failed write */
+    TraceField fields[TRACE_MAX_FIELDS];
+    int no_fields;
+    unsigned char *enc_buf;
+    int enc_buf_size;
+} TraceFile;
+
+typedef struct trace_record_job_struct
+{
+    int step;
+    int zone_id;
+    int field;
+    int no_cols;
+    int no_rows;
+    real *vals;
+} TraceRecordJob;
+
+typedef struct trace_rle_struct
+{
+    unsigned char *out;
+    int len;
+    int lit_pos;
+    int lit_len;
+    int zero_len;
+} TraceRLE;
+
+static TraceFile _g_trace;
+static int _g_trace_open = 0;
+static int _g_trace_step = 0;
+
+
+#if TRACE_COMPRESSION
+static void putTraceRLEByte(TraceRLE *rle, unsigned char byte)
+{
+    if(byte == 0)
+    {
+        rle->lit_len = 0;
+
+        if(rle->zero_len == 128)
+        {
+            rle->out[rle->len++] = (unsigned char) (127 + rle->zero_len);
+            rle->zero_len = 0;
+        }
+        ++rle->zero_len;
+        return;
+    }
+
+    if(rle->zero_len > 0)
+    {
+        rle->out[rle->len++] = (unsigned char) (127 + rle->zero_len);
+        rle->zero_len = 0;
+    }
+
+    if(rle->lit_len == 0 || rle->lit_len == 128)
+    {
+        rle->lit_pos = rle->len++;
+        rle->lit_len = 0;
+    }
+
+    rle->out[rle->len++] = byte;
+    rle->out[rle->lit_pos] = (unsigned char) rle->lit_len;
+    ++rle->lit_len;
+}
+
+
+static int encodeTraceValues(
+                                unsigned char *out,
+                                const unsigned char *vals,
+                                const unsigned char *prev,
+                                int no_values,
+                                int value_size
+                            )
+{
+/*
+    Run length encodes the byte planes of the no_values values vals, xor-ed
+    with prev if it is not NULL, into out and returns the encoded bytes. out
+    needs room for no_values * value_size * 3 / 2 + 2 bytes (alternating
+    zero and literal bytes).
+*/
+TraceRLE rle;
+int b, i;
+
+rle.out = out;
+rle.len = 0;
+rle.lit_pos = 0;
+rle.lit_len = 0;
+rle.zero_len = 0;
+
+for(b = 0; b < value_size; ++b)
+{
+    if(prev != NULL)
+    {
+        for(i = 0; i < no_values; ++i)
+        {
+            putTraceRLEByte(&rle, vals[i * value_size + b] ^
+                                  prev[i * value_size + b]);
+        }
+    }
+    else
+    {
+        for(i = 0; i < no_values; ++i)
+        {
+            putTraceRLEByte(&rle, vals[i * value_size + b]);
+        }
+    }
+}
+
+if(rle.zero_len > 0)
+{
+    rle.out[rle.len++] = (unsigned char) (127 + rle.zero_len);
+}
+
+return rle.len;
+}
+
+
+static TraceField *traceFieldOf(TraceFile *trace, int zone_id, int field)
+{
+/*
+    Returns the previous values entry of zone_id and field, a new one if
+    there is none and NULL if there is no room.
+*/
+    int i;
+
+    for(i = 0; i < trace->no_fields; ++i)
+    {
+        if(trace->fields[i].zone_id == zone_id && trace->fields[i].field == field)
+        {
+            return &trace->fields[i];
+        }
+    }
+
+    if(trace->no_fields == TRACE_MAX_FIELDS)
+    {
+        return NULL;
+    }
+
+    i = trace->no_fields++;
+    trace->fields[i].zone_id = zone_id;
+    trace->fields[i].field = field;
+    trace->fields[i].no_bytes = 0;
+    trace->fields[i].no_records = 0;
+    trace->fields[i].prev = NULL;
+
+    return &trace->fields[i];
+}
+#endif
+
+
+static int writeTraceRecordJob(void *arg)
+{
+/*
+    Encodes one record and appends it and its index entry, runs on the
+    background writer thread. After a failed write the end of the trace is
+    unknown, so the recording stops.
+*/
+TraceRecordJob *job = (TraceRecordJob *) arg;
+TraceFile *trace = &_g_trace;
+TraceField *field = NULL;
+unsigned char header[TRACE_RECORD_HEADER_SIZE];
+unsigned char entry[TRACE_INDEX_ENTRY_SIZE];
+const unsigned char *payload = (const unsigned char *) job->vals;
+int no_bytes = job->no_rows * job->no_cols * (int) sizeof(real);
+int payload_size = no_bytes;
+int codec = TRACE_CODEC_RAW;
+int state = _STATE_OK;
+
+#if TRACE_COMPRESSION
+int enc_size = no_bytes + no_bytes / 2 + 2;
+int delta;
+#endif
+
+if(!_g_trace_open || trace->failed)
+{
+    free(job->vals);
+    free(job);
+    return state;
+}
+
+#if TRACE_COMPRESSION
+field = traceFieldOf(trace, job->zone_id, job->field);
+
+if(enc_size > trace->enc_buf_size)
+{
+    free(trace->enc_buf);
+    trace->enc_buf = (unsigned char *) malloc(enc_size);
+    trace->enc_buf_size = (trace->enc_buf != NULL) ? enc_size : 0;
+}
+
+if(trace->enc_buf != NULL)
+{
+    delta = field != NULL && field->prev != NULL &&
+            field->no_bytes == no_bytes &&
+            field->no_records < TRACE_KEYFRAME_INTERVAL;
+
+    enc_size = encodeTraceValues(
+                                    trace->enc_buf,
+                                    (const unsigned char *) job->vals,
+                                    delta ? field->prev : NULL,
+                                    job->no_rows * job->no_cols,
+                                    (int) sizeof(real)
+                                );
+
+    /* incompressible values are stored as they are */
+    if(enc_size < no_bytes)
+    {
+        payload = trace->enc_buf;
+        payload_size = enc_size;
+        codec = delta ? TRACE_CODEC_DELTA_RLE : TRACE_CODEC_RLE;
+    }
+}
+
+if(field != NULL)
+{
+    field->no_records = (codec == TRACE_CODEC_DELTA_RLE) ?
+                            field->no_records + 1 : 1;
+}
+#endif
+
+memcpy(header, TRACE_RECORD_MAGIC, TRACE_MAGIC_SIZE);
+putLittleEndianInt(header + 8, job->step);
+putLittleEndianInt(header + 12, job->zone_id);
+putLittleEndianInt(header + 16, job->field);
+putLittleEndianInt(header + 20, codec);
+putLittleEndianInt(header + 24, (int) sizeof(real));
+putLittleEndianInt(header + 28, job->no_rows);
+putLittleEndianInt(header + 32, job->no_cols);
+putLittleEndianInt(header + 36, payload_size);
+
+if(
+    fwrite(header, 1, TRACE_RECORD_HEADER_SIZE, trace->fp) !=
+        TRACE_RECORD_HEADER_SIZE ||
+    fwrite(payload, 1, (size_t) payload_size, trace->fp) != (size_t) payload_size
+  )
+{
+    state = _STATE_ERROR;
+}
+
+/* index entry: the header integers and the offset of the record */
+memcpy(entry, header + TRACE_MAGIC_SIZE, 32);
+putLittleEndianInt(entry + 32, (int) (trace->size & 0xffffffffLL));
+putLittleEndianInt(entry + 36, (int) (trace->size >> 32));
+
+if(
+    state != _STATE_ERROR &&
+    fwrite(entry, 1, TRACE_INDEX_ENTRY_SIZE, trace->index_fp) !=
+        TRACE_INDEX_ENTRY_SIZE
+  )
+{
+    state = _STATE_ERROR;
+}
+
+if(state != _STATE_ERROR)
+{
+    trace->size += TRACE_RECORD_HEADER_SIZE + payload_size;
+}
+else
+{
+    threadMessage("Error (writeTraceRecordJob()): Appending field %i of zone id %i "
+            "in step %i to the coupling trace failed, recording stopped!\n",
+            job->field, job->zone_id, job->step);
+    trace->failed = 1;
+}
+
+/* the values are the previous ones of the next record, unless it is lost */
+if(field != NULL)
+{
+    free(field->prev);
+    field->prev = NULL;
+
+    if(state != _STATE_ERROR)
+    {
+        field->prev = (unsigned char *) job->vals;
+        field->no_bytes = no_bytes;
+        job->vals = NULL;
+    }
+}
+
+free(job->vals);
+free(job);
+
+return state;
+}
+
+
+static long long traceFileSize(FILE *fp)
+{
+    if(TRACE_FSEEK(fp, 0, SEEK_END) != 0)
+    {
+        return -1;
+    }
+
+    return (long long) TRACE_FTELL(fp);
+}
+
+
+static int checkTraceMagic(FILE *fp, const char *magic)
+{
+    unsigned char buf[TRACE_MAGIC_SIZE];
+
+    if(
+        TRACE_FSEEK(fp, 0, SEEK_SET) != 0 ||
+        fread(buf, 1, TRACE_MAGIC_SIZE, fp) != TRACE_MAGIC_SIZE ||
+        memcmp(buf, magic, TRACE_MAGIC_SIZE) != 0
+      )
+    {
+        return _STATE_ERROR;
+    }
+
+    return _STATE_OK;
+}
+
+
+int openCouplingTrace(char trace_file[], char index_file[])
+{
+/*
+    Opens the trace and its index for appending, they are created if they do
+    not exist. The step numbers continue after the last indexed step.
+    Host only!
+*/
+unsigned char entry[TRACE_INDEX_ENTRY_SIZE];
+long long index_size = 0;
+int state = _STATE_OK;
+
+if(_g_trace_open)
+{
+    return state;
+}
+
+if(!isLittleEndianHost())
+{
+    Message("Error (openCouplingTrace()): The coupling trace needs a little "
+            "endian host!\n");
+    return _STATE_ERROR;
+}
+
+memset(&_g_trace, 0, sizeof(TraceFile));
+_g_trace_step = 0;
+
+_g_trace.fp = fopen(trace_file, "a+b");
+_g_trace.index_fp = fopen(index_file, "a+b");
+
+if(_g_trace.fp == NULL || _g_trace.index_fp == NULL)
+{
+    Message("Error (openCouplingTrace()): Unable to open %s and %s!\n",
+            trace_file, index_file);
+    state = _STATE_ERROR;
+}
+else
+{
+    _g_trace.size = traceFileSize(_g_trace.fp);
+    index_size = traceFileSize(_g_trace.index_fp);
+
+    if(_g_trace.size == 0 && index_size == 0)
+    {
+        if(
+            fwrite(TRACE_MAGIC, 1, TRACE_MAGIC_SIZE, _g_trace.fp) !=
+                TRACE_MAGIC_SIZE ||
+            fwrite(TRACE_INDEX_MAGIC, 1, TRACE_MAGIC_SIZE, _g_trace.index_fp) !=
+                TRACE_MAGIC_SIZE
+          )
+        {
+            state = _STATE_ERROR;
+        }
+        _g_trace.size = TRACE_MAGIC_SIZE;
+    }
+    else if(
+            checkTraceMagic(_g_trace.fp, TRACE_MAGIC) != _STATE_OK ||
+            checkTraceMagic(_g_trace.index_fp, TRACE_INDEX_MAGIC) != _STATE_OK ||
+            (index_size - TRACE_MAGIC_SIZE) % TRACE_INDEX_ENTRY_SIZE != 0
+           )
+    {
+        Message("Error (openCouplingTrace()): %s and %s are no coupling trace "
+                "or are damaged!\n", trace_file, index_file);
+        state = _STATE_ERROR;
+    }
+    else if(index_size > TRACE_MAGIC_SIZE)
+    {
+        if(
+            TRACE_FSEEK(_g_trace.index_fp, index_size - TRACE_INDEX_ENTRY_SIZE,
+                        SEEK_SET) != 0 ||
+            fread(entry, 1, TRACE_INDEX_ENTRY_SIZE, _g_trace.index_fp) !=
+                TRACE_INDEX_ENTRY_SIZE
+          )
+        {
+            state = _STATE_ERROR;
+        }
+        else
+        {
+            /* the init exchange is the step after the last recorded one */
+            _g_trace_step = getLittleEndianInt(entry) + 1;
+        }
+    }
+
+    /* appending after reading needs a positioning */
+    TRACE_FSEEK(_g_trace.fp, 0, SEEK_END);
+    TRACE_FSEEK(_g_trace.index_fp, 0, SEEK_END);
+}
+
+if(state == _STATE_ERROR)
+{
+    if(_g_trace.fp != NULL)
+    {
+        fclose(_g_trace.fp);
+    }
+    if(_g_trace.index_fp != NULL)
+    {
+        fclose(_g_trace.index_fp);
+    }
+    return state;
+}
+
+_g_trace_open = 1;
+
+Message("Info (openCouplingTrace()): Recording coupling steps from step %i to "
+        "%s\n", _g_trace_step, trace_file);
+
+return state;
+}
+
+
+void traceNextStep()
+{
+    /* host only */
+    ++_g_trace_step;
+}
+
+
+void traceRecordField(int zone_id, int field, real *vals, int no_cols,
+                      int no_rows)
+{
+/*
+    Records the no_rows x no_cols row major values vals of field of zone
+    zone_id in the current step, vals stays with the caller.
+    Host only!
+*/
+TraceRecordJob *job = NULL;
+
+if(!_g_trace_open || vals == NULL || no_rows < 1 || no_cols < 1)
+{
+    return;
+}
+
+job = (TraceRecordJob *) malloc(sizeof(TraceRecordJob));
+
+if(job != NULL)
+{
+    job->vals = (real *) malloc((size_t) no_rows * no_cols * sizeof(real));
+}
+
+if(job == NULL || job->vals == NULL)
+{
+    Message("Warning (traceRecordField()): Memory allocation error, field %i "
+            "of zone id %i is not recorded!\n", field, zone_id);
+    free(job);
+    return;
+}
+
+memcpy(job->vals, vals, (size_t) no_rows * no_cols * sizeof(real));
+job->step = _g_trace_step;
+job->zone_id = zone_id;
+job->field = field;
+job->no_cols = no_cols;
+job->no_rows = no_rows;
+
+submitBackgroundWrite(writeTraceRecordJob, job);
+}
+
+
+int closeCouplingTrace()
+{
+/*
+    Writes all pending records and closes the trace.
+    Host only!
+*/
+int state = _STATE_OK;
+int i;
+
+if(!_g_trace_open)
+{
+    return state;
+}
+
+flushBackgroundWriter();
+
+if(fclose(_g_trace.fp) != 0)
+{
+    state = _STATE_ERROR;
+}
+if(fclose(_g_trace.index_fp) != 0)
+{
+    state = _STATE_ERROR;
+}
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (closeCouplingTrace()): Closing the coupling trace "
+            "failed!\n");
+    state = _STATE_ERROR;
+}
+
+for(i = 0; i < _g_trace.no_fields; ++i)
+{
+    free(_g_trace.fields[i].prev);
+}
+free(_g_trace.enc_buf);
+
+memset(&_g_trace, 0, sizeof(TraceFile));
+_g_trace_open = 0;
+
+return state;
+}
@@ -0,0 +1,67 @@
+/*
+Binary trace of the exchanged ANSYS element fields of every coupling step
+(see COUPLING_TRACE in vof_pc_main.h). The values are copied by the coupling
+and encoded and appended to the trace by the background writer thread.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_TRACE_H
+#include "vof_pc_main.h"
+#include "vof_pc_threads.h"
+#include "vof_pc_exchange_backend.h"
+#define VOF_PC_TRACE_H
+
+enum traceFields {TRACE_VOF_OUT=0, TRACE_JH_IN, TRACE_LF_IN};
+enum traceCodecs {TRACE_CODEC_RAW=0, TRACE_CODEC_RLE, TRACE_CODEC_DELTA_RLE};
+
+/*
+Trace file (little endian): TRACE_MAGIC followed by the records. A record is
+a TRACE_RECORD_HEADER_SIZE bytes header of TRACE_RECORD_MAGIC and the 32 bit
+integers step, zone id, field, codec, bytes per value, number of rows, number
+of columns and payload bytes, followed by the payload. The values of a field
+are row major:
+
+TRACE_CODEC_RAW       values as they are
+TRACE_CODEC_RLE       byte planes of the values (first bytes of all values,
+                      then all second bytes, ...), run length encoded
+TRACE_CODEC_DELTA_RLE as TRACE_CODEC_RLE, of the values xor-ed bytewise with
+                      those of the previous record of the zone and field
+
+Every TRACE_KEYFRAME_INTERVAL-th record of a zone and field is no delta
+record. Run length encoding: a control byte c < 128 is followed by c + 1
+literal bytes, c >= 128 stands for c - 127 zero bytes.
+
+Index file: TRACE_INDEX_MAGIC followed by one TRACE_INDEX_ENTRY_SIZE bytes
+entry per record of the 8 header integers and the 64 bit offset of the record
+in the trace file.
+*/
+#define TRACE_MAGIC "VOFPCTR1"
+#define TRACE_INDEX_MAGIC "VOFPCTI1"
+#define TRACE_RECORD_MAGIC "VOFPCREC"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_RECORD_HEADER_SIZE 40
+#define TRACE_INDEX_ENTRY_SIZE 40
+#define TRACE_KEYFRAME_INTERVAL 32
+
+/* zone and field pairs whose previous values are kept for delta records */
+#define TRACE_MAX_FIELDS 16
+
+
+int openCouplingTrace(char trace_file[], char index_file[]);
+
+void traceNextStep();
+
+void traceRecordField(int zone_id, int field, real *vals, int no_cols,
+                      int no_rows);
+
+int closeCouplingTrace();
+
+#endif
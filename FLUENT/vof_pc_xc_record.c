@@ -0,0 +1,215 @@
+/*
+Recording of the exchange with ANSYS: the sync states and copies of the files
+ANSYS has written, with their times (see XC_RECORDING in vof_pc_main.h).
+TOOLS/vof_pc_xc_replay.c replays a recording as the ANSYS side.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_xc_record.h"
+
+#if LINUX
+#include "time.h"
+#else
+#include "windows.h"
+#endif
+
+
+static FILE *_g_xc_record_fp = NULL;
+static int _g_xc_record_started = 0;
+static int _g_xc_record_no_files = 0;
+static double _g_xc_record_start_time = 0;
+
+
+static double xcRecordClock()
+{
+    /* monotonic wall clock time in s */
+    #if LINUX
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+    #else
+    return 1e-3 * (double) GetTickCount64();
+    #endif
+}
+
+
+static const char *xcRecordBaseName(const char filename[])
+{
+    /* filename without its folder */
+    const char *name = filename;
+    const char *c;
+
+    for(c = filename; *c != '\0'; ++c)
+    {
+        if(*c == '/' || *c == '\\')
+        {
+            name = c + 1;
+        }
+    }
+
+    return name;
+}
+
+
+static int openXCRecording()
+{
+/*
+    Opens the recording on its first event, a new recording is started once
+    per loaded library and continued after closeXCRecording().
+    Host only!
+*/
+if(_g_xc_record_fp != NULL)
+{
+    return _STATE_OK;
+}
+
+_g_xc_record_fp = fopen(_XC_RECORD_DAT_, _g_xc_record_started ? "a" : "w");
+
+if(_g_xc_record_fp == NULL)
+{
+    Message("Error (openXCRecording()): Unable to open %s, does the folder "
+            "exist?\n", _XC_RECORD_DAT_);
+    return _STATE_ERROR;
+}
+
+if(!_g_xc_record_started)
+{
+    _g_xc_record_start_time = xcRecordClock();
+    _g_xc_record_no_files = 0;
+    _g_xc_record_started = 1;
+
+    Message("Info (openXCRecording()): Recording the exchange to %s\n",
+            _XC_RECORD_DAT_);
+}
+
+return _STATE_OK;
+}
+
+
+void xcRecordSyncState(char sync_file[], int source, int coupling_state)
+{
+/*
+    Records that Fluent has written (source XC_RECORD_FLUENT) or read
+    (XC_RECORD_ANSYS) coupling_state in sync_file.
+    Host only!
+*/
+double time = xcRecordClock();
+
+if(openXCRecording() != _STATE_OK)
+{
+    return;
+}
+time = (time > _g_xc_record_start_time) ? time : _g_xc_record_start_time;
+
+fprintf(_g_xc_record_fp, "%.6f STATE %s %i %s\n",
+        time - _g_xc_record_start_time,
+        (source == XC_RECORD_ANSYS) ? "ANSYS" : "FLUENT", coupling_state,
+        xcRecordBaseName(sync_file));
+fflush(_g_xc_record_fp);
+}
+
+
+int xcRecordFile(char xc_file[])
+{
+/*
+    Copies xc_file, written by ANSYS, into the recording folder and records
+    it with the last ANSYS state.
+    Host only!
+*/
+int state = _STATE_OK;
+char copy_file[XC_RECORD_FILENAME_SIZE];
+char copy_path[XC_RECORD_FILENAME_SIZE];
+char *buf = NULL;
+FILE *in = NULL;
+FILE *out = NULL;
+size_t n;
+double time = xcRecordClock();
+
+if(openXCRecording() != _STATE_OK)
+{
+    return _STATE_ERROR;
+}
+time = (time > _g_xc_record_start_time) ? time : _g_xc_record_start_time;
+
+sprintf(copy_file, "%06i_%.80s", _g_xc_record_no_files,
+        xcRecordBaseName(xc_file));
+sprintf(copy_path, "%.200s%.90s", _XC_RECORD_FOLDER_PATH_, copy_file);
+
+buf = (char *) malloc(XC_RECORD_COPY_BUFFER_SIZE);
+in = fopen(xc_file, "rb");
+out = fopen(copy_path, "wb");
+
+if(buf == NULL || in == NULL || out == NULL)
+{
+    state = _STATE_ERROR;
+}
+
+while(
+        state != _STATE_ERROR &&
+        (n = fread(buf, 1, XC_RECORD_COPY_BUFFER_SIZE, in)) > 0
+     )
+{
+    if(fwrite(buf, 1, n, out) != n)
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+if(in != NULL)
+{
+    if(ferror(in))
+    {
+        state = _STATE_ERROR;
+    }
+    fclose(in);
+}
+if(out != NULL && fclose(out) != 0)
+{
+    state = _STATE_ERROR;
+}
+free(buf);
+
+if(state == _STATE_ERROR)
+{
+    Message("Warning (xcRecordFile()): Unable to copy %s to %s, it is "
+            "missing in the recording!\n", xc_file, copy_path);
+    remove(copy_path);
+    return _STATE_WARNING;
+}
+
+++_g_xc_record_no_files;
+
+fprintf(_g_xc_record_fp, "%.6f FILE %s %s\n",
+        time - _g_xc_record_start_time, copy_file, xcRecordBaseName(xc_file));
+fflush(_g_xc_record_fp);
+
+return state;
+}
+
+
+int closeXCRecording()
+{
+/*
+    Closes the recording, the next event continues it.
+    Host only!
+*/
+    int state = _STATE_OK;
+
+    if(_g_xc_record_fp != NULL && fclose(_g_xc_record_fp) != 0)
+    {
+        state = _STATE_ERROR;
+    }
+    _g_xc_record_fp = NULL;
+
+    return state;
+}
@@ -0,0 +1,48 @@
+/*
+Recording of the exchange with ANSYS: the sync states and copies of the files
+ANSYS has written, with their times (see XC_RECORDING in vof_pc_main.h).
+TOOLS/vof_pc_xc_replay.c replays a recording as the ANSYS side.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_XC_RECORD_H
+#include "vof_pc_main.h"
+#include "vof_pc_case.h"
+#define VOF_PC_XC_RECORD_H
+
+enum xcRecordSources {XC_RECORD_FLUENT=0, XC_RECORD_ANSYS};
+
+/*
+The recording is the text file _XC_RECORD_DAT_ in _XC_RECORD_FOLDER_PATH_
+(which has to exist) of one event per line, time in s since the start of the
+recording:
+
+time STATE FLUENT|ANSYS coupling_state sync_file   Fluent wrote / read the
+                                                   coupling state
+time FILE copy_file xc_file                        copy_file in the recording
+                                                   folder is the file xc_file
+                                                   of the exchange folder
+                                                   ANSYS has written before
+                                                   the last ANSYS state
+
+File names are given without their folders.
+*/
+#define XC_RECORD_FILENAME_SIZE 300
+#define XC_RECORD_COPY_BUFFER_SIZE 65536
+
+
+void xcRecordSyncState(char sync_file[], int source, int coupling_state);
+
+int xcRecordFile(char xc_file[]);
+
+int closeXCRecording();
+
+#endif
@@ -0,0 +1,157 @@
+/*
+Compact storage of the coupling fields (enum udmis) of the coupled cell zones
+on the compute nodes, used instead of UDMIs with ZONE_COUPLING_STORAGE (see
+vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "vof_pc_zone_storage.h"
+
+static ZoneStorage *_g_zone_storages = NULL;
+static int _g_no_zone_storages = 0;
+static ZoneStorage *_g_last_zone_storage = NULL;
+static real _g_zone_storage_void = 0;
+
+
+int initZoneStorages(const int fluid_zone_ids[], int no_zones)
+{
+/*
+    Allocates ZONE_STORAGE_NO_FIELDS values for every interior cell of the
+    zones fluid_zone_ids[] on the compute nodes, all values are 0.
+    Must be called on host and nodes!
+*/
+int state = _STATE_OK;
+
+#if RP_NODE
+Domain *domain = Get_Domain(1);
+int iz;
+#endif
+
+freeZoneStorages();
+
+#if RP_NODE
+_g_zone_storages = (ZoneStorage *) calloc(no_zones + 1, sizeof(ZoneStorage));
+
+if(_g_zone_storages == NULL)
+{
+    state = _STATE_ERROR;
+}
+
+for(iz = 0; iz < no_zones && state != _STATE_ERROR; ++iz)
+{
+    _g_zone_storages[iz].fluid_zone_id = fluid_zone_ids[iz];
+    _g_zone_storages[iz].t = Lookup_Thread(domain, fluid_zone_ids[iz]);
+    _g_zone_storages[iz].no_cells =
+                            THREAD_N_ELEMENTS_INT(_g_zone_storages[iz].t);
+    _g_zone_storages[iz].vals = (real *) calloc(
+                    ZONE_STORAGE_NO_FIELDS * _g_zone_storages[iz].no_cells + 1,
+                    sizeof(real));
+    ++_g_no_zone_storages;
+
+    if(_g_zone_storages[iz].vals == NULL)
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+if(state == _STATE_ERROR)
+{
+    Message("Error (initZoneStorages()): Memory allocation error on node "
+            "%i!\n", myid);
+}
+#endif /* RP_NODE */
+
+state = reduceStateOverProcesses(state);
+
+if(state == _STATE_ERROR)
+{
+    freeZoneStorages();
+}
+
+return state;
+}
+
+
+real *zoneStorageCellValue(cell_t c, Thread *t, int i)
+{
+/*
+    Address of field i of cell c in thread t. The storage of the last call is
+    checked first, as cells are mostly accessed zone by zone.
+*/
+int iz;
+
+if(_g_last_zone_storage == NULL || _g_last_zone_storage->t != t)
+{
+    _g_last_zone_storage = NULL;
+
+    for(iz = 0; iz < _g_no_zone_storages; ++iz)
+    {
+        if(_g_zone_storages[iz].t == t)
+        {
+            _g_last_zone_storage = &_g_zone_storages[iz];
+            break;
+        }
+    }
+}
+
+if(
+    _g_last_zone_storage == NULL || c < 0 ||
+    c >= _g_last_zone_storage->no_cells || i < 0 ||
+    i >= ZONE_STORAGE_NO_FIELDS
+  )
+{
+    _g_zone_storage_void = 0;
+    return &_g_zone_storage_void;
+}
+
+return &_g_last_zone_storage->vals[i * _g_last_zone_storage->no_cells + c];
+}
+
+
+void resetZoneStorageField(int i)
+{
+/*
+    Sets field i of all cells of all zones to 0.
+*/
+int iz, c;
+
+if(i < 0 || i >= ZONE_STORAGE_NO_FIELDS)
+{
+    return;
+}
+
+for(iz = 0; iz < _g_no_zone_storages; ++iz)
+{
+    for(c = 0; c < _g_zone_storages[iz].no_cells; ++c)
+    {
+        _g_zone_storages[iz].vals[i * _g_zone_storages[iz].no_cells + c] = 0;
+    }
+}
+}
+
+
+void freeZoneStorages()
+{
+int iz;
+
+if(_g_zone_storages != NULL)
+{
+    for(iz = 0; iz < _g_no_zone_storages; ++iz)
+    {
+        free(_g_zone_storages[iz].vals);
+    }
+    free(_g_zone_storages);
+}
+
+_g_zone_storages = NULL;
+_g_no_zone_storages = 0;
+_g_last_zone_storage = NULL;
+}
@@ -0,0 +1,56 @@
+/*
+Compact storage of the coupling fields (enum udmis) of the coupled cell zones
+on the compute nodes, used instead of UDMIs with ZONE_COUPLING_STORAGE (see
+vof_pc_main.h).
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef VOF_PC_ZONE_STORAGE_H
+#include "vof_pc_main.h"
+#include "vof_pc_node_comm.h"
+#define VOF_PC_ZONE_STORAGE_H
+
+#define ZONE_STORAGE_NO_FIELDS (UDM_VOF_old + 1)
+
+/*
+Coupling field i of cell c in thread t, C_COUPLING can be used like C_UDMI.
+Cells outside of the coupled zones read 0, writes to them are discarded.
+*/
+#if ZONE_COUPLING_STORAGE
+#define C_COUPLING(c,t,i) (*zoneStorageCellValue(c,t,i))
+#define N_COUPLING_FIELDS ZONE_STORAGE_NO_FIELDS
+#else
+#define C_COUPLING(c,t,i) C_UDMI(c,t,i)
+#define N_COUPLING_FIELDS N_UDM
+#endif
+
+/*
+All fields of the interior cells of one zone on a compute node, field by field:
+vals[i*no_cells + c]
+*/
+typedef struct zone_storage_struct
+{
+    int fluid_zone_id;
+    Thread *t;
+    int no_cells;
+    real *vals;
+} ZoneStorage;
+
+
+int initZoneStorages(const int fluid_zone_ids[], int no_zones);
+
+real *zoneStorageCellValue(cell_t c, Thread *t, int i);
+
+void resetZoneStorageField(int i);
+
+void freeZoneStorages();
+
+#endif
@@ -0,0 +1,468 @@
+/*
+Reader of the coupling trace (see COUPLING_TRACE in FLUENT/vof_pc_main.h and
+the format in FLUENT/vof_pc_trace.h). Standalone, compile with e.g.
+
+    gcc -O2 -o vof_pc_trace_read vof_pc_trace_read.c
+
+Usage:
+
+    vof_pc_trace_read COUPLING_TRACE.BIN COUPLING_TRACE.IDX
+        lists all records
+
+    vof_pc_trace_read COUPLING_TRACE.BIN COUPLING_TRACE.IDX step [zone [field]]
+        prints the values of the records of step (of zone and field), one
+        row per ANSYS element (fields: 0 VOF out, 1 JH in, 2 LF in)
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef _WIN32
+#define _FILE_OFFSET_BITS 64
+#define _POSIX_C_SOURCE 200112L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define _STATE_OK 0
+#define _STATE_ERROR -1
+
+/* as in FLUENT/vof_pc_trace.h */
+#define TRACE_MAGIC "VOFPCTR1"
+#define TRACE_INDEX_MAGIC "VOFPCTI1"
+#define TRACE_RECORD_MAGIC "VOFPCREC"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_RECORD_HEADER_SIZE 40
+#define TRACE_INDEX_ENTRY_SIZE 40
+
+enum traceCodecs {TRACE_CODEC_RAW=0, TRACE_CODEC_RLE, TRACE_CODEC_DELTA_RLE};
+
+#ifdef _WIN32
+#define TRACE_FSEEK _fseeki64
+#else
+#define TRACE_FSEEK fseeko
+#endif
+
+typedef struct trace_entry_struct
+{
+    int step;
+    int zone_id;
+    int field;
+    int codec;
+    int value_size;
+    int no_rows;
+    int no_cols;
+    int payload_size;
+    long long offset;
+} TraceEntry;
+
+
+static int getInt(const unsigned char *buf)
+{
+    return (int) ((unsigned int) buf[0] | ((unsigned int) buf[1] << 8) |
+                  ((unsigned int) buf[2] << 16) | ((unsigned int) buf[3] << 24));
+}
+
+
+static int readIndex(char index_file[], TraceEntry **entries, int *no_entries)
+{
+/*
+    Reads all entries of index_file, a partly written last entry is ignored.
+*/
+FILE *fp = fopen(index_file, "rb");
+unsigned char buf[TRACE_INDEX_ENTRY_SIZE];
+TraceEntry *tmp = NULL;
+int size = 0;
+int k;
+
+(*entries) = NULL;
+(*no_entries) = 0;
+
+if(fp == NULL)
+{
+    fprintf(stderr, "Error (readIndex()): Unable to open %s!\n", index_file);
+    return _STATE_ERROR;
+}
+
+if(
+    fread(buf, 1, TRACE_MAGIC_SIZE, fp) != TRACE_MAGIC_SIZE ||
+    memcmp(buf, TRACE_INDEX_MAGIC, TRACE_MAGIC_SIZE) != 0
+  )
+{
+    fprintf(stderr, "Error (readIndex()): %s is no trace index!\n", index_file);
+    fclose(fp);
+    return _STATE_ERROR;
+}
+
+while(fread(buf, 1, TRACE_INDEX_ENTRY_SIZE, fp) == TRACE_INDEX_ENTRY_SIZE)
+{
+    if((*no_entries) == size)
+    {
+        size = (size > 0) ? 2 * size : 1024;
+        tmp = (TraceEntry *) realloc(*entries, size * sizeof(TraceEntry));
+
+        if(tmp == NULL)
+        {
+            fprintf(stderr, "Error (readIndex()): Memory allocation error!\n");
+            fclose(fp);
+            return _STATE_ERROR;
+        }
+        (*entries) = tmp;
+    }
+
+    tmp = &(*entries)[(*no_entries)++];
+    tmp->step = getInt(buf);
+    tmp->zone_id = getInt(buf + 4);
+    tmp->field = getInt(buf + 8);
+    tmp->codec = getInt(buf + 12);
+    tmp->value_size = getInt(buf + 16);
+    tmp->no_rows = getInt(buf + 20);
+    tmp->no_cols = getInt(buf + 24);
+    tmp->payload_size = getInt(buf + 28);
+    tmp->offset = (long long) (unsigned int) getInt(buf + 32) |
+                  ((long long) getInt(buf + 36) << 32);
+}
+
+for(k = 0; k < (*no_entries); ++k)
+{
+    tmp = &(*entries)[k];
+
+    if(
+        tmp->codec < TRACE_CODEC_RAW || tmp->codec > TRACE_CODEC_DELTA_RLE ||
+        (tmp->value_size != 4 && tmp->value_size != 8) ||
+        tmp->no_rows < 1 || tmp->no_cols < 1 || tmp->payload_size < 0 ||
+        tmp->offset < TRACE_MAGIC_SIZE
+      )
+    {
+        fprintf(stderr, "Error (readIndex()): Wrong entry %i in %s!\n", k,
+                index_file);
+        fclose(fp);
+        return _STATE_ERROR;
+    }
+}
+
+fclose(fp);
+
+return _STATE_OK;
+}
+
+
+static int decodeRLE(
+                        unsigned char *out,
+                        int no_bytes,
+                        const unsigned char *in,
+                        int in_size
+                    )
+{
+/*
+    Decodes the run length encoded in (see vof_pc_trace.h) into the no_bytes
+    bytes out.
+*/
+    int i = 0;
+    int n = 0;
+    int c;
+
+    while(i < in_size)
+    {
+        c = in[i++];
+
+        if(c < 128)
+        {
+            if(i + c + 1 > in_size || n + c + 1 > no_bytes)
+            {
+                return _STATE_ERROR;
+            }
+            memcpy(out + n, in + i, (size_t) c + 1);
+            i += c + 1;
+            n += c + 1;
+        }
+        else
+        {
+            if(n + c - 127 > no_bytes)
+            {
+                return _STATE_ERROR;
+            }
+            memset(out + n, 0, (size_t) c - 127);
+            n += c - 127;
+        }
+    }
+
+    return (n == no_bytes) ? _STATE_OK : _STATE_ERROR;
+}
+
+
+static int readRecordValues(
+                            FILE *fp,
+                            TraceEntry *entry,
+                            unsigned char *vals,
+                            unsigned char *buf,
+                            unsigned char *planes
+                           )
+{
+/*
+    Reads the record of entry and decodes its values into vals, a delta
+    record is xor-ed with the values vals holds. buf needs room for the
+    payload and planes for the values.
+*/
+unsigned char header[TRACE_RECORD_HEADER_SIZE];
+int no_values = entry->no_rows * entry->no_cols;
+int no_bytes = no_values * entry->value_size;
+int b, i;
+
+if(
+    TRACE_FSEEK(fp, entry->offset, SEEK_SET) != 0 ||
+    fread(header, 1, TRACE_RECORD_HEADER_SIZE, fp) != TRACE_RECORD_HEADER_SIZE ||
+    memcmp(header, TRACE_RECORD_MAGIC, TRACE_MAGIC_SIZE) != 0 ||
+    getInt(header + 8) != entry->step ||
+    getInt(header + 36) != entry->payload_size ||
+    fread(buf, 1, (size_t) entry->payload_size, fp) !=
+        (size_t) entry->payload_size
+  )
+{
+    fprintf(stderr, "Error (readRecordValues()): Wrong record at offset %lli "
+            "of step %i!\n", entry->offset, entry->step);
+    return _STATE_ERROR;
+}
+
+if(entry->codec == TRACE_CODEC_RAW)
+{
+    if(entry->payload_size != no_bytes)
+    {
+        return _STATE_ERROR;
+    }
+    memcpy(vals, buf, (size_t) no_bytes);
+    return _STATE_OK;
+}
+
+if(decodeRLE(planes, no_bytes, buf, entry->payload_size) != _STATE_OK)
+{
+    fprintf(stderr, "Error (readRecordValues()): Wrong encoded record at "
+            "offset %lli of step %i!\n", entry->offset, entry->step);
+    return _STATE_ERROR;
+}
+
+for(b = 0; b < entry->value_size; ++b)
+{
+    for(i = 0; i < no_values; ++i)
+    {
+        if(entry->codec == TRACE_CODEC_DELTA_RLE)
+        {
+            vals[i * entry->value_size + b] ^= planes[b * no_values + i];
+        }
+        else
+        {
+            vals[i * entry->value_size + b] = planes[b * no_values + i];
+        }
+    }
+}
+
+return _STATE_OK;
+}
+
+
+static int printRecord(FILE *fp, TraceEntry *entries, int k)
+{
+/*
+    Decodes entry k, a delta record starting from the last record without
+    delta of its zone and field, and prints its rows.
+*/
+TraceEntry *entry = &entries[k];
+int no_values = entry->no_rows * entry->no_cols;
+int no_bytes = no_values * entry->value_size;
+unsigned char *vals = NULL;
+unsigned char *buf = NULL;
+unsigned char *planes = NULL;
+int *chain = NULL;
+int no_chain = 0;
+int state = _STATE_OK;
+int j, c;
+float f;
+double d;
+
+chain = (int *) malloc((k + 1) * sizeof(int));
+vals = (unsigned char *) calloc(no_bytes + 1, 1);
+planes = (unsigned char *) malloc(no_bytes + 1);
+
+if(chain == NULL || vals == NULL || planes == NULL)
+{
+    fprintf(stderr, "Error (printRecord()): Memory allocation error!\n");
+    state = _STATE_ERROR;
+}
+
+/* records back to the last one without delta */
+for(j = k; j >= 0 && state == _STATE_OK; --j)
+{
+    if(
+        entries[j].zone_id != entry->zone_id ||
+        entries[j].field != entry->field
+      )
+    {
+        continue;
+    }
+
+    if(
+        entries[j].no_rows != entry->no_rows ||
+        entries[j].no_cols != entry->no_cols ||
+        entries[j].value_size != entry->value_size
+      )
+    {
+        state = _STATE_ERROR;
+        break;
+    }
+
+    chain[no_chain++] = j;
+
+    if(entries[j].codec != TRACE_CODEC_DELTA_RLE)
+    {
+        break;
+    }
+}
+
+if(
+    state == _STATE_ERROR ||
+    (no_chain > 0 && entries[chain[no_chain - 1]].codec == TRACE_CODEC_DELTA_RLE)
+  )
+{
+    fprintf(stderr, "Error (printRecord()): No complete delta chain for zone "
+            "id %i, field %i of step %i!\n", entry->zone_id, entry->field,
+            entry->step);
+    state = _STATE_ERROR;
+}
+
+for(j = no_chain - 1; j >= 0 && state == _STATE_OK; --j)
+{
+    free(buf);
+    buf = (unsigned char *) malloc(entries[chain[j]].payload_size + 1);
+
+    if(buf == NULL)
+    {
+        fprintf(stderr, "Error (printRecord()): Memory allocation error!\n");
+        state = _STATE_ERROR;
+        break;
+    }
+
+    state = readRecordValues(fp, &entries[chain[j]], vals, buf, planes);
+}
+
+if(state == _STATE_OK)
+{
+    printf("# step %i zone %i field %i rows %i cols %i\n", entry->step,
+           entry->zone_id, entry->field, entry->no_rows, entry->no_cols);
+
+    for(j = 0; j < entry->no_rows; ++j)
+    {
+        for(c = 0; c < entry->no_cols; ++c)
+        {
+            if(entry->value_size == 4)
+            {
+                memcpy(&f, vals + (j * entry->no_cols + c) * 4, 4);
+                printf((c > 0) ? " %.9g" : "%.9g", f);
+            }
+            else
+            {
+                memcpy(&d, vals + (j * entry->no_cols + c) * 8, 8);
+                printf((c > 0) ? " %.17g" : "%.17g", d);
+            }
+        }
+        printf("\n");
+    }
+}
+
+free(chain);
+free(vals);
+free(buf);
+free(planes);
+
+return state;
+}
+
+
+int main(int argc, char *argv[])
+{
+TraceEntry *entries = NULL;
+int no_entries = 0;
+int step = -1;
+int zone_id = -1;
+int field = -1;
+int found = 0;
+int state = _STATE_OK;
+int k;
+unsigned int one = 1;
+unsigned char magic[TRACE_MAGIC_SIZE];
+FILE *fp = NULL;
+
+if(argc < 3 || argc > 6)
+{
+    fprintf(stderr, "Usage: %s trace_file index_file [step [zone [field]]]\n",
+            argv[0]);
+    return 1;
+}
+
+if(*((unsigned char *) &one) != 1)
+{
+    fprintf(stderr, "Error (main()): Only little endian hosts are supported!\n");
+    return 1;
+}
+
+if(argc > 3) step = atoi(argv[3]);
+if(argc > 4) zone_id = atoi(argv[4]);
+if(argc > 5) field = atoi(argv[5]);
+
+fp = fopen(argv[1], "rb");
+
+if(
+    fp == NULL ||
+    fread(magic, 1, TRACE_MAGIC_SIZE, fp) != TRACE_MAGIC_SIZE ||
+    memcmp(magic, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0
+  )
+{
+    fprintf(stderr, "Error (main()): %s is no coupling trace!\n", argv[1]);
+    state = _STATE_ERROR;
+}
+
+if(state == _STATE_OK)
+{
+    state = readIndex(argv[2], &entries, &no_entries);
+}
+
+for(k = 0; k < no_entries && state == _STATE_OK; ++k)
+{
+    if(step < 0)
+    {
+        printf("step %i zone %i field %i codec %i rows %i cols %i "
+               "bytes %i offset %lli\n", entries[k].step, entries[k].zone_id,
+               entries[k].field, entries[k].codec, entries[k].no_rows,
+               entries[k].no_cols, entries[k].payload_size, entries[k].offset);
+    }
+    else if(
+            entries[k].step == step &&
+            (zone_id < 0 || entries[k].zone_id == zone_id) &&
+            (field < 0 || entries[k].field == field)
+           )
+    {
+        state = printRecord(fp, entries, k);
+        found = 1;
+    }
+}
+
+if(state == _STATE_OK && step >= 0 && !found)
+{
+    fprintf(stderr, "Error (main()): No records of step %i found!\n", step);
+    state = _STATE_ERROR;
+}
+
+if(fp != NULL)
+{
+    fclose(fp);
+}
+free(entries);
+
+return (state == _STATE_OK) ? 0 : 1;
+}
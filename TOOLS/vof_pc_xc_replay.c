@@ -0,0 +1,435 @@
+/*
+Replay of an exchange recording (see XC_RECORDING in FLUENT/vof_pc_main.h and
+the format in FLUENT/vof_pc_xc_record.h) as the ANSYS side of the coupling,
+so the Fluent side can be run and timed without ANSYS. Standalone (POSIX),
+compile with e.g.
+
+    gcc -O2 -o vof_pc_xc_replay vof_pc_xc_replay.c
+
+Usage:
+
+    vof_pc_xc_replay record_folder/ xc_folder/ [time_scale]
+
+Start the replay instead of the APDL script. It waits for every sync state
+Fluent has written in the recording, waits time_scale (default 1, 0 for no
+wait) times the time ANSYS took in the recording and then publishes the
+recorded ANSYS files and the ANSYS sync state in xc_folder, both written
+under XC_PART_FILE_SUFFIX and renamed like the Fluent side does. The
+recorded times include the sync file polling of Fluent. After the last
+recorded ANSYS state the sync state is set to STOP_SIM once Fluent is ready
+again, unless the recording ends with it. The time Fluent took from every ANSYS state to its next sync state is
+printed.
+
+License (MIT):
+
+Copyright (c) 2016-2019 Christian Schubert
+
+Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define _STATE_OK 0
+#define _STATE_ERROR -1
+
+/* as in FLUENT/vof_pc_main.h, FLUENT/vof_pc_file_sync.h and
+FLUENT/vof_pc_xc_record.h */
+enum couplingStates {COUPLING_INIT=0, ANSYS_READY, FLUENT_READY, STOP_SIM, SYNC_ERROR};
+#define XC_PART_FILE_SUFFIX ".part"
+#define XC_RECORD_DAT "XC_RECORD.TXT"
+
+#define XC_REPLAY_FILENAME_SIZE 600
+#define XC_REPLAY_POLL_TIME_IN_S 0.01
+#define XC_REPLAY_MAX_WAIT_IN_S 3600.0
+#define XC_REPLAY_COPY_BUFFER_SIZE 65536
+
+enum xcReplayEvents {XC_EVENT_FLUENT_STATE=0, XC_EVENT_ANSYS_STATE, XC_EVENT_FILE};
+
+typedef struct xc_replay_event_struct
+{
+    double time;
+    int type;
+    int coupling_state;
+    char name[256];     /* sync file or copy in the recording folder */
+    char xc_name[256];  /* file in the exchange folder */
+} XCReplayEvent;
+
+
+static double replayClock()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (double) ts.tv_sec + 1e-9 * (double) ts.tv_nsec;
+}
+
+
+static void replaySleep(double seconds)
+{
+    struct timespec ts;
+
+    if(seconds <= 0)
+    {
+        return;
+    }
+
+    ts.tv_sec = (time_t) seconds;
+    ts.tv_nsec = (long) ((seconds - (double) ts.tv_sec) * 1e9);
+    nanosleep(&ts, NULL);
+}
+
+
+static int readRecording(char record_folder[], XCReplayEvent **events,
+                         int *no_events)
+{
+/*
+    Reads all events of the recording in record_folder.
+*/
+char filename[XC_REPLAY_FILENAME_SIZE];
+char line[1024];
+char kind[16];
+char source[16];
+XCReplayEvent *tmp = NULL;
+XCReplayEvent *event = NULL;
+FILE *fp = NULL;
+int size = 0;
+int line_no = 0;
+
+(*events) = NULL;
+(*no_events) = 0;
+
+sprintf(filename, "%.500s%s", record_folder, XC_RECORD_DAT);
+
+if((fp = fopen(filename, "r")) == NULL)
+{
+    fprintf(stderr, "Error (readRecording()): Unable to open %s!\n", filename);
+    return _STATE_ERROR;
+}
+
+while(fgets(line, sizeof(line), fp) != NULL)
+{
+    ++line_no;
+
+    if(line[strspn(line, " \t\r\n")] == '\0')
+    {
+        continue;
+    }
+
+    if((*no_events) == size)
+    {
+        size = (size > 0) ? 2 * size : 256;
+        tmp = (XCReplayEvent *) realloc(*events, size * sizeof(XCReplayEvent));
+
+        if(tmp == NULL)
+        {
+            fprintf(stderr, "Error (readRecording()): Memory allocation "
+                    "error!\n");
+            fclose(fp);
+            return _STATE_ERROR;
+        }
+        (*events) = tmp;
+    }
+
+    event = &(*events)[*no_events];
+    event->xc_name[0] = '\0';
+    kind[0] = '\0';
+
+    if(
+        sscanf(line, "%lf %15s", &event->time, kind) == 2 &&
+        strcmp(kind, "STATE") == 0 &&
+        sscanf(line, "%*f %*s %15s %i %255s", source, &event->coupling_state,
+               event->name) == 3
+      )
+    {
+        event->type = (strcmp(source, "ANSYS") == 0) ?
+                        XC_EVENT_ANSYS_STATE : XC_EVENT_FLUENT_STATE;
+    }
+    else if(
+            strcmp(kind, "FILE") == 0 &&
+            sscanf(line, "%*f %*s %255s %255s", event->name,
+                   event->xc_name) == 2
+           )
+    {
+        event->type = XC_EVENT_FILE;
+        event->coupling_state = -1;
+    }
+    else
+    {
+        fprintf(stderr, "Error (readRecording()): Wrong line %i in %s!\n",
+                line_no, filename);
+        fclose(fp);
+        return _STATE_ERROR;
+    }
+
+    ++(*no_events);
+}
+
+fclose(fp);
+
+return _STATE_OK;
+}
+
+
+static int readSyncState(char sync_file[])
+{
+    /* coupling state in sync_file, SYNC_ERROR if it can not be read */
+    FILE *fp = fopen(sync_file, "r");
+    double val = -1;
+    int coupling_state = SYNC_ERROR;
+
+    if(fp == NULL)
+    {
+        return SYNC_ERROR;
+    }
+
+    if(fscanf(fp, "%lf", &val) == 1 && val > -0.5 && val < SYNC_ERROR - 0.5)
+    {
+        coupling_state = (int) (val + 0.5);
+    }
+    fclose(fp);
+
+    return coupling_state;
+}
+
+
+static int waitForSyncState(char sync_file[], int desired_state)
+{
+/*
+    Polls sync_file until it holds desired_state.
+*/
+double start = replayClock();
+
+while(readSyncState(sync_file) != desired_state)
+{
+    if(replayClock() - start > XC_REPLAY_MAX_WAIT_IN_S)
+    {
+        fprintf(stderr, "Error (waitForSyncState()): Fluent did not write "
+                "state %i to %s within %.0f s!\n", desired_state, sync_file,
+                XC_REPLAY_MAX_WAIT_IN_S);
+        return _STATE_ERROR;
+    }
+    replaySleep(XC_REPLAY_POLL_TIME_IN_S);
+}
+
+return _STATE_OK;
+}
+
+
+static int publishFile(char src_file[], char dst_file[], const char *text)
+{
+/*
+    Writes the contents of src_file or, without src_file, text to dst_file
+    plus XC_PART_FILE_SUFFIX and renames it to dst_file.
+*/
+char part_file[XC_REPLAY_FILENAME_SIZE + 8];
+char *buf = NULL;
+FILE *in = NULL;
+FILE *out = NULL;
+size_t n;
+int state = _STATE_OK;
+
+sprintf(part_file, "%s%s", dst_file, XC_PART_FILE_SUFFIX);
+
+out = fopen(part_file, "wb");
+
+if(src_file != NULL)
+{
+    in = fopen(src_file, "rb");
+    buf = (char *) malloc(XC_REPLAY_COPY_BUFFER_SIZE);
+
+    if(in == NULL || buf == NULL)
+    {
+        state = _STATE_ERROR;
+    }
+}
+
+if(out == NULL)
+{
+    state = _STATE_ERROR;
+}
+else if(src_file == NULL)
+{
+    if(fputs(text, out) == EOF)
+    {
+        state = _STATE_ERROR;
+    }
+}
+else
+{
+    while(
+            state != _STATE_ERROR &&
+            (n = fread(buf, 1, XC_REPLAY_COPY_BUFFER_SIZE, in)) > 0
+         )
+    {
+        if(fwrite(buf, 1, n, out) != n)
+        {
+            state = _STATE_ERROR;
+        }
+    }
+}
+
+if(in != NULL)
+{
+    if(ferror(in))
+    {
+        state = _STATE_ERROR;
+    }
+    fclose(in);
+}
+if(out != NULL && fclose(out) != 0)
+{
+    state = _STATE_ERROR;
+}
+free(buf);
+
+if(state == _STATE_OK && rename(part_file, dst_file) != 0)
+{
+    state = _STATE_ERROR;
+}
+
+if(state == _STATE_ERROR)
+{
+    fprintf(stderr, "Error (publishFile()): Unable to write %s!\n", dst_file);
+    remove(part_file);
+}
+
+return state;
+}
+
+
+int main(int argc, char *argv[])
+{
+XCReplayEvent *events = NULL;
+int no_events = 0;
+double time_scale = 1.0;
+double fluent_time = -1.0;    /* recording time of the last Fluent state */
+double fluent_seen = 0.0;     /* replay clock when it was seen */
+double ansys_written = -1.0;  /* replay clock of the last ANSYS state */
+double sum_fluent = 0.0;
+int no_fluent_times = 0;
+int no_ansys_steps = 0;
+int last_type = XC_EVENT_FILE;
+int last_state = -1;
+int state = _STATE_OK;
+int k, j;
+char sync_file[XC_REPLAY_FILENAME_SIZE];
+char src_file[XC_REPLAY_FILENAME_SIZE];
+char dst_file[XC_REPLAY_FILENAME_SIZE];
+char text[16];
+
+if(argc < 3 || argc > 4)
+{
+    fprintf(stderr, "Usage: %s record_folder/ xc_folder/ [time_scale]\n",
+            argv[0]);
+    return 1;
+}
+
+if(argc > 3)
+{
+    time_scale = atof(argv[3]);
+}
+
+state = readRecording(argv[1], &events, &no_events);
+sync_file[0] = '\0';
+
+for(k = 0; k < no_events && state == _STATE_OK; ++k)
+{
+    if(events[k].type == XC_EVENT_FILE)
+    {
+        continue;
+    }
+
+    sprintf(sync_file, "%.300s%.250s", argv[2], events[k].name);
+    last_type = events[k].type;
+    last_state = events[k].coupling_state;
+
+    if(events[k].type == XC_EVENT_FLUENT_STATE)
+    {
+        state = waitForSyncState(sync_file, events[k].coupling_state);
+
+        fluent_time = events[k].time;
+        fluent_seen = replayClock();
+
+        if(state == _STATE_OK && ansys_written >= 0)
+        {
+            printf("Fluent state %i after %.3f s\n", events[k].coupling_state,
+                   fluent_seen - ansys_written);
+            sum_fluent += fluent_seen - ansys_written;
+            ++no_fluent_times;
+            ansys_written = -1.0;
+        }
+        continue;
+    }
+
+    /* ANSYS state: wait as ANSYS did, then its files and the state */
+    if(fluent_time >= 0)
+    {
+        replaySleep(time_scale * (events[k].time - fluent_time) -
+                    (replayClock() - fluent_seen));
+    }
+
+    for(j = k + 1; j < no_events && events[j].type == XC_EVENT_FILE &&
+                   state == _STATE_OK; ++j)
+    {
+        sprintf(src_file, "%.300s%.250s", argv[1], events[j].name);
+        sprintf(dst_file, "%.300s%.250s", argv[2], events[j].xc_name);
+
+        state = publishFile(src_file, dst_file, NULL);
+    }
+
+    if(state == _STATE_OK)
+    {
+        sprintf(text, "%i", events[k].coupling_state);
+        state = publishFile(NULL, sync_file, text);
+
+        ansys_written = replayClock();
+        ++no_ansys_steps;
+    }
+}
+
+/* the recording ends, stop Fluent once it is ready again */
+if(
+    state == _STATE_OK &&
+    last_type == XC_EVENT_ANSYS_STATE &&
+    last_state != STOP_SIM
+  )
+{
+    state = waitForSyncState(sync_file, FLUENT_READY);
+
+    if(state == _STATE_OK)
+    {
+        fluent_seen = replayClock();
+        printf("Fluent state %i after %.3f s\n", FLUENT_READY,
+               fluent_seen - ansys_written);
+        sum_fluent += fluent_seen - ansys_written;
+        ++no_fluent_times;
+        last_type = XC_EVENT_FLUENT_STATE;
+    }
+}
+
+if(state == _STATE_OK && last_type == XC_EVENT_FLUENT_STATE)
+{
+    sprintf(text, "%i", STOP_SIM);
+    state = publishFile(NULL, sync_file, text);
+}
+
+printf("Replayed %i ANSYS states", no_ansys_steps);
+if(no_fluent_times > 0)
+{
+    printf(", Fluent took %.3f s in total, %.3f s per answer", sum_fluent,
+           sum_fluent / no_fluent_times);
+}
+printf("\n");
+
+free(events);
+
+return (state == _STATE_OK) ? 0 : 1;
+}